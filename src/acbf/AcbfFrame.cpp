@@ -74,11 +74,13 @@ bool Frame::fromXml(QXmlStreamReader *xmlReader)
     setBgcolor(xmlReader->attributes().value(QStringLiteral("bgcolor")).toString());
 
     QVector<QStringRef> points = xmlReader->attributes().value(QStringLiteral("points")).split(' ');
+    QList<QPoint> parsedPoints;
+    parsedPoints.reserve(points.count());
     for(QStringRef point : points) {
         QVector<QStringRef> elements = point.split(',');
         if(elements.length() == 2)
         {
-            addPoint(QPoint(elements.at(0).toInt(), elements.at(1).toInt()));
+            parsedPoints << QPoint(elements.at(0).toInt(), elements.at(1).toInt());
         }
         else
         {
@@ -86,6 +88,7 @@ bool Frame::fromXml(QXmlStreamReader *xmlReader)
             return false;
         }
     }
+    setPoints(parsedPoints);
 
     if (xmlReader->hasError()) {
         qCWarning(ACBF_LOG) << Q_FUNC_INFO << "Failed to read ACBF XML document at token" << xmlReader->name() << "(" << xmlReader->lineNumber() << ":" << xmlReader->columnNumber() << ") The reported error was:" << xmlReader->errorString();
@@ -113,6 +116,12 @@ QList<QPoint> Frame::points() const
     return d->points;
 }
 
+void Frame::setPoints(const QList<QPoint>& points)
+{
+    d->points = points;
+    emit pointCountChanged();
+}
+
 QPoint Frame::point(int index) const
 {
     return d->points.at(index);
@@ -75,11 +75,13 @@ bool Jump::fromXml(QXmlStreamReader *xmlReader)
     setHref(xmlReader->attributes().value(QStringLiteral("href")).toString());
 
     QVector<QStringRef> points = xmlReader->attributes().value(QStringLiteral("points")).split(' ');
+    QList<QPoint> parsedPoints;
+    parsedPoints.reserve(points.count());
     for(QStringRef point : points) {
         QVector<QStringRef> elements = point.split(',');
         if(elements.length() == 2)
         {
-            addPoint(QPoint(elements.at(0).toInt(), elements.at(1).toInt()));
+            parsedPoints << QPoint(elements.at(0).toInt(), elements.at(1).toInt());
         }
         else
         {
@@ -87,6 +89,7 @@ bool Jump::fromXml(QXmlStreamReader *xmlReader)
             return false;
         }
     }
+    setPoints(parsedPoints);
 
     if (xmlReader->hasError()) {
         qCWarning(ACBF_LOG) << Q_FUNC_INFO << "Failed to read ACBF XML document at token" << xmlReader->name() << "(" << xmlReader->lineNumber() << ":" << xmlReader->columnNumber() << ") The reported error was:" << xmlReader->errorString();
@@ -101,6 +104,12 @@ QList<QPoint> Jump::points() const
     return d->points;
 }
 
+void Jump::setPoints(const QList<QPoint>& points)
+{
+    d->points = points;
+    emit pointCountChanged();
+}
+
 QPoint Jump::point(int index) const
 {
     return d->points.at(index);
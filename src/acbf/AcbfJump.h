@@ -72,6 +72,14 @@ public:
      * @return a list of points that encompasses the jump.
      */
     QList<QPoint> points() const;
+    /**
+     * \brief replace the entire list of points in one go.
+     *
+     * This only fires pointCountChanged once, rather than once per point
+     * as repeated calls to addPoint() would.
+     * @param points - the new list of points. Coordinates should be in pixels.
+     */
+    void setPoints(const QList<QPoint>& points);
     /**
      * @param index - the index of the desired point.
      * @return a point for an index.
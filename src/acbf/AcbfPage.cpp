@@ -54,6 +54,58 @@ public:
     QList<Jump*> jumps;
     QTimer jumpsUpdateTimer;
     bool isCoverPage;
+
+    // The compact geometry is built on request, and thrown out whenever
+    // the frames or jumps it was built from change
+    PageGeometry frameGeometry;
+    QStringList framePointStrings;
+    bool frameGeometryDirty{true};
+    PageGeometry jumpGeometry;
+    bool jumpGeometryDirty{true};
+
+    void invalidateJumpGeometry(Page* q)
+    {
+        jumpGeometryDirty = true;
+        Q_EMIT q->jumpGeometryChanged();
+    }
+
+    void trackFrame(Page* q, Frame* frame)
+    {
+        QObject::connect(frame, &Frame::boundsChanged, q, [this]() { frameGeometryDirty = true; });
+        QObject::connect(frame, &QObject::destroyed, q, [this]() { frameGeometryDirty = true; });
+        frameGeometryDirty = true;
+    }
+
+    void ensureFrameGeometry()
+    {
+        if (frameGeometryDirty) {
+            int pointCount{0};
+            for (const Frame* frame : frames) {
+                pointCount += frame->pointCount();
+            }
+            frameGeometry.clear();
+            frameGeometry.reserve(frames.count(), pointCount);
+            framePointStrings.clear();
+            framePointStrings.reserve(frames.count());
+            for (const Frame* frame : frames) {
+                const int shape = frameGeometry.addShape(frame->points());
+                framePointStrings << frameGeometry.pointString(shape);
+            }
+            frameGeometryDirty = false;
+        }
+    }
+
+    void ensureJumpGeometry()
+    {
+        if (jumpGeometryDirty) {
+            jumpGeometry.clear();
+            jumpGeometry.reserve(jumps.count(), jumps.count() * 4);
+            for (const Jump* jump : jumps) {
+                jumpGeometry.addShape(jump->points());
+            }
+            jumpGeometryDirty = false;
+        }
+    }
 };
 
 Page::Page(Document* parent)
@@ -162,6 +214,7 @@ bool Page::fromXml(QXmlStreamReader *xmlReader, const QString& xmlData)
                 return false;
             }
             d->frames.append(newFrame);
+            d->trackFrame(this, newFrame);
 
             // Frames have no child elements, so we need to force the reader to go to the next one.
             xmlReader->readNext();
@@ -383,6 +436,7 @@ void Page::addFrame(Frame* frame, int index)
     else {
         d->frames.append(frame);
     }
+    d->trackFrame(this, frame);
     Q_EMIT frameAdded(frame);
     emit framePointStringsChanged();
 }
@@ -390,6 +444,7 @@ void Page::addFrame(Frame* frame, int index)
 void Page::removeFrame(Frame* frame)
 {
     d->frames.removeAll(frame);
+    d->frameGeometryDirty = true;
     emit framePointStringsChanged();
 }
 
@@ -408,6 +463,7 @@ bool Page::swapFrames(int swapThis, int withThis)
 {
     if(swapThis > -1 && withThis > -1) {
         d->frames.swapItemsAt(swapThis, withThis);
+        d->frameGeometryDirty = true;
         emit framePointStringsChanged();
         return true;
     }
@@ -416,16 +472,14 @@ bool Page::swapFrames(int swapThis, int withThis)
 
 QStringList Page::framePointStrings()
 {
-    QStringList frameList;
-    for (int i=0; i<d->frames.size(); i++) {
-        QStringList framePoints;
-        for (int p=0; p< frame(i)->pointCount(); p++) {
-            framePoints.append(QString("%1,%2").arg(frame(i)->point(p).x()).arg(frame(i)->point(p).y()));
-        }
-        frameList.append(framePoints.join(" "));
-    }
+    d->ensureFrameGeometry();
+    return d->framePointStrings;
+}
 
-    return frameList;
+PageGeometry Page::frameGeometry() const
+{
+    d->ensureFrameGeometry();
+    return d->frameGeometry;
 }
 
 QObjectList Page::jumps() const
@@ -454,8 +508,10 @@ void Page::addJump(Jump* jump, int index)
     QObject::connect(jump, &Jump::pointCountChanged, &d->jumpsUpdateTimer, QOverload<>::of(&QTimer::start));
     QObject::connect(jump, &Jump::boundsChanged, &d->jumpsUpdateTimer, QOverload<>::of(&QTimer::start));
     QObject::connect(jump, &Jump::pageIndexChanged, &d->jumpsUpdateTimer, QOverload<>::of(&QTimer::start));
+    QObject::connect(jump, &Jump::boundsChanged, this, [this]() { d->invalidateJumpGeometry(this); });
     QObject::connect(jump, &QObject::destroyed, &d->jumpsUpdateTimer, [this, jump]() {
         d->jumps.removeAll(jump);
+        d->invalidateJumpGeometry(this);
         d->jumpsUpdateTimer.start();
     });
 
@@ -464,6 +520,7 @@ void Page::addJump(Jump* jump, int index)
     } else {
         d->jumps.append(jump);
     }
+    d->invalidateJumpGeometry(this);
     Q_EMIT jumpAdded(jump);
     emit jumpsChanged();
 }
@@ -478,6 +535,7 @@ void Page::addJump(int pageIndex, int index)
 void Page::removeJump(Jump* jump)
 {
     d->jumps.removeAll(jump);
+    d->invalidateJumpGeometry(this);
     emit jumpsChanged();
 }
 
@@ -490,12 +548,29 @@ bool Page::swapJumps(int swapThis, int withThis)
 {
     if(swapThis > -1 && withThis > -1) {
         d->jumps.swapItemsAt(swapThis, withThis);
+        d->invalidateJumpGeometry(this);
         emit jumpsChanged();
         return true;
     }
     return false;
 }
 
+PageGeometry Page::jumpGeometry() const
+{
+    d->ensureJumpGeometry();
+    return d->jumpGeometry;
+}
+
+QObjectList Page::jumpsInside(const QRectF& rect) const
+{
+    d->ensureJumpGeometry();
+    QObjectList jumpsList;
+    for (int index : d->jumpGeometry.shapesInside(rect)) {
+        jumpsList << d->jumps.at(index);
+    }
+    return jumpsList;
+}
+
 bool Page::isCoverPage() const
 {
     return d->isCoverPage;
@@ -24,6 +24,7 @@
 
 #include "AcbfDocument.h"
 #include "AcbfInternalReferenceObject.h"
+#include "AcbfPageGeometry.h"
 /**
  * \brief Class to handle page objects.
  * 
@@ -273,6 +274,14 @@ public:
      * @brief fires when the frame point strings change.
      */
     Q_SIGNAL void framePointStringsChanged();
+    /**
+     * @brief the polygons of all the frames on this page, stored compactly.
+     *
+     * The geometry is built on demand and kept until a frame is added, removed,
+     * swapped or has its points changed, so repeated lookups are cheap.
+     * @return a geometry with one shape per frame, in the same order as frames()
+     */
+    PageGeometry frameGeometry() const;
 
     /**
      * @return the list of jump objects for this page.
@@ -326,6 +335,22 @@ public:
      * @brief Emitted when the list of jumps changes.
      */
     Q_SIGNAL void jumpsChanged();
+    /**
+     * @brief the polygons of all the jumps on this page, stored compactly.
+     * @see frameGeometry()
+     * @return a geometry with one shape per jump, in the same order as jumps()
+     */
+    PageGeometry jumpGeometry() const;
+    /**
+     * @param rect - an area on the page image, in pixels (for example the bounds of a frame).
+     * @return all the jumps which lie entirely within the area, in the same order as jumps().
+     */
+    Q_INVOKABLE QObjectList jumpsInside(const QRectF& rect) const;
+    /**
+     * @brief Emitted when a jump is added, removed, swapped or moved, that is
+     * whenever the results of jumpsInside() may have changed.
+     */
+    Q_SIGNAL void jumpGeometryChanged();
 
     /**
      * @returns whether this is the cover page.
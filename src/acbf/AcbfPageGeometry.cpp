@@ -0,0 +1,280 @@
+/*
+ * Copyright (C) 2026 Dan Leinir Turthra Jensen <admin@leinir.dk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "AcbfPageGeometry.h"
+
+#include <QHash>
+#include <QSharedData>
+#include <QStringList>
+#include <qmath.h>
+
+#include <algorithm>
+
+using namespace AdvancedComicBookFormat;
+
+class PageGeometry::Private : public QSharedData
+{
+public:
+    Private()
+    {
+        // The offsets list always holds one more entry than there are shapes,
+        // so the range for shape n is always offsets[n] to offsets[n + 1]
+        offsets << 0;
+    }
+    QVector<QPoint> points;
+    QVector<int> offsets;
+    QVector<QRect> bounds;
+
+    // The size (in page pixels) of the cells in the uniform grid used for spatial lookups.
+    // Comic pages tend to be a few thousand pixels along each side, which gives us a grid
+    // of a few hundred cells, each of which holds only a handful of shapes.
+    static constexpr int cellSize{256};
+    QHash<quint64, QVector<int>> cells;
+
+    bool isValidShape(int shape) const
+    {
+        return shape > -1 && shape < bounds.count();
+    }
+
+    static int cellCoordinate(qreal position)
+    {
+        return qFloor(position / cellSize);
+    }
+
+    static quint64 cellKey(int column, int row)
+    {
+        return (quint64(quint32(column)) << 32) | quint64(quint32(row));
+    }
+
+    void addToCells(int shape)
+    {
+        const QRect& rect = bounds.at(shape);
+        const int lastColumn = cellCoordinate(rect.right());
+        const int lastRow = cellCoordinate(rect.bottom());
+        for (int column = cellCoordinate(rect.left()); column <= lastColumn; ++column) {
+            for (int row = cellCoordinate(rect.top()); row <= lastRow; ++row) {
+                cells[cellKey(column, row)] << shape;
+            }
+        }
+    }
+
+    // All the shapes which have been put in any of the cells overlapping the given rectangle
+    QVector<int> candidates(const QRectF& rect) const
+    {
+        QVector<int> found;
+        if (cells.isEmpty() || !rect.isValid()) {
+            return found;
+        }
+        const int lastColumn = cellCoordinate(rect.right());
+        const int lastRow = cellCoordinate(rect.bottom());
+        for (int column = cellCoordinate(rect.left()); column <= lastColumn; ++column) {
+            for (int row = cellCoordinate(rect.top()); row <= lastRow; ++row) {
+                const auto cell = cells.constFind(cellKey(column, row));
+                if (cell != cells.constEnd()) {
+                    found << cell.value();
+                }
+            }
+        }
+        std::sort(found.begin(), found.end());
+        found.erase(std::unique(found.begin(), found.end()), found.end());
+        return found;
+    }
+};
+
+PageGeometry::PageGeometry()
+    : d(new Private)
+{
+}
+
+PageGeometry::PageGeometry(const PageGeometry& other) = default;
+
+PageGeometry::~PageGeometry() = default;
+
+PageGeometry& PageGeometry::operator=(const PageGeometry& other) = default;
+
+void PageGeometry::clear()
+{
+    d->points.clear();
+    d->offsets.clear();
+    d->offsets << 0;
+    d->bounds.clear();
+    d->cells.clear();
+}
+
+void PageGeometry::reserve(int shapeCount, int pointCount)
+{
+    d->points.reserve(pointCount);
+    d->offsets.reserve(shapeCount + 1);
+    d->bounds.reserve(shapeCount);
+}
+
+int PageGeometry::addShape(const QList<QPoint>& points)
+{
+    QRect bounds;
+    if (points.count() > 0) {
+        int left{points.first().x()};
+        int right{left};
+        int top{points.first().y()};
+        int bottom{top};
+        for (const QPoint& point : points) {
+            d->points << point;
+            left = qMin(left, point.x());
+            right = qMax(right, point.x());
+            top = qMin(top, point.y());
+            bottom = qMax(bottom, point.y());
+        }
+        bounds = QRect(QPoint(left, top), QPoint(right, bottom));
+    }
+    d->offsets << d->points.count();
+    d->bounds << bounds;
+    const int shape = d->bounds.count() - 1;
+    if (bounds.isValid()) {
+        d->addToCells(shape);
+    }
+    return shape;
+}
+
+int PageGeometry::shapeCount() const
+{
+    return d->bounds.count();
+}
+
+int PageGeometry::totalPointCount() const
+{
+    return d->points.count();
+}
+
+int PageGeometry::pointCount(int shape) const
+{
+    if (d->isValidShape(shape)) {
+        return d->offsets.at(shape + 1) - d->offsets.at(shape);
+    }
+    return 0;
+}
+
+QPoint PageGeometry::point(int shape, int index) const
+{
+    if (index > -1 && index < pointCount(shape)) {
+        return d->points.at(d->offsets.at(shape) + index);
+    }
+    return QPoint();
+}
+
+QRect PageGeometry::bounds(int shape) const
+{
+    if (d->isValidShape(shape)) {
+        return d->bounds.at(shape);
+    }
+    return QRect();
+}
+
+QVector<QPointF> PageGeometry::polygon(int shape) const
+{
+    QVector<QPointF> polygon;
+    const int count = pointCount(shape);
+    if (count > 0) {
+        polygon.reserve(count);
+        const QPoint* point = d->points.constData() + d->offsets.at(shape);
+        const QPoint* end = point + count;
+        for (; point != end; ++point) {
+            polygon << QPointF(*point);
+        }
+    }
+    return polygon;
+}
+
+QString PageGeometry::pointString(int shape) const
+{
+    QStringList points;
+    const int count = pointCount(shape);
+    const int offset = count > 0 ? d->offsets.at(shape) : 0;
+    for (int i = 0; i < count; ++i) {
+        const QPoint& point = d->points.at(offset + i);
+        points << QStringLiteral("%1,%2").arg(point.x()).arg(point.y());
+    }
+    return points.join(QLatin1Char(' '));
+}
+
+bool PageGeometry::containsPoint(int shape, const QPointF& position) const
+{
+    const int count = pointCount(shape);
+    if (count < 3) {
+        return false;
+    }
+    const QRect& bounds = d->bounds.at(shape);
+    if (position.x() < bounds.left() || position.x() > bounds.right() + 1
+        || position.y() < bounds.top() || position.y() > bounds.bottom() + 1) {
+        return false;
+    }
+    // Standard crossing number test, counting how many edges a horizontal ray
+    // going right from the position crosses
+    bool inside{false};
+    const QPoint* points = d->points.constData() + d->offsets.at(shape);
+    for (int i = 0, j = count - 1; i < count; j = i++) {
+        const QPointF a(points[i]);
+        const QPointF b(points[j]);
+        if ((a.y() > position.y()) != (b.y() > position.y())) {
+            const qreal crossingX = a.x() + (position.y() - a.y()) * (b.x() - a.x()) / (b.y() - a.y());
+            if (position.x() < crossingX) {
+                inside = !inside;
+            }
+        }
+    }
+    return inside;
+}
+
+QVector<int> PageGeometry::shapesAt(const QPointF& position) const
+{
+    QVector<int> found;
+    const auto cell = d->cells.constFind(Private::cellKey(Private::cellCoordinate(position.x()), Private::cellCoordinate(position.y())));
+    if (cell != d->cells.constEnd()) {
+        for (int shape : cell.value()) {
+            if (containsPoint(shape, position)) {
+                found << shape;
+            }
+        }
+    }
+    return found;
+}
+
+QVector<int> PageGeometry::shapesIntersecting(const QRectF& rect) const
+{
+    QVector<int> found;
+    for (int shape : d->candidates(rect)) {
+        const QRect& bounds = d->bounds.at(shape);
+        if (rect.intersects(QRectF(bounds.x(), bounds.y(), bounds.width(), bounds.height()))) {
+            found << shape;
+        }
+    }
+    return found;
+}
+
+QVector<int> PageGeometry::shapesInside(const QRectF& rect) const
+{
+    QVector<int> found;
+    for (int shape : d->candidates(rect)) {
+        const QRect& bounds = d->bounds.at(shape);
+        if (rect.contains(QRectF(bounds.x(), bounds.y(), bounds.width(), bounds.height()))) {
+            found << shape;
+        }
+    }
+    return found;
+}
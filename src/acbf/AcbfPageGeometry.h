@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2026 Dan Leinir Turthra Jensen <admin@leinir.dk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ACBFPAGEGEOMETRY_H
+#define ACBFPAGEGEOMETRY_H
+
+#include "acbf_export.h"
+
+#include <QList>
+#include <QPoint>
+#include <QPointF>
+#include <QRect>
+#include <QRectF>
+#include <QSharedDataPointer>
+#include <QVector>
+
+namespace AdvancedComicBookFormat
+{
+/**
+ * \brief Compact storage for the polygons of a set of shapes on a page
+ *
+ * Frames, jumps and text areas all describe their area on a page as a polygon
+ * of points. Rather than have consumers walk the individual objects (and their
+ * individual point lists) whenever they need to know where things are, the Page
+ * and Textlayer classes keep one of these around, which stores all the points
+ * for one kind of shape in a single flat array, with an offset per shape, and
+ * the bounding box of each shape precalculated.
+ *
+ * Shapes are identified by their position, which matches the position of the
+ * object they were created from in the list on their container (so shape 2 in
+ * Page::frameGeometry() is the polygon for Page::frame(2)).
+ *
+ * To make hit testing cheap on pages with many shapes, the shapes are also
+ * bucketed into a uniform grid as they are added, so the spatial queries
+ * (shapesAt(), shapesIntersecting() and shapesInside()) only need to look at
+ * the shapes which are actually near the area being asked about.
+ *
+ * This is an implicitly shared value type, so copying it around is cheap.
+ */
+class ACBF_EXPORT PageGeometry
+{
+public:
+    PageGeometry();
+    PageGeometry(const PageGeometry& other);
+    ~PageGeometry();
+    PageGeometry& operator=(const PageGeometry& other);
+
+    /**
+     * \brief Remove all shapes from the geometry.
+     */
+    void clear();
+    /**
+     * \brief Reserve space for the given number of shapes and points.
+     * @param shapeCount The number of shapes which are expected to be added
+     * @param pointCount The total number of points across all those shapes
+     */
+    void reserve(int shapeCount, int pointCount);
+    /**
+     * \brief Add a new shape to the end of the list of shapes.
+     * @param points The polygon describing the shape, in page pixels
+     * @return The index of the newly added shape
+     */
+    int addShape(const QList<QPoint>& points);
+
+    /**
+     * @return The number of shapes held by this geometry.
+     */
+    int shapeCount() const;
+    /**
+     * @return The total number of points across all shapes.
+     */
+    int totalPointCount() const;
+    /**
+     * @param shape The index of a shape
+     * @return The number of points in the given shape (0 if the shape does not exist)
+     */
+    int pointCount(int shape) const;
+    /**
+     * @param shape The index of a shape
+     * @param index The index of the point inside that shape
+     * @return The requested point, or a null point if either index is out of bounds
+     */
+    QPoint point(int shape, int index) const;
+    /**
+     * @param shape The index of a shape
+     * @return The bounding rectangle for the shape (an invalid rectangle if the
+     * shape does not exist or has no points)
+     */
+    QRect bounds(int shape) const;
+    /**
+     * The polygon for a shape, in a form which can be passed directly to the
+     * QPolygonF constructor without any further conversion.
+     * @param shape The index of a shape
+     * @return The points of the shape
+     */
+    QVector<QPointF> polygon(int shape) const;
+    /**
+     * The points of the shape formatted the same way they are written into the
+     * points attribute in ACBF (that is, "x1,y1 x2,y2 x3,y3").
+     * @param shape The index of a shape
+     * @return A string representation of the shape's points
+     */
+    QString pointString(int shape) const;
+    /**
+     * Whether the given position is inside the shape, using the odd-even rule.
+     * Positions outside the bounding box are rejected without looking at the
+     * polygon itself.
+     * @param shape The index of a shape
+     * @param position A position on the page, in page pixels
+     * @return True if the position is inside the polygon for the shape
+     */
+    bool containsPoint(int shape, const QPointF& position) const;
+
+    /**
+     * @param position A position on the page, in page pixels
+     * @return The indices of all shapes whose polygon contains the position, in ascending order
+     */
+    QVector<int> shapesAt(const QPointF& position) const;
+    /**
+     * @param rect An area on the page, in page pixels
+     * @return The indices of all shapes whose bounding box overlaps the area, in ascending order
+     */
+    QVector<int> shapesIntersecting(const QRectF& rect) const;
+    /**
+     * @param rect An area on the page, in page pixels
+     * @return The indices of all shapes whose bounding box lies entirely inside the area, in ascending order
+     */
+    QVector<int> shapesInside(const QRectF& rect) const;
+private:
+    class Private;
+    QSharedDataPointer<Private> d;
+};
+}
+
+#endif//ACBFPAGEGEOMETRY_H
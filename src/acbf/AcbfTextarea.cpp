@@ -120,11 +120,13 @@ bool Textarea::fromXml(QXmlStreamReader *xmlReader, const QString& xmlData)
     setTransparent(xmlReader->attributes().value(QStringLiteral("transparent")).toString().toLower() == QStringLiteral("true"));
 
     QVector<QStringRef> points = xmlReader->attributes().value(QStringLiteral("points")).split(' ');
+    QList<QPoint> parsedPoints;
+    parsedPoints.reserve(points.count());
     for(QStringRef point : points) {
         QVector<QStringRef> elements = point.split(',');
         if(elements.length() == 2)
         {
-            addPoint(QPoint(elements.at(0).toInt(), elements.at(1).toInt()));
+            parsedPoints << QPoint(elements.at(0).toInt(), elements.at(1).toInt());
         }
         else
         {
@@ -132,6 +134,7 @@ bool Textarea::fromXml(QXmlStreamReader *xmlReader, const QString& xmlData)
             return false;
         }
     }
+    setPoints(parsedPoints);
 
     while(xmlReader->readNextStartElement())
     {
@@ -182,6 +185,12 @@ QVariantList Textarea::points() const
     return list;
 }
 
+void Textarea::setPoints(const QList<QPoint>& points)
+{
+    d->points = points;
+    emit pointCountChanged();
+}
+
 QPoint Textarea::point(int index) const
 {
     if (index < 0 || index >= d->points.count()) {
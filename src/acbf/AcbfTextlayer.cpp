@@ -36,6 +36,46 @@ public:
     QString language;
     QString bgcolor;
     QList<Textarea*> textareas;
+
+    // The compact geometry is built on request, and thrown out whenever
+    // the textareas it was built from change
+    PageGeometry textareaGeometry;
+    QStringList textareaPointStrings;
+    bool textareaGeometryDirty{true};
+
+    void invalidateTextareaGeometry(Textlayer* q)
+    {
+        textareaGeometryDirty = true;
+        Q_EMIT q->textareaGeometryChanged();
+    }
+
+    void trackTextarea(Textlayer* q, Textarea* textarea)
+    {
+        QObject::connect(textarea, &Textarea::boundsChanged, q, [this, q]() { invalidateTextareaGeometry(q); });
+        QObject::connect(textarea, &QObject::destroyed, q, [this, q]() { invalidateTextareaGeometry(q); });
+        invalidateTextareaGeometry(q);
+    }
+
+    void ensureTextareaGeometry()
+    {
+        if (textareaGeometryDirty) {
+            textareaGeometry.clear();
+            textareaGeometry.reserve(textareas.count(), textareas.count() * 4);
+            textareaPointStrings.clear();
+            textareaPointStrings.reserve(textareas.count());
+            for (const Textarea* textarea : textareas) {
+                QList<QPoint> points;
+                const int pointCount = textarea->pointCount();
+                points.reserve(pointCount);
+                for (int i = 0; i < pointCount; ++i) {
+                    points << textarea->point(i);
+                }
+                const int shape = textareaGeometry.addShape(points);
+                textareaPointStrings << textareaGeometry.pointString(shape);
+            }
+            textareaGeometryDirty = false;
+        }
+    }
 };
 
 Textlayer::Textlayer(Page* parent)
@@ -78,6 +118,7 @@ bool Textlayer::fromXml(QXmlStreamReader *xmlReader, const QString& xmlData)
                 return false;
             }
             d->textareas.append(newArea);
+            d->trackTextarea(this, newArea);
         }
         else
         {
@@ -152,6 +193,7 @@ void Textlayer::addTextarea(Textarea* textarea, int index)
     else {
         d->textareas.append(textarea);
     }
+    d->trackTextarea(this, textarea);
     Q_EMIT textareaAdded(textarea);
     Q_EMIT textareasChanged();
     Q_EMIT textareaPointStringsChanged();
@@ -166,6 +208,7 @@ void Textlayer::addTextarea(int index)
 void Textlayer::removeTextarea(Textarea* textarea)
 {
     d->textareas.removeAll(textarea);
+    d->invalidateTextareaGeometry(this);
     Q_EMIT textareasChanged();
     Q_EMIT textareaPointStringsChanged();
 }
@@ -180,6 +223,7 @@ bool Textlayer::swapTextareas(int swapThis, int withThis)
     bool success{false};
     if (swapThis > -1 && swapThis < d->textareas.count() && withThis > -1 && withThis < d->textareas.count()) {
         d->textareas.swapItemsAt(swapThis, withThis);
+        d->invalidateTextareaGeometry(this);
         InternalReferenceObject* first = qobject_cast<InternalReferenceObject*>(d->textareas[swapThis]);
         InternalReferenceObject* second = qobject_cast<InternalReferenceObject*>(d->textareas[withThis]);
         Q_EMIT first->propertyDataChanged();
@@ -195,13 +239,22 @@ bool Textlayer::swapTextareas(int swapThis, int withThis)
 
 QStringList Textlayer::textareaPointStrings()
 {
-    QStringList textAreaList;
-    for (int i=0; i<d->textareas.size(); i++) {
-        QStringList points;
-        for (int p=0; p< textarea(i)->pointCount(); p++) {
-            points.append(QString("%1,%2").arg(textarea(i)->point(p).x()).arg(textarea(i)->point(p).y()));
-        }
-        textAreaList.append(points.join(" "));
+    d->ensureTextareaGeometry();
+    return d->textareaPointStrings;
+}
+
+PageGeometry Textlayer::textareaGeometry() const
+{
+    d->ensureTextareaGeometry();
+    return d->textareaGeometry;
+}
+
+QObjectList Textlayer::textareasInside(const QRectF& rect) const
+{
+    d->ensureTextareaGeometry();
+    QObjectList areas;
+    for (int index : d->textareaGeometry.shapesInside(rect)) {
+        areas << d->textareas.at(index);
     }
-    return textAreaList;
+    return areas;
 }
@@ -150,6 +150,24 @@ public:
      * @brief textareaCountChanged
      */
     Q_SIGNAL void textareaPointStringsChanged();
+    /**
+     * @brief the polygons of all the textareas in this layer, stored compactly.
+     *
+     * The geometry is built on demand and kept until a textarea is added, removed,
+     * swapped or has its points changed, so repeated lookups are cheap.
+     * @return a geometry with one shape per textarea, in the same order as textareas()
+     */
+    PageGeometry textareaGeometry() const;
+    /**
+     * @param rect - an area on the page image, in pixels (for example the bounds of a frame).
+     * @return all the textareas which lie entirely within the area, in the same order as textareas().
+     */
+    Q_INVOKABLE QObjectList textareasInside(const QRectF& rect) const;
+    /**
+     * @brief Emitted when a textarea is added, removed, swapped or moved, that is
+     * whenever the results of textareasInside() may have changed.
+     */
+    Q_SIGNAL void textareaGeometryChanged();
 private:
     class Private;
     std::unique_ptr<Private> d;
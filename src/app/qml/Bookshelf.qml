@@ -145,6 +145,8 @@ Kirigami.ScrollablePage {
         Peruse.FilterProxy {
             id: searchFilterProxy;
             sourceModel: root.model;
+            filterRole: Peruse.CategoryEntriesModel.SearchTextRole;
+            fullTextSearch: true;
         }
         keyNavigationEnabled: true;
         clip: true;
@@ -233,6 +233,19 @@ ListView {
                 id: image
                 width: flick.contentWidth
                 height: flick.contentHeight
+                // Draws the page at full resolution when zoomed in past what the image itself was loaded at
+                Peruse.TiledPageItem {
+                    id: pageTiles
+                    x: image.offsetX
+                    y: image.offsetY
+                    width: image.paintedWidth
+                    height: image.paintedHeight
+                    bookModel: root.model
+                    source: model.url
+                    active: flick.ListView.isCurrentItem && image.status === Image.Ready && image.paintedWidth * Screen.devicePixelRatio > image.decodedWidth
+                    viewport: Qt.rect(flick.contentX - x, flick.contentY - y, flick.width, flick.height)
+                    onSourceSizeChanged: flick.refocusFrame();
+                }
                 Helpers.HolyRectangle {
                     id: pageHole
                     anchors.fill: parent
@@ -244,12 +257,11 @@ ListView {
                 source: model.url
                 fillMode: Image.PreserveAspectFit
                 asynchronous: true
-                property bool shouldCheat: imageWidth * 2 > maxTextureSize || imageHeight * 2 > maxTextureSize;
                 property bool isTall: imageHeight < imageWidth;
-                property int fixedWidth: isTall ? maxTextureSize * (imageWidth / imageHeight) : maxTextureSize;
-                property int fixedHeight: isTall ? maxTextureSize : maxTextureSize * (imageHeight / imageWidth);
-                sourceSize.width: shouldCheat ? fixedWidth : imageWidth * 2;
-                sourceSize.height: shouldCheat ? fixedHeight : imageHeight * 2;
+                // Load the page at the size it fits on the screen at, as the tiles take care of
+                // anything larger. The source size is in logical pixels, and still has to fit in a texture.
+                sourceSize.width: Math.min(imageWidth, maxTextureSize / Screen.devicePixelRatio);
+                sourceSize.height: Math.min(imageHeight, maxTextureSize / Screen.devicePixelRatio);
                 MouseArea {
                     anchors.fill: parent
                 }
@@ -272,8 +284,11 @@ ListView {
                 property rect paintedRect: Qt.rect(offsetX, offsetY, paintedWidth, paintedHeight);
 
                 // This is some magic that QML Image does for us, to be helpful. It isn't very helpful to us.
-                property int pixWidth: image.implicitWidth * Screen.devicePixelRatio;
-                property int pixHeight: image.implicitHeight * Screen.devicePixelRatio;
+                property int decodedWidth: image.implicitWidth * Screen.devicePixelRatio;
+                property int decodedHeight: image.implicitHeight * Screen.devicePixelRatio;
+                // The frames are given in the pixels of the full size page, which is larger than what we load
+                property int pixWidth: pageTiles.sourceSize.width > 0 ? pageTiles.sourceSize.width : decodedWidth;
+                property int pixHeight: pageTiles.sourceSize.height > 0 ? pageTiles.sourceSize.height : decodedHeight;
 
                 function focusOnFrame() {
                     flick.resizeContent(imageWidth, imageHeight, Qt.point(flick.contentX, flick.contentY));
@@ -340,29 +355,45 @@ ListView {
 
                 function initFrame() {
                     currentJumpIndex = Kirigami.Settings.isMobile? -1 : 0;
+                    updateFrameJumps();
+                    updateFrameLinkRects();
+                }
+
+                function updateFrameJumps() {
                     var newFrameJumps = [];
 
                     if(currentFrameObj === noFrame) {
                         newFrameJumps = image.currentPageObject? image.currentPageObject.jumps : [];
-                    } else {
-                        for(var i = 0; i < image.currentPageObject.jumps.length; i++) {
-                            var jumpObj = image.currentPageObject.jump(i);
-                            if(frameContainsJump(jumpObj)) {
-                                newFrameJumps.push(jumpObj);
-                            }
-                        }
+                    } else if(flick.ListView.isCurrentItem) {
+                        // The page keeps a spatial index of its jumps, so ask that rather than testing each jump here
+                        newFrameJumps = image.currentPageObject.jumpsInside(image.currentFrameObj.bounds);
                     }
                     frameJumps = newFrameJumps;
-                    updateFrameLinkRects();
+                    if (currentJumpIndex >= frameJumps.length) {
+                        currentJumpIndex = Kirigami.Settings.isMobile? -1 : 0;
+                    }
+                }
+                // jumpsInside() and textareasInside() are not properties, so nothing would
+                // otherwise tell us when the jumps or textareas on the page have moved
+                Connections {
+                    target: image.currentPageObject
+                    function onJumpGeometryChanged() { image.updateFrameJumps(); }
+                }
+                Connections {
+                    target: textAreaRepeater.textLayer
+                    function onTextareaGeometryChanged() { image.updateFrameLinkRects(); }
                 }
 
                 property var frameLinkRects: [];
                 function updateFrameLinkRects() {
                     var newLinkRects = [];
-                    for(var i = 0; i < textAreaRepeater.model.length; i++) {
-                        if (frameContainsJump(textAreaRepeater.model[i])) {
-                            for(var j = 0; j < textAreaRepeater.count; j++) {
-                                newLinkRects.push(textAreaRepeater.itemAt(j).linkRects[j]);
+                    var textLayer = textAreaRepeater.textLayer;
+                    if (textLayer && flick.ListView.isCurrentItem) {
+                        var frameTextareas = image.currentFrameObj === noFrame ? textLayer.textareas : textLayer.textareasInside(image.currentFrameObj.bounds);
+                        for(var i = 0; i < frameTextareas.length; i++) {
+                            var textAreaItem = textAreaRepeater.itemAt(frameTextareas[i].localIndex);
+                            if (textAreaItem) {
+                                newLinkRects = newLinkRects.concat(textAreaItem.linkRects);
                             }
                         }
                     }
@@ -470,10 +501,12 @@ ListView {
                     Helpers.HolyRectangle {
                         anchors.fill: parent;
                         property QtObject frameObj: image.currentPageObject ? image.currentPageObject.frame(index) : noFrame;
-                        property rect frameRect: Qt.rect((image.muliplier * frameObj.bounds.x) + image.offsetX,
-                                            (image.muliplier * frameObj.bounds.y) + image.offsetY,
-                                            (image.muliplier * frameObj.bounds.width),
-                                            (image.muliplier * frameObj.bounds.height))
+                        // Bound through the frame object, so the overlay follows the frame when its points are edited
+                        property rect frameBounds: frameObj.bounds;
+                        property rect frameRect: Qt.rect((image.muliplier * frameBounds.x) + image.offsetX,
+                                            (image.muliplier * frameBounds.y) + image.offsetY,
+                                            (image.muliplier * frameBounds.width),
+                                            (image.muliplier * frameBounds.height))
                         color: frameObj.bgcolor;
                         opacity: image.currentFrame === index ? 1 : 0;
                         visible: opacity > 0;
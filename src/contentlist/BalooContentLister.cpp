@@ -23,13 +23,12 @@
 
 #include <Baloo/IndexerConfig>
 #include <Baloo/File>
-#include <KFileMetaData/PropertyInfo>
-#include <KFileMetaData/UserMetaData>
+#include <KFileMetaData/Properties>
 
 #include <QDateTime>
 #include <QList>
 #include <QFileInfo>
-#include <QProcess>
+#include <QStandardPaths>
 #include <QThreadPool>
 #include <QMimeDatabase>
 
@@ -48,6 +47,9 @@ public:
     QString searchString;
     QList<Baloo::QueryRunnable*> queries;
     QList<QString> queryLocations;
+    // The queries for the different locations do not depend on each other, so they all run
+    // at the same time, on a pool of our own so we only ever wait for our own queries
+    QThreadPool pool;
 
     QMimeDatabase mimeDatabase;
 };
@@ -60,7 +62,7 @@ BalooContentLister::BalooContentLister(QObject* parent)
 
 BalooContentLister::~BalooContentLister()
 {
-    QThreadPool::globalInstance()->waitForDone();
+    d->pool.waitForDone();
     delete d;
 }
 
@@ -77,18 +79,11 @@ bool BalooContentLister::balooEnabled() const
 
         if(result)
         {
-            // It would be terribly nice with a bit of baloo engine exporting, so
-            // we can ask the database about whether or not it is accessible...
-            // But, this is a catch-all check anyway, so we get a complete "everything's broken"
-            // result if anything is broken... guess it will do :)
-            QProcess statuscheck;
-            statuscheck.start("balooctl", QStringList() << "status");
-            statuscheck.waitForFinished();
-            QString output = statuscheck.readAll();
-            if(statuscheck.exitStatus() == QProcess::CrashExit || statuscheck.exitCode() != 0)
-            {
-                result = false;
-            }
+            // Baloo does not export a way to ask whether its database is accessible, but
+            // if there is no index there will be no results either, so check for that
+            // (rather than running balooctl and waiting for it to answer)
+            const QFileInfo index(QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation) + QStringLiteral("/baloo/index"));
+            result = index.isFile() && index.isReadable() && index.size() > 0;
         }
     }
 
@@ -108,9 +103,10 @@ void BalooContentLister::startSearch(const QList<ContentQuery*>& queries)
             d->queries.append(d->createQuery(query));
     }
 
-    if(!d->queries.empty())
+    d->pool.setMaxThreadCount(qMax(d->pool.maxThreadCount(), d->queries.count()));
+    for(Baloo::QueryRunnable* query : qAsConst(d->queries))
     {
-        QThreadPool::globalInstance()->start(d->queries.first());
+        d->pool.start(query);
     }
 }
 
@@ -121,10 +117,6 @@ void BalooContentLister::queryCompleted(Baloo::QueryRunnable* query)
     {
         emit searchCompleted();
     }
-    else
-    {
-        QThreadPool::globalInstance()->start(d->queries.first());
-    }
 }
 
 void BalooContentLister::queryResult(const ContentQuery* query, const QString& location, const QString& file)
@@ -138,32 +130,43 @@ void BalooContentLister::queryResult(const ContentQuery* query, const QString& l
         return;
     }
 
-    // Like the one above, this is also not nice: apparently Baloo can return results to
-    // files that no longer exist on the file system. So we have to check manually whether
-    // the results provided are actually sensible results...
-    if(!QFile::exists(file)) {
-        return;
-    }
-
-    // It would be nice if Baloo could do mime type filtering on its own...
+    // It would be nice if Baloo could do mime type filtering on its own... Baloo has already
+    // looked at the content to find the type we asked for, so going by the name is enough here.
     if(!query->mimeTypes().isEmpty()) {
-        const auto &mimeType = d->mimeDatabase.mimeTypeForFile(file).name();
+        const auto &mimeType = d->mimeDatabase.mimeTypeForFile(file, QMimeDatabase::MatchExtension).name();
         if(!query->mimeTypes().contains(mimeType))
             return;
     }
 
-    auto metadata = metaDataForFile(file);
+    // Like the one above, this is also not nice: apparently Baloo can return results to
+    // files that no longer exist on the file system. So we have to check manually whether
+    // the results provided are actually sensible results... The information is kept, so
+    // this is also the only stat of the file we need.
+    const QFileInfo info(file);
+    if(!info.exists()) {
+        return;
+    }
+
+    auto metadata = metaDataForFile(info);
 
+    // Only copy across the properties the library actually uses
     Baloo::File balooFile(file);
     balooFile.load();
-    KFileMetaData::PropertyMap properties = balooFile.properties();
-    KFileMetaData::PropertyMap::const_iterator it = properties.constBegin();
-    for (; it != properties.constEnd(); it++)
-    {
-        KFileMetaData::PropertyInfo propInfo(it.key());
-        metadata[propInfo.name()] = it.value();
+    const QVariant author = balooFile.property(KFileMetaData::Property::Author);
+    if(author.isValid()) {
+        metadata[QStringLiteral("author")] = author;
+    }
+    const QVariant title = balooFile.property(KFileMetaData::Property::Title);
+    if(title.isValid()) {
+        metadata[QStringLiteral("title")] = title;
+    }
+    const QVariant publisher = balooFile.property(KFileMetaData::Property::Publisher);
+    if(publisher.isValid()) {
+        metadata[QStringLiteral("publisher")] = publisher;
     }
 
+    // The queries run at the same time, and their locations may overlap
+    knownFiles.insert(file);
     emit fileFound(file, metadata);
 }
 
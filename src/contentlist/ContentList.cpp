@@ -35,6 +35,8 @@ struct ContentEntry {
     QString filename;
     QUrl filePath;
     QVariantMap metadata;
+    // Known files only get their metadata read once something asks for it
+    bool metadataLoaded{true};
 };
 
 class ContentList::Private {
@@ -44,6 +46,10 @@ public:
     Private()
         : actualContentList(nullptr)
     {}
+    ~Private()
+    {
+        qDeleteAll(entries);
+    }
     QList<ContentEntry*> entries;
     ContentListerBase* actualContentList;
 
@@ -179,8 +185,11 @@ void ContentList::setCacheResults(bool cacheResults)
 void ContentList::setKnownFiles(const QStringList& results)
 {
     beginResetModel();
+    qDeleteAll(d->entries);
     d->entries.clear();
     d->knownFiles.clear();
+    d->entries.reserve(results.count());
+    d->knownFiles.reserve(results.count());
     for(const auto& result : results)
     {
         auto entry = new ContentEntry{};
@@ -188,7 +197,10 @@ void ContentList::setKnownFiles(const QStringList& results)
 
         entry->filename = url.fileName();
         entry->filePath = url;
-        entry->metadata = ContentListerBase::metaDataForFile(result);
+        // Reading the metadata means a stat and several extended attribute reads per
+        // file, which adds up quickly for a large library, and the library has its own
+        // copy of all this already, so leave it until someone actually asks for it.
+        entry->metadataLoaded = false;
 
         d->entries.append(entry);
         d->knownFiles.insert(result);
@@ -210,7 +222,7 @@ QVariant ContentList::data(const QModelIndex& index, int role) const
     QVariant result;
     if(index.isValid() && index.row() > -1 && index.row() < d->entries.count())
     {
-        const ContentEntry* entry = d->entries[index.row()];
+        ContentEntry* entry = d->entries[index.row()];
         switch(role)
         {
             case FilenameRole:
@@ -220,6 +232,11 @@ QVariant ContentList::data(const QModelIndex& index, int role) const
                 result.setValue(entry->filePath);
                 break;
             case MetadataRole:
+                if(!entry->metadataLoaded)
+                {
+                    entry->metadata = ContentListerBase::metaDataForFile(entry->filePath.toLocalFile());
+                    entry->metadataLoaded = true;
+                }
                 result.setValue(entry->metadata);
                 break;
             default:
@@ -129,7 +129,9 @@ public:
      * \brief Fill the model with the results.
      * 
      * This clears the model of search entries and then
-     * fills it up with the new entries.
+     * fills it up with the new entries. The metadata for
+     * these entries is only read from the files once it is
+     * requested through the metadata role.
      * 
      * @param results a stringlist with paths to the new
      * search results.
@@ -43,14 +43,19 @@ void ContentListerBase::startSearch(const QList<ContentQuery*>& queries)
 }
 
 QVariantMap ContentListerBase::metaDataForFile(const QString& file)
+{
+    return metaDataForFile(QFileInfo(file));
+}
+
+QVariantMap ContentListerBase::metaDataForFile(const QFileInfo& info)
 {
     QVariantMap metadata;
+    const QString file = info.filePath();
 
     //TODO: This should include the same information for both the Baloo and
     //File searchers. Unfortunately, currently KFileMetaData does not seem able
     //to provide this. So this needs changes at a lower level.
 
-    QFileInfo info(file);
     metadata["lastModified"] = info.lastModified();
     metadata["created"] = info.birthTime();
     metadata["lastRead"] = info.lastRead();
@@ -27,6 +27,7 @@
 #include <QString>
 
 class ContentQuery;
+class QFileInfo;
 /**
  * \brief Class to handle the search.
  * 
@@ -61,6 +62,11 @@ public:
      * @return the available metadata for the filepath so that it can be searched.
      */
     static QVariantMap metaDataForFile(const QString& file);
+    /**
+     * @return the available metadata for the file so that it can be searched. Use this
+     * when the file has already been looked at, to avoid looking at it again.
+     */
+    static QVariantMap metaDataForFile(const QFileInfo& info);
 
 protected:
     friend class ContentList;
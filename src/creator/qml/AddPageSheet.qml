@@ -58,12 +58,20 @@ Kirigami.OverlaySheet {
             onClicked: openDlg.open();
             FileDialog {
                 id: openDlg;
-                title: i18nc("@title:window standard file open dialog used to find a page to add to the book", "Please Choose an Image to Add");
+                title: i18nc("@title:window standard file open dialog used to find a page to add to the book", "Please Choose Images to Add");
                 folder: mainWindow.homeDir();
+                selectMultiple: true;
                 property int splitPos: osIsWindows ? 8 : 7;
                 onAccepted: {
-                    if(openDlg.fileUrl.toString().substring(0, 7) === "file://") {
-                        root.model.addPageFromFile(openDlg.fileUrl.toString().substring(splitPos));
+                    var files = [];
+                    for (var i = 0; i < openDlg.fileUrls.length; ++i) {
+                        var fileUrl = openDlg.fileUrls[i].toString();
+                        if(fileUrl.substring(0, 7) === "file://") {
+                            files.push(fileUrl.substring(splitPos));
+                        }
+                    }
+                    if (files.length > 0) {
+                        root.model.addPagesFromFiles(files);
                         root.close();
                     }
                 }
@@ -164,6 +164,15 @@ Kirigami.ScrollablePage {
                 anchors.centerIn: parent
                 width: parent.width - (Kirigami.Units.largeSpacing * 4)
                 text: root.model ? root.model.processingDescription : "";
+                explanation: root.model && root.model.processing && root.model.saveProgress > 0
+                    ? i18nc("How far along saving the book is", "%1% done", root.model.saveProgress)
+                    : "";
+                helpfulAction: Kirigami.Action {
+                    text: i18nc("Stop saving the book, and leave the file as it was", "Cancel");
+                    icon.name: "dialog-cancel";
+                    enabled: root.model ? root.model.saving : false;
+                    onTriggered: root.model.cancelSave();
+                }
             }
         }
         QtControls.BusyIndicator {
@@ -36,24 +36,30 @@ Kirigami.Page {
     id: root;
     property string categoryName: "createNewBook";
     title: i18nc("title of the new book creation page", "Create New Book");
+    // The book being written by newBookModel, which gets opened once it is on disk
+    property string newBookFilename;
 
     actions {
         main: Kirigami.Action {
             text: i18nc("Accept button which will create a new book", "Create Book");
             iconName: "dialog-ok";
+            enabled: !newBookModel.processing;
             property int splitPos: osIsWindows ? 8 : 7;
             onTriggered: {
-                var filename = newBookModel.createBook(getFolderDlg.folder.toString().substring(splitPos), titleEdit.text, getCoverDlg.fileUrl.toString().substring(splitPos));
-                if(filename.length > 0)
-                {
-                    mainWindow.openBook(filename);
-                }
+                root.newBookFilename = newBookModel.createBook(getFolderDlg.folder.toString().substring(splitPos), titleEdit.text, getCoverDlg.fileUrl.toString().substring(splitPos));
             }
         }
     }
     Peruse.ArchiveBookModel {
         id: newBookModel;
         qmlEngine: globalQmlEngine;
+        onSaveCompleted: {
+            if(success && root.newBookFilename.length > 0)
+            {
+                mainWindow.openBook(root.newBookFilename);
+            }
+            root.newBookFilename = "";
+        }
     }
 
     Column {
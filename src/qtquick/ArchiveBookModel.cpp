@@ -21,6 +21,11 @@
 
 #include "ArchiveBookModel.h"
 #include "ArchiveImageProvider.h"
+#include "ArchiveMetadataProbe.h"
+#include "ArchiveSaveJob.h"
+#include "ComicMetadata.h"
+#include "PerformanceTimer.h"
+#include "ZipRewriter.h"
 
 #include <AcbfAuthor.h>
 #include <AcbfBody.h>
@@ -32,14 +37,16 @@
 #include <AcbfPublishinfo.h>
 #include <AcbfStyleSheet.h>
 
+#include <QBuffer>
 #include <QCoreApplication>
 #include <QDir>
 #include <QFontDatabase>
 #include <QImageReader>
 #include <QMimeDatabase>
+#include <QPointer>
 #include <QQmlEngine>
-#include <QTemporaryFile>
-#include <QXmlStreamReader>
+#include <QSharedPointer>
+#include <QThreadPool>
 
 #include <KFileMetaData/UserMetaData>
 #include <KLocalizedString>
@@ -50,6 +57,8 @@
 #include <qtquick_debug.h>
 #include <AcbfData.h>
 
+QStringList recursiveEntries(const KArchiveDirectory* dir);
+
 class ArchiveBookModel::Private
 {
 public:
@@ -83,11 +92,45 @@ public:
     QHash<QString, int> fontIdByFilename;
     QString acbfEntryName;
 
+    // Files on disk waiting to be added to the archive on the next save (archive name, local file).
+    // Their pages are in the model and the ACBF document already. Changed with archiveMutex held,
+    // as the image provider reads pages from here until they are in the archive.
+    QList<QPair<QString, QString>> filesToAdd;
+    // Increased when the book is closed, so page files checked for a previous book get dropped
+    int importGeneration{0};
+    // Increased every time something changes, so we can tell whether anything changed during a save
+    int modificationCount{0};
+    ArchiveSaveJob* saveJob{nullptr};
+    // Set, with archiveMutex held, while a save job is writing the archive. The file on disk can
+    // be replaced at any point then, so the archive must not be reopened from it until we are done.
+    bool archiveLocked{false};
+    int saveProgress{0};
+    // What the currently running save job was asked to do
+    QString savingAcbfEntryName;
+    QStringList savingEntriesToDelete;
+    QList<QPair<QString, QString>> savingFiles;
+    int savingModificationCount{0};
+
     void closeBook() {
+        if (saveJob) {
+            // Let the save finish on its own (the job is not ours, and deletes itself when done),
+            // but it's no longer our business what happens to it
+            QObject::disconnect(saveJob, nullptr, q, nullptr);
+            saveJob = nullptr;
+            q->setProcessing(false);
+            Q_EMIT q->savingChanged();
+        }
+        {
+            QMutexLocker locker(&q->archiveMutex);
+            filesToAdd.clear();
+        }
+        ++importGeneration;
         q->beginResetModel();
         if(archive)
         {
             q->clearPages();
+            QMutexLocker locker(&q->archiveMutex);
+            archiveLocked = false;
             archiveFiles.clear();
             archive->close();
             delete archive;
@@ -114,9 +157,177 @@ public:
     void setDirty()
     {
         isDirty = true;
+        ++modificationCount;
         emit q->hasUnsavedChangesChanged();
     }
 
+    ArchiveSaveJob* createSaveJob()
+    {
+        if (!archive) {
+            return nullptr;
+        }
+        AdvancedComicBookFormat::Document* acbfDocument = qobject_cast<AdvancedComicBookFormat::Document*>(q->acbfData());
+        if(!acbfDocument)
+        {
+            acbfDocument = createNewAcbfDocumentFromLegacyInformation();
+        }
+        savingAcbfEntryName = acbfEntryName;
+        if (savingAcbfEntryName.isEmpty()) {
+            savingAcbfEntryName = QStringLiteral("metadata.acbf");
+        }
+        savingEntriesToDelete = fileEntriesToDelete;
+        savingFiles = filesToAdd;
+        savingModificationCount = modificationCount;
+
+        // Not parented to us, as closing the book (or the window showing it) must not throw away the save
+        saveJob = new ArchiveSaveJob(archive->fileName());
+        QString acbfXml;
+        {
+            PerformanceTimer serializeTimer("Document::toXml");
+            acbfXml = acbfDocument->toXml();
+        }
+        saveJob->setAcbfData(savingAcbfEntryName, acbfXml.toUtf8());
+        saveJob->setEntriesToDelete(savingEntriesToDelete);
+        for (const auto& file : qAsConst(savingFiles)) {
+            saveJob->addLocalFile(file.first, file.second);
+        }
+        QObject::connect(saveJob, &KJob::infoMessage, q, [this](KJob*, const QString& message){
+            q->setProcessingDescription(message);
+        });
+        QObject::connect(saveJob, &KJob::percentChanged, q, [this](KJob*, unsigned long percent){
+            saveProgress = int(percent);
+            Q_EMIT q->saveProgressChanged();
+        });
+        QObject::connect(saveJob, &KJob::result, q, [this](KJob* job){
+            finishSave(static_cast<ArchiveSaveJob*>(job));
+        });
+        {
+            // Pages shown while saving are read from the archive as it was when the save started,
+            // which stays readable through the open file even once the new one has replaced it
+            QMutexLocker locker(&q->archiveMutex);
+            archiveFiles.clear();
+            if (!archive->isOpen()) {
+                archive->open(QIODevice::ReadOnly);
+            }
+            archiveLocked = true;
+        }
+        saveProgress = 0;
+        Q_EMIT q->saveProgressChanged();
+        q->setProcessing(true);
+        Q_EMIT q->savingChanged();
+        return saveJob;
+    }
+
+    // Once the new archive is on disk, switch over to reading from that, without otherwise
+    // disturbing the model (the pages and metadata are what we just saved, after all)
+    void finishSave(ArchiveSaveJob* job)
+    {
+        saveJob = nullptr;
+        const bool success = (job->error() == KJob::NoError);
+        {
+            QMutexLocker locker(&q->archiveMutex);
+            archiveLocked = false;
+        }
+        if (success) {
+            {
+                QMutexLocker locker(&q->archiveMutex);
+                archiveFiles.clear();
+                delete archive;
+                archive = new KZip(job->fileName());
+                if (archive->open(QIODevice::ReadOnly)) {
+                    fileEntries = recursiveEntries(archive->directory());
+                    fileEntries.sort();
+                    archive->close();
+                } else {
+                    qCWarning(QTQUICK_LOG) << "Failed to open the newly saved archive" << job->fileName();
+                }
+            }
+            Q_EMIT q->fileEntriesChanged();
+            acbfEntryName = savingAcbfEntryName;
+
+            for (const QString& entry : qAsConst(savingEntriesToDelete)) {
+                fileEntriesToDelete.removeAll(entry);
+            }
+            Q_EMIT q->fileEntriesToDeleteChanged();
+
+            // The pages are in the archive now, so they can be read from there
+            {
+                QMutexLocker locker(&q->archiveMutex);
+                for (const auto& file : qAsConst(savingFiles)) {
+                    filesToAdd.removeAll(file);
+                }
+            }
+
+            if (savingModificationCount == modificationCount) {
+                q->setDirty(false);
+            }
+        } else if (job->error() == KJob::KilledJobError) {
+            qCDebug(QTQUICK_LOG) << "Saving" << job->fileName() << "was cancelled";
+        } else {
+            qCWarning(QTQUICK_LOG) << "Failed to save" << job->fileName() << job->errorText();
+        }
+        savingFiles.clear();
+        savingEntriesToDelete.clear();
+        q->setProcessing(false);
+        Q_EMIT q->savingChanged();
+        Q_EMIT q->saveCompleted(success);
+
+        // If more pages were added while we were busy, get those written as well
+        if (success && !filesToAdd.isEmpty()) {
+            q->saveBook();
+        }
+    }
+
+    // Add a file already known to be an image we can show as a page, and queue it up to be
+    // written into the archive on the next save
+    void stagePageFile(const QString& fileUrl, int insertAfter)
+    {
+        int insertionIndex = insertAfter;
+        if(insertAfter < 0 || q->pageCount() - 1 < insertAfter) {
+            insertionIndex = q->pageCount();
+        }
+
+        // This is a permanent thing, renaming in zip files is VERY expensive (literally not possible without
+        // rewriting the entire archive...). Pages removed again before they were saved can leave gaps,
+        // so make sure we don't end up with two files by the same name.
+        const QString suffix = QFileInfo(fileUrl).completeSuffix();
+        QString archiveFileName = QString("page-%1.%2").arg(QString::number(insertionIndex), suffix);
+        {
+            QMutexLocker locker(&q->archiveMutex);
+            while (fileEntries.contains(archiveFileName) || !q->stagedFile(archiveFileName).isEmpty()) {
+                archiveFileName = QString("page-%1.%2").arg(QString::number(++insertionIndex), suffix);
+            }
+            filesToAdd << qMakePair(archiveFileName, fileUrl);
+        }
+        // The page goes into the model and the ACBF document together, so they stay in step, and
+        // is shown from the file it was added from until it has been saved into the archive
+        q->addPage(QString("image://%1/%2").arg(imageProvider->prefix()).arg(archiveFileName), archiveFileName.split("/").last());
+        setDirty();
+    }
+
+    // Add a page to the ACBF document, without adding it to the model
+    void addAcbfPage(const QString& url, const QString& title)
+    {
+        AdvancedComicBookFormat::Document* acbfDocument = qobject_cast<AdvancedComicBookFormat::Document*>(q->acbfData());
+        if(!acbfDocument)
+        {
+            acbfDocument = createNewAcbfDocumentFromLegacyInformation();
+        }
+        QUrl imageUrl(url);
+        if(q->pageCount() == 0)
+        {
+            acbfDocument->metaData()->bookInfo()->coverpage()->setTitle(title);
+            acbfDocument->metaData()->bookInfo()->coverpage()->setImageHref(QString("%1/%2").arg(imageUrl.path().mid(1)).arg(imageUrl.fileName()));
+        }
+        else
+        {
+            AdvancedComicBookFormat::Page* page = new AdvancedComicBookFormat::Page(acbfDocument);
+            page->setTitle(title);
+            page->setImageHref(QString("%1/%2").arg(imageUrl.path().mid(1)).arg(imageUrl.fileName()));
+            acbfDocument->body()->addPage(page);
+        }
+    }
+
     AdvancedComicBookFormat::Document* createNewAcbfDocumentFromLegacyInformation()
     {
         AdvancedComicBookFormat::Document* acbfDocument = new AdvancedComicBookFormat::Document(q);
@@ -200,6 +411,7 @@ QStringList recursiveEntries(const KArchiveDirectory* dir)
 
 void ArchiveBookModel::setFilename(QString newFilename)
 {
+    PerformanceTimer timer("ArchiveBookModel::setFilename");
     setProcessing(true);
     d->isLoading = true;
     d->closeBook();
@@ -208,6 +420,8 @@ void ArchiveBookModel::setFilename(QString newFilename)
     QMimeType mime = d->mimeDatabase.mimeTypeForFile(newFilename);
     if(mime.inherits("application/zip"))
     {
+        // In case the last save was interrupted part way through updating the archive
+        ZipRewriter::recover(newFilename);
         d->archive = new KZip(newFilename);
     }
     else if (mime.inherits("application/x-rar"))
@@ -264,7 +478,12 @@ void ArchiveBookModel::setFilename(QString newFilename)
             {
                 AdvancedComicBookFormat::Document* acbfDocument = new AdvancedComicBookFormat::Document(this);
                 const KArchiveFile* archFile = d->archive->directory()->file(d->acbfEntryName);
-                if(acbfDocument->fromXml(QString(archFile->data())))
+                bool parsed{false};
+                {
+                    PerformanceTimer parseTimer("Document::fromXml");
+                    parsed = acbfDocument->fromXml(QString(archFile->data()));
+                }
+                if(parsed)
                 {
                     setAcbfData(acbfDocument);
                     addPage(QString("image://%1/%2").arg(prefix).arg(acbfDocument->metaData()->bookInfo()->coverpage()->imageHref()), acbfDocument->metaData()->bookInfo()->coverpage()->title());
@@ -287,7 +506,11 @@ void ArchiveBookModel::setFilename(QString newFilename)
                 if (!comicInfoEntry.isEmpty()) {
                     loadData = loadComicInfoXML(archFile->data(), acbfDocument, images, newFilename);
                 } else {
-                    loadData = loadCoMet(xmlFiles, acbfDocument, images, newFilename);
+                    // Only look at the start of each xml file, and only the once per archive
+                    const QString coMetEntry = ArchiveMetadataProbe::findCoMetEntry(newFilename, d->archive->directory(), xmlFiles);
+                    if (!coMetEntry.isEmpty()) {
+                        loadData = loadCoMet(QStringList(coMetEntry), acbfDocument, images, newFilename);
+                    }
                 }
 
                 if (loadData) {
@@ -466,8 +689,12 @@ bool ArchiveBookModel::hasUnsavedChanges() const
 
 void ArchiveBookModel::setDirty(bool isDirty)
 {
-    d->isDirty = isDirty;
-    emit hasUnsavedChangesChanged();
+    if (isDirty) {
+        d->setDirty();
+    } else {
+        d->isDirty = false;
+        emit hasUnsavedChangesChanged();
+    }
 }
 
 QStringList ArchiveBookModel::fileEntries() const
@@ -538,115 +765,37 @@ void ArchiveBookModel::markArchiveFileForDeletion(const QString& archiveFile, bo
 
 bool ArchiveBookModel::saveBook()
 {
-    bool success = true;
-    if(d->isDirty)
-    {
-        QMutexLocker locker(&archiveMutex);
-        // TODO get new filenames out of acbf
-
-        setProcessing(true);
-        qApp->processEvents();
-
-        QTemporaryFile tmpFile(this);
-        tmpFile.open();
-        QString archiveFileName = tmpFile.fileName().append(".cbz");
-        QFileInfo fileInfo(tmpFile);
-        tmpFile.close();
-        setProcessingDescription(i18n("Creating archive in %1", archiveFileName));
-        KZip* archive = new KZip(archiveFileName);
-        archive->open(QIODevice::ReadWrite);
-
-        QString acbfFileName{d->acbfEntryName};
-        if (acbfFileName.isEmpty()) {
-            acbfFileName = QStringLiteral("metadata.acbf");
-        } else {
-            // If we actually /have/ an acbf filename already, let's not copy the old one across...
-            d->fileEntriesToDelete << acbfFileName;
-        }
-        // We're a zip file... size isn't used
-        setProcessingDescription(i18n("Writing in ACBF data"));
-        archive->prepareWriting(acbfFileName, fileInfo.owner(), fileInfo.group(), 0);
-        AdvancedComicBookFormat::Document* acbfDocument = qobject_cast<AdvancedComicBookFormat::Document*>(acbfData());
-        if(!acbfDocument)
-        {
-            acbfDocument = d->createNewAcbfDocumentFromLegacyInformation();
-        }
-        QByteArray acbfStringUtf8 = acbfDocument->toXml().toUtf8();
-        archive->writeData(acbfStringUtf8, acbfStringUtf8.size());
-        archive->finishWriting(acbfStringUtf8.size());
-
-        setProcessingDescription(i18n("Copying across all files not marked for deletion"));
-        const QStringList allFiles = fileEntries();
-        const KArchiveFile* archFile{nullptr};
-        for( const QString& file : allFiles) {
-            qApp->processEvents();
-            if (d->fileEntriesToDelete.contains(file)) {
-                qCDebug(QTQUICK_LOG) << "Not copying file marked for deletion:" << file;
-            } else {
-                setProcessingDescription(i18n("Copying over %1", file));
-                archFile = archiveFile(file);
-                if(archFile && archFile->isFile())
-                {
-                    archive->prepareWriting(file, archFile->user(), archFile->group(), 0);
-                    archive->writeData(archFile->data(), archFile->size());
-                    archive->finishWriting(archFile->size());
-                }
-            }
-        }
-        d->fileEntriesToDelete.clear();
-        Q_EMIT fileEntriesToDeleteChanged();
-
-        archive->close();
-        qCDebug(QTQUICK_LOG) << "Archive created and closed...";
+    if (d->saveJob) {
+        qCDebug(QTQUICK_LOG) << "Already saving" << filename() << "- not starting another save until that is done";
+        return false;
+    }
+    if (!d->isDirty && d->filesToAdd.isEmpty()) {
+        return true;
+    }
+    ArchiveSaveJob* job = d->createSaveJob();
+    if (!job) {
+        return false;
+    }
+    job->start();
+    return true;
+}
 
-        // swap out the two files, tell model we're about to swap things out...
-        beginResetModel();
+void ArchiveBookModel::cancelSave()
+{
+    if (d->saveJob) {
+        setProcessingDescription(i18n("Cancelling..."));
+        d->saveJob->cancel();
+    }
+}
 
-        QString actualFile = d->archive->fileName();
-        d->closeBook();
+bool ArchiveBookModel::saving() const
+{
+    return d->saveJob != nullptr;
+}
 
-        // This seems roundabout... but it retains ctime and xattrs, which would be gone
-        // if we just did a delete+rename
-        QFile destinationFile(actualFile);
-        if(destinationFile.open(QIODevice::WriteOnly))
-        {
-            QFile originFile(archiveFileName);
-            if(originFile.open(QIODevice::ReadOnly)) {
-                setProcessingDescription(i18n("Copying all content from %1 to %2", archiveFileName, actualFile));
-                while(!originFile.atEnd())
-                {
-                    destinationFile.write(originFile.read(65536));
-                    qApp->processEvents();
-                }
-                destinationFile.close();
-                originFile.close();
-                if(originFile.remove())
-                {
-                    setProcessingDescription(i18n("Successfully replaced old archive with the new archive - now loading the new archive..."));
-                    // now load the new thing...
-                    locker.unlock();
-                    setFilename(actualFile);
-                    locker.relock();
-                }
-                else
-                {
-                    qCWarning(QTQUICK_LOG) << "Failed to delete" << originFile.fileName();
-                }
-            }
-            else
-            {
-                qCWarning(QTQUICK_LOG) << "Failed to open" << originFile.fileName() << "for reading";
-            }
-        }
-        else
-        {
-            qCWarning(QTQUICK_LOG) << "Failed to open" << destinationFile.fileName() << "for writing";
-        }
-    }
-    endResetModel();
-    setProcessing(false);
-    setDirty(false);
-    return success;
+int ArchiveBookModel::saveProgress() const
+{
+    return d->saveProgress;
 }
 
 void ArchiveBookModel::addPage(QString url, QString title)
@@ -654,24 +803,7 @@ void ArchiveBookModel::addPage(QString url, QString title)
     // don't do this unless we're done loading... don't want to dirty things up until then!
     if(!d->isLoading)
     {
-        AdvancedComicBookFormat::Document* acbfDocument = qobject_cast<AdvancedComicBookFormat::Document*>(acbfData());
-        if(!acbfDocument)
-        {
-            acbfDocument = d->createNewAcbfDocumentFromLegacyInformation();
-        }
-        QUrl imageUrl(url);
-        if(pageCount() == 0)
-        {
-            acbfDocument->metaData()->bookInfo()->coverpage()->setTitle(title);
-            acbfDocument->metaData()->bookInfo()->coverpage()->setImageHref(QString("%1/%2").arg(imageUrl.path().mid(1)).arg(imageUrl.fileName()));
-        }
-        else
-        {
-            AdvancedComicBookFormat::Page* page = new AdvancedComicBookFormat::Page(acbfDocument);
-            page->setTitle(title);
-            page->setImageHref(QString("%1/%2").arg(imageUrl.path().mid(1)).arg(imageUrl.fileName()));
-            acbfDocument->body()->addPage(page);
-        }
+        d->addAcbfPage(url, title);
     }
     BookModel::addPage(url, title);
 }
@@ -680,6 +812,17 @@ void ArchiveBookModel::removePage(int pageNumber)
 {
     if(!d->isLoading)
     {
+        // A page which has not been written into the archive yet does not need to be
+        const QString entry = QUrl(data(index(pageNumber, 0), BookModel::UrlRole).toString()).path().mid(1);
+        {
+            QMutexLocker locker(&archiveMutex);
+            for (int i = 0; i < d->filesToAdd.count(); ++i) {
+                if (d->filesToAdd.at(i).first == entry && !d->savingFiles.contains(d->filesToAdd.at(i))) {
+                    d->filesToAdd.removeAt(i);
+                    break;
+                }
+            }
+        }
         AdvancedComicBookFormat::Document* acbfDocument = qobject_cast<AdvancedComicBookFormat::Document*>(acbfData());
         if(!acbfDocument)
         {
@@ -717,26 +860,64 @@ void ArchiveBookModel::removePage(int pageNumber)
 
 void ArchiveBookModel::addPageFromFile(QString fileUrl, int insertAfter)
 {
-    if(d->archive && d->readWrite && !d->isDirty)
-    {
-        int insertionIndex = insertAfter;
-        if(insertAfter < 0 || pageCount() - 1 < insertAfter) {
-            insertionIndex = pageCount();
-        }
+    addPagesFromFiles(QStringList{fileUrl}, insertAfter);
+}
 
-        // This is a permanent thing, renaming in zip files is VERY expensive (literally not possible without
-        // rewriting the entire archive...)
-        QString archiveFileName = QString("page-%1.%2").arg(QString::number(insertionIndex), QFileInfo(fileUrl).completeSuffix());
-        d->archive->close();
-        d->archive->open(QIODevice::ReadWrite);
-        d->archive->addLocalFile(fileUrl, archiveFileName);
-        d->archive->close();
-        d->archive->open(QIODevice::ReadOnly);
-        addPage(QString("image://%1/%2").arg(d->imageProvider->prefix()).arg(archiveFileName), archiveFileName.split("/").last());
-        d->fileEntries << archiveFileName;
-        d->fileEntries.sort();
-        Q_EMIT fileEntriesChanged();
-        saveBook();
+void ArchiveBookModel::addPagesFromFiles(const QStringList& fileUrls, int insertAfter)
+{
+    if(!d->archive || !d->readWrite || fileUrls.isEmpty())
+    {
+        return;
+    }
+    // Checking whether each file is an image we can read means reading its header, which for a
+    // folder full of scans is a lot of waiting on the disk, so do that on the thread pool
+    struct PageImport {
+        QStringList fileUrls;
+        QVector<bool> readable;
+        int remaining{0};
+        int insertAfter{-1};
+        int generation{0};
+    };
+    QSharedPointer<PageImport> batch(new PageImport);
+    batch->fileUrls = fileUrls;
+    batch->readable.resize(fileUrls.count());
+    batch->remaining = fileUrls.count();
+    batch->insertAfter = insertAfter;
+    batch->generation = d->importGeneration;
+    setProcessingDescription(i18np("Checking the new page", "Checking %1 new pages", fileUrls.count()));
+    setProcessing(true);
+    for (int i = 0; i < fileUrls.count(); ++i) {
+        const QString fileUrl = fileUrls.at(i);
+        QThreadPool::globalInstance()->start([model = QPointer<ArchiveBookModel>(this), batch, i, fileUrl](){
+            QImageReader reader(fileUrl);
+            const bool readable = reader.canRead();
+            if (!readable) {
+                qCWarning(QTQUICK_LOG) << "Not adding" << fileUrl << "as a page, as it is not an image we are able to read:" << reader.errorString();
+            }
+            // The model may be gone by the time we are done, so it is checked back on its own thread
+            QMetaObject::invokeMethod(QCoreApplication::instance(), [model, batch, i, readable](){
+                batch->readable[i] = readable;
+                if (--batch->remaining > 0 || !model || batch->generation != model->d->importGeneration) {
+                    return;
+                }
+                // Once they have all been checked, the pages go in in the order they were given
+                int stagedPages{0};
+                for (int page = 0; page < batch->fileUrls.count(); ++page) {
+                    if (batch->readable.at(page)) {
+                        model->d->stagePageFile(batch->fileUrls.at(page), batch->insertAfter < 0 ? batch->insertAfter : batch->insertAfter + stagedPages);
+                        ++stagedPages;
+                    }
+                }
+                if (!model->d->saveJob) {
+                    model->setProcessing(false);
+                    // All the pages go into the archive in one go. If a save is already running, the
+                    // pages are picked up by another save once that is done.
+                    if (stagedPages > 0) {
+                        model->saveBook();
+                    }
+                }
+            }, Qt::QueuedConnection);
+        });
     }
 }
 
@@ -777,8 +958,6 @@ void ArchiveBookModel::swapPages(int swapThisIndex, int withThisIndex)
 
 QString ArchiveBookModel::createBook(QString folder, QString title, QString coverUrl)
 {
-    bool success = true;
-
     QString fileTitle = title.replace( QRegExp("\\W"),QString("")).simplified();
     QString filename = QString("%1/%2.cbz").arg(folder).arg(fileTitle);
     int i = 1;
@@ -787,7 +966,7 @@ QString ArchiveBookModel::createBook(QString folder, QString title, QString cove
         filename = QString("%1/%2 (%3).cbz").arg(folder).arg(fileTitle).arg(QString::number(i++));
     }
 
-    ArchiveBookModel* model = new ArchiveBookModel(nullptr);
+    ArchiveBookModel* model = new ArchiveBookModel(this);
     model->setQmlEngine(qmlEngine());
     model->setReadWrite(true);
     QString prefix = QString("archivebookpage%1").arg(QString::number(Private::counter()));
@@ -800,26 +979,44 @@ QString ArchiveBookModel::createBook(QString folder, QString title, QString cove
     AdvancedComicBookFormat::Document* acbfDocument = qobject_cast<AdvancedComicBookFormat::Document*>(model->acbfData());
     QString coverArchiveName = QString("cover.%1").arg(QFileInfo(coverUrl).completeSuffix());
     acbfDocument->metaData()->bookInfo()->coverpage()->setImageHref(coverArchiveName);
-    success = model->saveBook();
-
-    model->d->archive->close();
-    model->d->archive->open(QIODevice::ReadWrite);
-    model->d->archive->addLocalFile(coverUrl, coverArchiveName);
-    model->d->fileEntries << coverArchiveName;
-    model->d->fileEntries.sort();
-    Q_EMIT model->fileEntriesChanged();
-    model->d->archive->close();
-
-    model->deleteLater();
-
-    if(!success)
+    {
+        QMutexLocker locker(&model->archiveMutex);
+        model->d->filesToAdd << qMakePair(coverArchiveName, coverUrl);
+    }
+    ArchiveSaveJob* job = model->d->createSaveJob();
+    if (!job) {
+        model->deleteLater();
         return QLatin1String("");
+    }
+    // Nothing is showing the new book's model, so we tell whoever asked for the book through our own
+    setProcessingDescription(i18n("Creating %1", filename));
+    setProcessing(true);
+    connect(model, &ArchiveBookModel::saveCompleted, this, [this, model](bool success){
+        model->deleteLater();
+        setProcessing(false);
+        Q_EMIT saveCompleted(success);
+    });
+    job->start();
     return filename;
 }
 
+QString ArchiveBookModel::stagedFile(const QString& filePath) const
+{
+    for (const auto& file : qAsConst(d->filesToAdd)) {
+        if (file.first == filePath) {
+            return file.second;
+        }
+    }
+    return QString();
+}
+
 const KArchiveFile * ArchiveBookModel::archiveFile(const QString& filePath) const
 {
-    if(d->archive->isOpen() == false){
+    if(d->archive && d->archive->isOpen() == false){
+        if (d->archiveLocked) {
+            qCWarning(QTQUICK_LOG) << "Not reopening" << filename() << "while it is being saved";
+            return nullptr;
+        }
         d->archive->open(QIODevice::ReadOnly);
     }
     if(d->archive)
@@ -832,595 +1029,161 @@ const KArchiveFile * ArchiveBookModel::archiveFile(const QString& filePath) cons
     return nullptr;
 }
 
-bool ArchiveBookModel::loadComicInfoXML(QString xmlDocument, QObject *acbfData, QStringList entries, QString filename)
-{
-    KFileMetaData::UserMetaData filedata(filename);
-    AdvancedComicBookFormat::Document* acbfDocument = qobject_cast<AdvancedComicBookFormat::Document*>(acbfData);
-    QXmlStreamReader xmlReader(xmlDocument);
-    if(xmlReader.readNextStartElement())
+namespace {
+    // Put everything ComicInfo.xml and CoMet documents have in common into the ACBF document
+    void applyComicMetadata(const ComicMetadata& metadata, AdvancedComicBookFormat::Document* acbfDocument)
     {
-        if(xmlReader.name() == QStringLiteral("ComicInfo"))
-        {
-            // We'll need to collect several items to generate a series. Thankfully, comicinfo only has two types of series.
-            QString series;
-            int number = -1;
-            int volume = 0;
-
-            QString seriesAlt;
-            int numberAlt = -1;
-            int volumeAlt = 0;
-
-            // Also publishing date.
-            int year = 0;
-            int month = 0;
-            int day = 0;
-
-            QStringList publisher;
-            QStringList keywords;
-            QStringList empty;
-
-            while(xmlReader.readNextStartElement())
-            {
-                if(xmlReader.name() == QStringLiteral("Title"))
-                {
-                    acbfDocument->metaData()->bookInfo()->setTitle(xmlReader.readElementText(),"");
-                }
-
-                //Summary/annotation.
-                else if(xmlReader.name() == QStringLiteral("Summary"))
-                {
-                    acbfDocument->metaData()->bookInfo()->setAnnotation(xmlReader.readElementText().split("\n\n"), "");
-                }
-
-                /*
-                 * This ought to go into the kfile metadata.
-                 */
-                else if(xmlReader.name() == QStringLiteral("Notes"))
-                {
-                    if (filedata.userComment().isEmpty()) {
-                        filedata.setUserComment(xmlReader.readElementText());
-                    } else {
-                        xmlReader.skipCurrentElement();
-                    }
-                }
-                else if(xmlReader.name() == QStringLiteral("Tags"))
-                {
-                    QStringList tags = filedata.tags();
-                    QStringList newTags = xmlReader.readElementText().split(",");
-                    for (int i=0; i < newTags.size(); i++) {
-                        if (!tags.contains(newTags.at(i))) {
-                            tags.append(newTags.at(i));
-                        }
-                    }
-                    filedata.setTags(tags);
-                }
-                else if(xmlReader.name() == QStringLiteral("PageCount"))
-                {
-                    filedata.setAttribute("Peruse.totalPages", xmlReader.readElementText());
-                }
-                else if(xmlReader.name() == QStringLiteral("ScanInformation"))
-                {
-                    QString userComment = filedata.userComment();
-                    userComment.append("\n"+xmlReader.readElementText());
-                    filedata.setUserComment(userComment);
-                }
-
-                //Series
-
-                else if(xmlReader.name() == QStringLiteral("Series"))
-                {
-                    series = xmlReader.readElementText();
-                }
-                else if(xmlReader.name() == QStringLiteral("Number"))
-                {
-                    number = xmlReader.readElementText().toInt();
-                }
-                else if(xmlReader.name() == QStringLiteral("Volume"))
-                {
-                    volume = xmlReader.readElementText().toInt();
-                }
-
-                // Series alt
-
-                else if(xmlReader.name() == QStringLiteral("AlternateSeries"))
-                {
-                    seriesAlt = xmlReader.readElementText();
-                }
-                else if(xmlReader.name() == QStringLiteral("AlternateNumber"))
-                {
-                    numberAlt = xmlReader.readElementText().toInt();
-                }
-                else if(xmlReader.name() == QStringLiteral("AlternateVolume"))
-                {
-                    volumeAlt = xmlReader.readElementText().toInt();
-                }
-
-                // Publishing date.
-
-                else if(xmlReader.name() == QStringLiteral("Year"))
-                {
-                    year = xmlReader.readElementText().toInt();
-                }
-                else if(xmlReader.name() == QStringLiteral("Month"))
-                {
-                    month = xmlReader.readElementText().toInt();
-                }
-                else if(xmlReader.name() == QStringLiteral("Day"))
-                {
-                    day = xmlReader.readElementText().toInt();
-                }
-
-                //Publisher
-
-                else if(xmlReader.name() == QStringLiteral("Publisher"))
-                {
-                    publisher.append(xmlReader.readElementText());
-                }
-                else if(xmlReader.name() == QStringLiteral("Imprint"))
-                {
-                    publisher.append(xmlReader.readElementText());
-                }
-
-                //Genre
-                else if(xmlReader.name() == QStringLiteral("Genre"))
-                {
-                    QString key = xmlReader.readElementText();
-                    QString genreKey = key.toLower().replace(" ", "_");
-                    if (acbfDocument->metaData()->bookInfo()->availableGenres().contains(genreKey)) {
-                        acbfDocument->metaData()->bookInfo()->setGenre(genreKey);
-                    } else {
-                        //There must always be a genre in a proper acbf file...
-                        acbfDocument->metaData()->bookInfo()->setGenre("other");
-                        keywords.append(key);
-                    }
-                }
-
-                //Language
-
-                else if(xmlReader.name() == QStringLiteral("LanguageISO"))
-                {
-                    acbfDocument->metaData()->bookInfo()->addLanguage(xmlReader.readElementText());
-                }
-
-                //Sources/Weblink
-                else if(xmlReader.name() == QStringLiteral("Web"))
-                {
-                    acbfDocument->metaData()->documentInfo()->setSource(QStringList(xmlReader.readElementText()));
-                }
-
-                //One short, trade, etc.
-                else if(xmlReader.name() == QStringLiteral("Format"))
-                {
-                    keywords.append(xmlReader.readElementText());
-                }
-
-                //Is this a manga?
-                else if(xmlReader.name() == QStringLiteral("Manga"))
-                {
-                    if (xmlReader.readElementText() == "Yes") {
-                        acbfDocument->metaData()->bookInfo()->setGenre("manga");
-                        acbfDocument->metaData()->bookInfo()->setRightToLeft(true);
-                    }
-                }
-                //Content rating...
-                else if(xmlReader.name() == QStringLiteral("AgeRating"))
-                {
-                    acbfDocument->metaData()->bookInfo()->addContentRating(xmlReader.readElementText());
-                }
-
-                //Authors...
-                else if(xmlReader.name() == QStringLiteral("Writer"))
-                {
-                    QStringList people = xmlReader.readElementText().split(",", Qt::SkipEmptyParts);
-                    for (int i=0; i < people.size(); i++) {
-                        acbfDocument->metaData()->bookInfo()->addAuthor("Writer", "", "", "", "", people.at(i).trimmed(), empty, empty);
-                    }
-                }
-                else if(xmlReader.name() == QStringLiteral("Plotter"))
-                {
-                    QStringList people = xmlReader.readElementText().split(",", Qt::SkipEmptyParts);
-                    for (int i=0; i < people.size(); i++) {
-                        acbfDocument->metaData()->bookInfo()->addAuthor("Writer", "", "", "", "", people.at(i).trimmed(), empty, empty);
-                    }
-                }
-                else if(xmlReader.name() == QStringLiteral("Scripter"))
-                {
-                    QStringList people = xmlReader.readElementText().split(",", Qt::SkipEmptyParts);
-                    for (int i=0; i < people.size(); i++) {
-                        acbfDocument->metaData()->bookInfo()->addAuthor("Writer", "", "", "", "", people.at(i).trimmed(), empty, empty);
-                    }
-                }
-                else if(xmlReader.name() == QStringLiteral("Penciller"))
-                {
-                    QStringList people = xmlReader.readElementText().split(",", Qt::SkipEmptyParts);
-                    for (int i=0; i < people.size(); i++) {
-                        acbfDocument->metaData()->bookInfo()->addAuthor("Penciller", "", "", "", "", people.at(i).trimmed(), empty, empty);
-                    }
-                }
-                else if(xmlReader.name() == QStringLiteral("Inker"))
-                {
-                    QStringList people = xmlReader.readElementText().split(",", Qt::SkipEmptyParts);
-                    for (int i=0; i < people.size(); i++) {
-                        acbfDocument->metaData()->bookInfo()->addAuthor("Inker", "", "", "", "", people.at(i).trimmed(), empty, empty);
-                    }
-                }
-                else if(xmlReader.name() == QStringLiteral("Colorist"))
-                {
-                    QStringList people = xmlReader.readElementText().split(",", Qt::SkipEmptyParts);
-                    for (int i=0; i < people.size(); i++) {
-                        acbfDocument->metaData()->bookInfo()->addAuthor("Colorist", "", "", "", "", people.at(i).trimmed(), empty, empty);
-                    }
-                }
-                else if(xmlReader.name() == QStringLiteral("CoverArtist"))
-                {
-                    QStringList people = xmlReader.readElementText().split(",", Qt::SkipEmptyParts);
-                    for (int i=0; i < people.size(); i++) {
-                        acbfDocument->metaData()->bookInfo()->addAuthor("CoverArtist", "", "", "", "", people.at(i).trimmed(), empty, empty);
-                    }
-                }
-                else if(xmlReader.name() == QStringLiteral("Letterer"))
-                {
-                    QStringList people = xmlReader.readElementText().split(",", Qt::SkipEmptyParts);
-                    for (int i=0; i < people.size(); i++) {
-                        acbfDocument->metaData()->bookInfo()->addAuthor("Letterer", "", "", "", "", people.at(i).trimmed(), empty, empty);
-                    }
-                }
-                else if(xmlReader.name() == QStringLiteral("Editor"))
-                {
-                    QStringList people = xmlReader.readElementText().split(",", Qt::SkipEmptyParts);
-                    for (int i=0; i < people.size(); i++) {
-                        acbfDocument->metaData()->bookInfo()->addAuthor("Editor", "", "", "", "", people.at(i).trimmed(), empty, empty);
-                    }
-                }
-                else if(xmlReader.name() == QStringLiteral("Other"))
-                {
-                    QStringList people = xmlReader.readElementText().split(",", Qt::SkipEmptyParts);
-                    for (int i=0; i < people.size(); i++) {
-                        acbfDocument->metaData()->bookInfo()->addAuthor("Other", "", "", "", "", people.at(i).trimmed(), empty, empty);
-                    }
-                }
-                //Characters...
-                else if(xmlReader.name() == QStringLiteral("Characters"))
-                {
-                    QStringList people = xmlReader.readElementText().split(",", Qt::SkipEmptyParts);
-                    for (int i=0; i < people.size(); i++) {
-                        acbfDocument->metaData()->bookInfo()->addCharacter(people.at(i).trimmed());
-                    }
-                }
-                //Throw the rest into the keywords.
-                else if(xmlReader.name() == QStringLiteral("Teams"))
-                {
-                    QStringList teams = xmlReader.readElementText().split(",", Qt::SkipEmptyParts);
-                    for (int i=0; i < teams.size(); i++) {
-                        keywords.append(teams.at(i).trimmed());
-                    }
-                }
-                else if(xmlReader.name() == QStringLiteral("Locations"))
-                {
-                    QStringList locations = xmlReader.readElementText().split(",", Qt::SkipEmptyParts);
-                    for (int i=0; i < locations.size(); i++) {
-                        keywords.append(locations.at(i).trimmed());
-                    }
-                }
-                else if(xmlReader.name() == QStringLiteral("StoryArc"))
-                {
-                    QStringList arc = xmlReader.readElementText().split(",", Qt::SkipEmptyParts);
-                    for (int i=0; i < arc.size(); i++) {
-                        keywords.append(arc.at(i).trimmed());
-                    }
-                }
-                else if(xmlReader.name() == QStringLiteral("SeriesGroup"))
-                {
-                    QStringList group = xmlReader.readElementText().split(",", Qt::SkipEmptyParts);
-                    for (int i=0; i < group.size(); i++) {
-                        keywords.append(group.at(i).trimmed());
-                    }
-                }
-
-                //Pages...
-                else if(xmlReader.name() == QStringLiteral("Pages")) {
-                    while(xmlReader.readNextStartElement()) {
-                        if(xmlReader.name() == QStringLiteral("Page"))
-                        {
-                            int index = xmlReader.attributes().value(QStringLiteral("Image")).toInt();
-                            QString type = xmlReader.attributes().value(QStringLiteral("Type")).toString();
-                            QString bookmark = xmlReader.attributes().value(QStringLiteral("Bookmark")).toString();
-                            AdvancedComicBookFormat::Page* page = new AdvancedComicBookFormat::Page(acbfDocument);
-                            page->setImageHref(entries.at(index));
-                            if (type ==  QStringLiteral("FrontCover")) {
-                                acbfDocument->metaData()->bookInfo()->setCoverpage(page);
-                            } else {
-                                if (bookmark.isEmpty()) {
-                                    page->setTitle(type.append(QString::number(index)));
-                                } else {
-                                    page->setTitle(bookmark);
-                                }
-                                acbfDocument->body()->addPage(page, index-1);
-                            }
-                            xmlReader.readNext();
-                        }
-                    }
-                }
-
-                else
-                {
-                    qCWarning(QTQUICK_LOG) << Q_FUNC_INFO << "currently unsupported subsection:" << xmlReader.name();
-                    xmlReader.skipCurrentElement();
-                }
-            }
-
-            if (!series.isEmpty() && number>-1) {
-                acbfDocument->metaData()->bookInfo()->addSequence(number, series, volume);
-            }
-            if (!seriesAlt.isEmpty() && numberAlt>-1) {
-                acbfDocument->metaData()->bookInfo()->addSequence(numberAlt, seriesAlt, volumeAlt);
-            }
-
-            if (year > 0 || month > 0 || day > 0) {
-                //acbfDocument->metaData()->publishInfo()->setPublishDateFromInts(year, month, day);
-            }
+        AdvancedComicBookFormat::BookInfo* bookInfo = acbfDocument->metaData()->bookInfo();
+        AdvancedComicBookFormat::PublishInfo* publishInfo = acbfDocument->metaData()->publishInfo();
+        const QStringList empty;
+        bookInfo->setTitle(metadata.title, "");
+        bookInfo->setAnnotation(metadata.annotation, "");
+        for (const ComicMetadata::Sequence& sequence : metadata.sequences) {
+            bookInfo->addSequence(sequence.number, sequence.title, sequence.volume);
+        }
+        for (const QString& genre : metadata.genres) {
+            bookInfo->setGenre(genre);
+        }
+        for (const ComicMetadata::Author& author : metadata.authors) {
+            bookInfo->addAuthor(author.activity, "", "", "", "", author.name, empty, empty);
+        }
+        for (const QString& character : metadata.characters) {
+            bookInfo->addCharacter(character);
+        }
+        for (const QString& language : metadata.languages) {
+            bookInfo->addLanguage(language);
+        }
+        for (const QString& rating : metadata.contentRatings) {
+            bookInfo->addContentRating(rating);
+        }
+        if (metadata.rightToLeft) {
+            bookInfo->setRightToLeft(true);
+        }
+        if (!metadata.source.isEmpty()) {
+            acbfDocument->metaData()->documentInfo()->setSource(QStringList(metadata.source));
+        }
+        if (!metadata.publisher.isEmpty()) {
+            publishInfo->setPublisher(metadata.publisher);
+        }
+        if (metadata.publishDate.isValid()) {
+            publishInfo->setPublishDate(metadata.publishDate);
+        }
+        if (!metadata.license.isEmpty()) {
+            publishInfo->setLicense(metadata.license);
+        }
+        if (!metadata.isbn.isEmpty()) {
+            publishInfo->setIsbn(metadata.isbn);
+        }
+        if (!metadata.keywords.isEmpty()) {
+            bookInfo->setKeywords(metadata.keywords, "");
+        }
 
-            if (publisher.size()>0) {
-                acbfDocument->metaData()->publishInfo()->setPublisher(publisher.join(", "));
-            }
+        if (bookInfo->languages().size() > 0) {
+            QString lang = bookInfo->languageEntryList().at(0);
+            bookInfo->setTitle(bookInfo->title(""), lang);
+            bookInfo->setAnnotation(bookInfo->annotation(""), lang);
+            bookInfo->setKeywords(bookInfo->keywords(""), lang);
+        }
+    }
+}
 
-            if (keywords.size()>0) {
-                acbfDocument->metaData()->bookInfo()->setKeywords(keywords, "");
+bool ArchiveBookModel::loadComicInfoXML(QByteArray xmlDocument, QObject *acbfData, QStringList entries, QString filename)
+{
+    KFileMetaData::UserMetaData filedata(filename);
+    AdvancedComicBookFormat::Document* acbfDocument = qobject_cast<AdvancedComicBookFormat::Document*>(acbfData);
+    QBuffer buffer(&xmlDocument);
+    buffer.open(QIODevice::ReadOnly);
+    ComicMetadata metadata;
+    const bool success = metadata.readComicInfo(&buffer, filename);
+    applyComicMetadata(metadata, acbfDocument);
+
+    // This ought to go into the kfile metadata.
+    if (!metadata.notes.isEmpty() && filedata.userComment().isEmpty()) {
+        filedata.setUserComment(metadata.notes);
+    }
+    if (!metadata.tags.isEmpty()) {
+        QStringList tags = filedata.tags();
+        for (const QString& tag : metadata.tags) {
+            if (!tags.contains(tag)) {
+                tags.append(tag);
             }
+        }
+        filedata.setTags(tags);
+    }
+    if (!metadata.pageCount.isEmpty()) {
+        filedata.setAttribute("Peruse.totalPages", metadata.pageCount);
+    }
+    if (!metadata.scanInformation.isEmpty()) {
+        QString userComment = filedata.userComment();
+        userComment.append("\n" + metadata.scanInformation);
+        filedata.setUserComment(userComment);
+    }
 
-            if (acbfDocument->metaData()->bookInfo()->languages().size()>0) {
-                QString lang = acbfDocument->metaData()->bookInfo()->languageEntryList().at(0);
-                acbfDocument->metaData()->bookInfo()->setTitle(acbfDocument->metaData()->bookInfo()->title(""), lang);
-                acbfDocument->metaData()->bookInfo()->setAnnotation(acbfDocument->metaData()->bookInfo()->annotation(""), lang);
-                acbfDocument->metaData()->bookInfo()->setKeywords(acbfDocument->metaData()->bookInfo()->keywords(""), lang);
+    for (const ComicMetadata::Page& pageInfo : qAsConst(metadata.pages)) {
+        if (pageInfo.image < 0 || pageInfo.image >= entries.count()) {
+            qCWarning(QTQUICK_LOG) << Q_FUNC_INFO << "Skipping page for image" << pageInfo.image << "which is not in the archive";
+            continue;
+        }
+        AdvancedComicBookFormat::Page* page = new AdvancedComicBookFormat::Page(acbfDocument);
+        page->setImageHref(entries.at(pageInfo.image));
+        if (pageInfo.type == QStringLiteral("FrontCover")) {
+            acbfDocument->metaData()->bookInfo()->setCoverpage(page);
+        } else {
+            if (pageInfo.bookmark.isEmpty()) {
+                page->setTitle(pageInfo.type + QString::number(pageInfo.image));
+            } else {
+                page->setTitle(pageInfo.bookmark);
             }
+            acbfDocument->body()->addPage(page, pageInfo.image - 1);
         }
     }
 
-    if (xmlReader.hasError()) {
-        qCWarning(QTQUICK_LOG) << Q_FUNC_INFO << "Failed to read Comic Info XML document at token" << xmlReader.name() << "(" << xmlReader.lineNumber() << ":" << xmlReader.columnNumber() << ") The reported error was:" << xmlReader.errorString();
-    }
     qCDebug(QTQUICK_LOG) << Q_FUNC_INFO << "Completed ACBF document creation from ComicInfo.xml for" << acbfDocument->metaData()->bookInfo()->title();
-    acbfData = acbfDocument;
-    return !xmlReader.hasError();
+    return success;
 }
 
 bool ArchiveBookModel::loadCoMet(QStringList xmlDocuments, QObject *acbfData, QStringList entries, QString filename)
 {
     KFileMetaData::UserMetaData filedata(filename);
     AdvancedComicBookFormat::Document* acbfDocument = qobject_cast<AdvancedComicBookFormat::Document*>(acbfData);
+    // This is called while loading the archive, which means archiveMutex is already held
     for(const QString& xmlDocument : qAsConst(xmlDocuments)) {
-        QMutexLocker locker(&archiveMutex);
         const KArchiveFile* archFile = d->archive->directory()->file(xmlDocument);
-        QXmlStreamReader xmlReader(archFile->data());
-        if(xmlReader.readNextStartElement())
-        {
-            if(xmlReader.name() == QStringLiteral("comet"))
-            {
-                // We'll need to collect several items to generate a series. Thankfully, comicinfo only has two types of series.
-                QString series;
-                int number = -1;
-                int volume = 0;
-
-                QStringList keywords;
-                QStringList empty;
-
-                while(xmlReader.readNextStartElement())
-                {
-                    if(xmlReader.name() == QStringLiteral("title"))
-                    {
-                        acbfDocument->metaData()->bookInfo()->setTitle(xmlReader.readElementText(),"");
-                    }
-
-                    //Summary/annotation.
-                    else if(xmlReader.name() == QStringLiteral("description"))
-                    {
-                        acbfDocument->metaData()->bookInfo()->setAnnotation(xmlReader.readElementText().split("\n\n"), "");
-                    }
-
-                    /*
-                     * This ought to go into the kfile metadata.
-                     */
-                    //pages
-                    else if(xmlReader.name() == QStringLiteral("pages"))
-                    {
-                        filedata.setAttribute("Peruse.totalPages", xmlReader.readElementText());
-                    }
-                    //curentpage -- only read this when there's no such entry.
-                    else if(xmlReader.name() == QStringLiteral("lastMark"))
-                    {
-                        if (!filedata.hasAttribute("Peruse.currentPage")) {
-                            filedata.setAttribute("Peruse.currentPage", xmlReader.readElementText());
-                        } else {
-                            xmlReader.skipCurrentElement();
-                        }
-                    }
-
-                    //Series
-
-                    else if(xmlReader.name() == QStringLiteral("series"))
-                    {
-                        series = xmlReader.readElementText();
-                    }
-                    else if(xmlReader.name() == QStringLiteral("issue"))
-                    {
-                        number = xmlReader.readElementText().toInt();
-                    }
-                    else if(xmlReader.name() == QStringLiteral("volume"))
-                    {
-                        volume = xmlReader.readElementText().toInt();
-                    }
-
-                    // Publishing date.
-
-                    else if(xmlReader.name() == QStringLiteral("date"))
-                    {
-                        acbfDocument->metaData()->publishInfo()->setPublishDate(QDate::fromString(xmlReader.readElementText(), Qt::ISODate));
-                    }
-
-                    //Publisher
-
-                    else if(xmlReader.name() == QStringLiteral("publisher"))
-                    {
-                        acbfDocument->metaData()->publishInfo()->setPublisher(xmlReader.readElementText());
-                    }
-                    else if(xmlReader.name() == QStringLiteral("rights"))
-                    {
-                        acbfDocument->metaData()->publishInfo()->setLicense(xmlReader.readElementText());
-                    }
-                    else if(xmlReader.name() == QStringLiteral("identifier"))
-                    {
-                        acbfDocument->metaData()->publishInfo()->setIsbn(xmlReader.readElementText());
-                    }
-
-                    //Genre
-                    else if(xmlReader.name() == QStringLiteral("genre"))
-                    {
-                        QString key = xmlReader.readElementText();
-                        QString genreKey = key.toLower().replace(" ", "_");
-                        if (acbfDocument->metaData()->bookInfo()->availableGenres().contains(genreKey)) {
-                            acbfDocument->metaData()->bookInfo()->setGenre(genreKey);
-                        } else {
-                            keywords.append(key);
-                        }
-                    }
-
-                    //Language
-
-                    else if(xmlReader.name() == QStringLiteral("language"))
-                    {
-                        acbfDocument->metaData()->bookInfo()->addLanguage(xmlReader.readElementText());
-                    }
-
-                    //Sources/Weblink
-                    else if(xmlReader.name() == QStringLiteral("isVersionOf"))
-                    {
-                        acbfDocument->metaData()->documentInfo()->setSource(QStringList(xmlReader.readElementText()));
-                    }
-
-                    //One short, trade, etc.
-                    else if(xmlReader.name() == QStringLiteral("format"))
-                    {
-                        keywords.append(xmlReader.readElementText());
-                    }
-
-                    //Is this a manga?
-                    else if(xmlReader.name() == QStringLiteral("readingDirection"))
-                    {
-                        if (xmlReader.readElementText() == "rtl") {
-                            acbfDocument->metaData()->bookInfo()->setRightToLeft(true);
-                        }
-                    }
-                    //Content rating...
-                    else if(xmlReader.name() == QStringLiteral("rating"))
-                    {
-                        acbfDocument->metaData()->bookInfo()->addContentRating(xmlReader.readElementText());
-                    }
-
-                    //Authors...
-                    else if(xmlReader.name() == QStringLiteral("writer"))
-                    {
-                        QString person = xmlReader.readElementText();
-                        acbfDocument->metaData()->bookInfo()->addAuthor("Writer", "", "", "", "", person, empty, empty);
-                    }
-                    else if(xmlReader.name() == QStringLiteral("creator"))
-                    {
-                        QString person = xmlReader.readElementText();
-                        acbfDocument->metaData()->bookInfo()->addAuthor("Writer", "", "", "", "", person, empty, empty);
-                    }
-                    else if(xmlReader.name() == QStringLiteral("penciller"))
-                    {
-                        QString person = xmlReader.readElementText();
-                        acbfDocument->metaData()->bookInfo()->addAuthor("Penciller", "", "", "", "", person, empty, empty);
-                    }
-                    else if(xmlReader.name() == QStringLiteral("editor"))
-                    {
-                        QString person = xmlReader.readElementText();
-                        acbfDocument->metaData()->bookInfo()->addAuthor("Editor", "", "", "", "", person, empty, empty);
-                    }
-                    else if(xmlReader.name() == QStringLiteral("coverDesigner"))
-                    {
-                        QString person = xmlReader.readElementText();
-                        acbfDocument->metaData()->bookInfo()->addAuthor("CoverArtist", "", "", "", "", person, empty, empty);
-                    }
-                    else if(xmlReader.name() == QStringLiteral("letterer"))
-                    {
-                        QString person = xmlReader.readElementText();
-                        acbfDocument->metaData()->bookInfo()->addAuthor("Letterer", "", "", "", "", person, empty, empty);
-                    }
-                    else if(xmlReader.name() == QStringLiteral("inker"))
-                    {
-                        QString person = xmlReader.readElementText();
-                        acbfDocument->metaData()->bookInfo()->addAuthor("Inker", "", "", "", "", person, empty, empty);
-                    }
-                    else if(xmlReader.name() == QStringLiteral("colorist"))
-                    {
-                        QString person = xmlReader.readElementText();
-                        acbfDocument->metaData()->bookInfo()->addAuthor("Colorist", "", "", "", "", person, empty, empty);
-                    }
-
-                    //Characters
-                    else if(xmlReader.name() == QStringLiteral("character"))
-                    {
-                        QString person = xmlReader.readElementText();
-                        acbfDocument->metaData()->bookInfo()->addCharacter(person);
-                    }
-
-
-                    //Get the cover image, set it, remove it from entries, then remove all other entries.
-                    else if(xmlReader.name() == QStringLiteral("coverImage"))
-                    {
-                        QString url = xmlReader.readElementText();
-                        AdvancedComicBookFormat::Page* cover = new AdvancedComicBookFormat::Page(acbfDocument);
-                        cover->setImageHref(url);
-                        acbfDocument->metaData()->bookInfo()->setCoverpage(cover);
-                        entries.removeAll(url);
-                        for(const QString& entry : qAsConst(entries)) {
-                            AdvancedComicBookFormat::Page* page = new AdvancedComicBookFormat::Page(acbfDocument);
-                            page->setImageHref(entry);
-                            acbfDocument->body()->addPage(page);
-                        }
-                        xmlReader.readNext();
-                    }
-
-                    else
-                    {
-                        qCWarning(QTQUICK_LOG) << Q_FUNC_INFO << "currently unsupported subsection:" << xmlReader.name();
-                        xmlReader.skipCurrentElement();
-                    }
-                }
-
-                if (!series.isEmpty() && number>-1) {
-                    acbfDocument->metaData()->bookInfo()->addSequence(number, series, volume);
-                }
-
-                if (acbfDocument->metaData()->bookInfo()->genres().size()==0) {
-                    //There must always be a genre in a proper acbf file...
-                    acbfDocument->metaData()->bookInfo()->setGenre("other");
-                }
-
-                if (keywords.size()>0) {
-                    acbfDocument->metaData()->bookInfo()->setKeywords(keywords, "");
-                }
+        if (!archFile) {
+            continue;
+        }
+        QByteArray data = archFile->data();
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::ReadOnly);
+        ComicMetadata metadata;
+        // These are already known to be CoMet documents, so the first one we can find is used
+        const bool success = metadata.readCoMet(&buffer, xmlDocument);
+        applyComicMetadata(metadata, acbfDocument);
+
+        // This ought to go into the kfile metadata.
+        if (!metadata.pageCount.isEmpty()) {
+            filedata.setAttribute("Peruse.totalPages", metadata.pageCount);
+        }
+        // Only use the reading position when we don't already have one
+        if (!metadata.lastMark.isEmpty() && !filedata.hasAttribute("Peruse.currentPage")) {
+            filedata.setAttribute("Peruse.currentPage", metadata.lastMark);
+        }
 
-                if (acbfDocument->metaData()->bookInfo()->languages().size()>0) {
-                    QString lang = acbfDocument->metaData()->bookInfo()->languageEntryList().at(0);
-                    acbfDocument->metaData()->bookInfo()->setTitle(acbfDocument->metaData()->bookInfo()->title(""), lang);
-                    acbfDocument->metaData()->bookInfo()->setAnnotation(acbfDocument->metaData()->bookInfo()->annotation(""), lang);
-                    acbfDocument->metaData()->bookInfo()->setKeywords(acbfDocument->metaData()->bookInfo()->keywords(""), lang);
-                }
-            }
-            if (xmlReader.hasError()) {
-                qCWarning(QTQUICK_LOG) << Q_FUNC_INFO << "Failed to read CoMet document at token" << xmlReader.name()
-                           << "(" << xmlReader.lineNumber() << ":"
-                           << xmlReader.columnNumber() << ") The reported error was:" << xmlReader.errorString();
+        // Set the cover image, and then all the other images as pages
+        if (!metadata.coverImage.isEmpty()) {
+            AdvancedComicBookFormat::Page* cover = new AdvancedComicBookFormat::Page(acbfDocument);
+            cover->setImageHref(metadata.coverImage);
+            acbfDocument->metaData()->bookInfo()->setCoverpage(cover);
+            entries.removeAll(metadata.coverImage);
+            for(const QString& entry : qAsConst(entries)) {
+                AdvancedComicBookFormat::Page* page = new AdvancedComicBookFormat::Page(acbfDocument);
+                page->setImageHref(entry);
+                acbfDocument->body()->addPage(page);
             }
-            qCDebug(QTQUICK_LOG) << Q_FUNC_INFO << "Completed ACBF document creation from CoMet for" << acbfDocument->metaData()->bookInfo()->title();
-            acbfData = acbfDocument;
-            return !xmlReader.hasError();
-        } else {
-            xmlReader.skipCurrentElement();
         }
+
+        qCDebug(QTQUICK_LOG) << Q_FUNC_INFO << "Completed ACBF document creation from CoMet for" << acbfDocument->metaData()->bookInfo()->title();
+        return success;
     }
     return false;
 }
@@ -1477,6 +1240,7 @@ QString ArchiveBookModel::fontFamilyName(const QString& fontFileName)
                         break;
                     }
                 }
+                QMutexLocker locker(&archiveMutex);
                 auto file = archiveFile(foundEntry);
                 if (file) {
                     int id = QFontDatabase::addApplicationFontFromData(file->data());
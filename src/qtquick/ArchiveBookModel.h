@@ -42,6 +42,8 @@ class ArchiveBookModel : public BookModel
     Q_PROPERTY(bool hasUnsavedChanges READ hasUnsavedChanges NOTIFY hasUnsavedChangesChanged)
     Q_PROPERTY(QStringList fileEntries READ fileEntries NOTIFY fileEntriesChanged)
     Q_PROPERTY(QStringList fileEntriesToDelete READ fileEntriesToDelete NOTIFY fileEntriesToDeleteChanged)
+    Q_PROPERTY(int saveProgress READ saveProgress NOTIFY saveProgressChanged)
+    Q_PROPERTY(bool saving READ saving NOTIFY savingChanged)
 public:
     explicit ArchiveBookModel(QObject* parent = nullptr);
     ~ArchiveBookModel() override;
@@ -188,9 +190,42 @@ public:
 
     /**
      * \brief Saves the archive back to disk
-     * @return True if the save was successful
+     *
+     * The archive is written in the background (see ArchiveSaveJob), with processing set
+     * to true while that is happening. Once the new archive is on disk, the model switches
+     * over to reading from it, and saveCompleted() is emitted.
+     *
+     * @return True if saving was started (or there was nothing to save), false if a save
+     * is already in progress or the book has no archive
      */
     Q_INVOKABLE bool saveBook();
+    /**
+     * \brief Stop the save currently in progress, leaving the archive on disk as it was.
+     * Cancelling is asynchronous, and saveCompleted() will be emitted once it is done.
+     */
+    Q_INVOKABLE void cancelSave();
+    /**
+     * @return Whether a save is currently in progress (which, unlike processing, is only
+     * true while there is a save which can be cancelled)
+     */
+    bool saving() const;
+    /**
+     * Fired when a save is started or has finished
+     */
+    Q_SIGNAL void savingChanged();
+    /**
+     * @return How far along the current save is, in percent
+     */
+    int saveProgress() const;
+    /**
+     * Fired when the progress of the current save changes
+     */
+    Q_SIGNAL void saveProgressChanged();
+    /**
+     * Fired when a save has finished
+     * @param success Whether the archive was written successfully (false if cancelled)
+     */
+    Q_SIGNAL void saveCompleted(bool success);
 
     /**
      * \brief add a page to this book.
@@ -216,11 +251,26 @@ public:
      * passed to the function. Optionally this can be done at a specific
      * position in the book.
      *
+     * The page shows up in the model straight away, and is written into the
+     * archive by saving the book.
+     *
      * @param fileUrl     The URL of the file to copy into the archive
      * @param insertAfter The index to insert the new page after. If invalid, insertion will be at the end
      */
     Q_INVOKABLE void addPageFromFile(QString fileUrl, int insertAfter = -1);
 
+    /**
+     * Adds a number of new pages to the book archive on disk, by copying in
+     * the files passed to the function, in the order given. Files which are
+     * not images we can read are skipped. The files are checked in parallel,
+     * off the gui thread, after which the pages show up in the model, and are
+     * all written to the archive in a single save.
+     *
+     * @param fileUrls    The URLs of the files to copy into the archive
+     * @param insertAfter The index to insert the new pages after. If invalid, insertion will be at the end
+     */
+    Q_INVOKABLE void addPagesFromFiles(const QStringList& fileUrls, int insertAfter = -1);
+
     /**
      * @brief Swap the two pages at the specified indices
      *
@@ -235,10 +285,15 @@ public:
      * Creates a new book in the folder, with the given title and cover.
      * A filename will be constructed to fit the title, and which does not already exist in the
      * directory.
+     *
+     * The book is written in the background, with processing set to true while that is
+     * happening, and saveCompleted() is emitted on this model once it is done. The book
+     * should not be opened before then.
      * 
      * @param folder the path to the folder to create this book in.
      * @param title The title of the book.
      * @param coverUrl A resource location pointing at the image that will be the coverpage.
+     * @return The filename of the new book, or an empty string if it could not be created
      */
     Q_INVOKABLE QString createBook(QString folder, QString title, QString coverUrl);
 
@@ -269,8 +324,18 @@ public:
     Q_INVOKABLE QString firstAvailableFont(const QStringList& fontList);
 
     friend class ArchiveImageRunnable;
+    friend class TiledPageSourceRunnable;
 protected:
     const KArchiveFile* archiveFile(const QString& filePath) const;
+    /**
+     * Pages added from files are shown straight away, but only written into the archive
+     * on the next save. Until then, their images are read from the files they were added from.
+     * Call this with archiveMutex held.
+     * @param filePath The name the file will have in the archive
+     * @return The local file the entry will be written from, or an empty string if the entry
+     * is not waiting to be added to the archive
+     */
+    QString stagedFile(const QString& filePath) const;
     QMutex archiveMutex;
 
 private:
@@ -279,16 +344,18 @@ private:
      * @brief loadComicInfoXML
      * Loads ComicInfo.xml, this is an old file metadata type used by comicrack, and since then
      * written by other editors, amongst which a callibre plugin.
-     * @param xmlDocument string with the archive value.
+     * @param xmlDocument the contents of the ComicInfo.xml entry in the archive.
      * @param acbfData a pointer pointing to a acbfDocument.
      * @param entries a list of image entries, sorted.
      * @param filename the file name of the document, necessary for writing data to kfilemetadata.
      * @return whether the reading was successful.
      */
-    bool loadComicInfoXML(QString xmlDocument, QObject* acbfData, QStringList entries, QString filename);
+    bool loadComicInfoXML(QByteArray xmlDocument, QObject* acbfData, QStringList entries, QString filename);
     /**
      * @brief loads CoMet xmls, https://www.denvog.com/comet/comet-specification/
-     * @param xmlDocument string with the archive value.
+     * Call this with archiveMutex held, and only with documents already known to be
+     * CoMet documents (see ArchiveMetadataProbe::findCoMetEntry()).
+     * @param xmlDocuments the names of the CoMet documents in the archive.
      * @param acbfData a pointer pointing to a acbfDocument.
      * @param entries a list of image entries, sorted.
      * @param filename the file name of the document, necessary for writing data to kfilemetadata.
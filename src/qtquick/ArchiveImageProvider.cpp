@@ -21,15 +21,19 @@
 
 #include "ArchiveImageProvider.h"
 #include "ArchiveBookModel.h"
+#include "DecodeScheduler.h"
+#include "ImageTextureFactory.h"
+#include "PerformanceTimer.h"
+#include "SharedImageRequests.h"
 
 #include <karchive.h>
 #include <karchivefile.h>
 
 #include <QBuffer>
+#include <QFile>
 #include <QIcon>
 #include <QImageReader>
 #include <QPainter>
-#include <QThreadPool>
 
 #include <AcbfDocument.h>
 #include <AcbfBinary.h>
@@ -44,6 +48,7 @@ public:
 
     ArchiveBookModel* bookModel{nullptr};
     QString prefix;
+    SharedImageRequests requests;
 };
 
 ArchiveImageProvider::ArchiveImageProvider()
@@ -60,13 +65,24 @@ ArchiveImageProvider::~ArchiveImageProvider()
 class ArchiveImageResponse : public QQuickImageResponse
 {
     public:
-        ArchiveImageResponse(const QString &id, const QSize &requestedSize, ArchiveBookModel* bookModel, const QString& prefix)
+        ArchiveImageResponse(const QString &id, const QSize &requestedSize, ArchiveBookModel* bookModel, const QString& prefix, SharedImageRequests* requests)
+            : m_requests(requests)
+            , m_key(SharedImageRequests::key(id, requestedSize))
         {
-            m_runnable = new ArchiveImageRunnable(id, requestedSize, bookModel, prefix);
-            m_runnable->setAutoDelete(false);
-            connect(m_runnable, &ArchiveImageRunnable::done, this, &ArchiveImageResponse::handleDone, Qt::QueuedConnection);
-            connect(this, &QQuickImageResponse::finished, m_runnable, &QObject::deleteLater,  Qt::QueuedConnection);
-            QThreadPool::globalInstance()->start(m_runnable);
+            // If this image is already on its way to somebody else, just wait for that one
+            if (m_requests->attach(m_key, this, [this](QImage image){ handleDone(image); })) {
+                ArchiveImageRunnable* runnable = new ArchiveImageRunnable(id, requestedSize, bookModel, prefix);
+                const QString key = m_key;
+                connect(runnable, &ArchiveImageRunnable::done, runnable, [requests, key, runnable](QImage image){
+                    requests->finish(key, runnable, image);
+                }, Qt::DirectConnection);
+                m_requests->setWork(m_key, runnable, [runnable](){
+                    runnable->abort();
+                    DecodeScheduler::instance()->cancel(runnable);
+                });
+                // Keyed on the page's url, so the book model can bump the page being read to the front of the queue
+                DecodeScheduler::instance()->schedule(runnable, DecodeScheduler::NearbyPage, QString("image://%1/%2").arg(prefix).arg(id));
+            }
         }
 
         void handleDone(QImage image) {
@@ -76,21 +92,25 @@ class ArchiveImageResponse : public QQuickImageResponse
 
         QQuickTextureFactory *textureFactory() const override
         {
-            return QQuickTextureFactory::textureFactoryForImage(m_image);
+            return new ImageTextureFactory(m_image);
         }
 
         void cancel() override
         {
-            m_runnable->abort();
+            // If we were still waiting, nothing will finish the response for us
+            if (m_requests->detach(m_key, this)) {
+                Q_EMIT finished();
+            }
         }
 
-        ArchiveImageRunnable* m_runnable{nullptr};
+        SharedImageRequests* m_requests{nullptr};
+        QString m_key;
         QImage m_image;
 };
 
 QQuickImageResponse * ArchiveImageProvider::requestImageResponse(const QString& id, const QSize& requestedSize)
 {
-    ArchiveImageResponse* response = new ArchiveImageResponse(id, requestedSize, d->bookModel, d->prefix);
+    ArchiveImageResponse* response = new ArchiveImageResponse(id, requestedSize, d->bookModel, d->prefix, &d->requests);
     return response;
 }
 
@@ -132,6 +152,16 @@ public:
         b.setData(data);
         b.open(QIODevice::ReadOnly);
         QImageReader reader(&b, nullptr);
+        // Scale down to the requested size while decoding (which for some formats, like
+        // jpeg, is a lot quicker than decoding the whole thing), but never scale up
+        const QSize size = reader.size();
+        if (size.isValid() && (requestedSize.width() > 0 || requestedSize.height() > 0)) {
+            const QSize bounds(requestedSize.width() > 0 ? requestedSize.width() : size.width(),
+                               requestedSize.height() > 0 ? requestedSize.height() : size.height());
+            if (size.width() > bounds.width() || size.height() > bounds.height()) {
+                reader.setScaledSize(size.scaled(bounds, Qt::KeepAspectRatio));
+            }
+        }
         bool success = reader.read(image);
         if (success) {
             errorString.clear();
@@ -165,6 +195,7 @@ void ArchiveImageRunnable::abort()
 
 void ArchiveImageRunnable::run()//const QString& id, QSize* size, const QSize& requestedSize)
 {
+    PerformanceTimer timer("ArchiveImageRunnable::run");
     QImage img;
     bool success = false;
 
@@ -192,6 +223,12 @@ void ArchiveImageRunnable::run()//const QString& id, QSize* size, const QSize& r
 
         if(!d->isAborted() && entry) {
             success = d->loadImage(&img, entry->data());
+        } else if(!d->isAborted()) {
+            // Pages which have been added, but not saved yet, are read from the file they were added from
+            QFile file(d->bookModel->stagedFile(d->id));
+            if(!file.fileName().isEmpty() && file.open(QIODevice::ReadOnly)) {
+                success = d->loadImage(&img, file.readAll());
+            }
         }
     }
 
@@ -203,5 +240,6 @@ void ArchiveImageRunnable::run()//const QString& id, QSize* size, const QSize& r
         qCDebug(QTQUICK_LOG) << "Failed to load image with id:" << d->id << "and the error" << d->errorString;
     }
 
-    Q_EMIT done(img);
+    // Pages are quite often black and white, in which case they can be uploaded as greyscale
+    Q_EMIT done(ImageTextureFactory::prepareImage(img, true));
 }
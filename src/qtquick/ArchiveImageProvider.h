@@ -42,7 +42,8 @@ public:
      * \brief Request a given image.
      * 
      * @param id The url of the image to provide.
-     * @param requestedSize The required size of the final image, unused.
+     * @param requestedSize The required size of the final image. Larger images are scaled down
+     * to fit inside this (keeping their aspect ratio), smaller ones are left as they are.
      * 
      * @return an asynchronous image response
      */
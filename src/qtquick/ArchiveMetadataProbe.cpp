@@ -0,0 +1,552 @@
+/*
+ * Copyright (C) 2026 Dan Leinir Turthra Jensen <admin@leinir.dk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ArchiveMetadataProbe.h"
+
+#include "ComicMetadata.h"
+
+#include <KRar.h>
+#include <KZip>
+#include <karchivefile.h>
+
+#include <QBuffer>
+#include <QCache>
+#include <QDateTime>
+#include <QFileInfo>
+#include <QHash>
+#include <QMimeDatabase>
+#include <QMutex>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+#include <memory>
+
+#include <qtquick_debug.h>
+
+QStringList recursiveEntries(const KArchiveDirectory* dir);
+
+namespace {
+    // KRar cannot create devices for its entries, so for those we read the whole entry
+    std::unique_ptr<QIODevice> openEntry(const KArchiveFile* file)
+    {
+        std::unique_ptr<QIODevice> device(file->createDevice());
+        if(!device) {
+            QBuffer* buffer = new QBuffer();
+            buffer->setData(file->data());
+            device.reset(buffer);
+        }
+        if(!device->isOpen()) {
+            device->open(QIODevice::ReadOnly);
+        }
+        return device;
+    }
+
+    // The same language fallback BookInfo uses: the entry without a language if there is
+    // one, otherwise the entry for the first listed language, otherwise whichever is there
+    template<typename T>
+    T forDefaultLanguage(const QHash<QString, T>& values, const QString& firstLanguage)
+    {
+        if(values.isEmpty()) {
+            return T();
+        }
+        if(!values.value(QString()).isEmpty()) {
+            return values.value(QString());
+        }
+        if(!firstLanguage.isEmpty() && !values.value(firstLanguage).isEmpty()) {
+            return values.value(firstLanguage);
+        }
+        return values.constBegin().value();
+    }
+
+    // Read just enough of an xml document to find its root element. Anything which
+    // doesn't have one in the first few kilobytes is not a metadata document.
+    QString rootElementName(const KArchiveFile* file)
+    {
+        static const qint64 chunkSize{512};
+        static const qint64 maximumSize{4096};
+        std::unique_ptr<QIODevice> device(file->createDevice());
+        if(!device) {
+            // KRar can't stream its entries, but at least we only parse the start
+            QBuffer* buffer = new QBuffer();
+            buffer->setData(file->data().left(maximumSize));
+            device.reset(buffer);
+        }
+        if(!device->isOpen()) {
+            device->open(QIODevice::ReadOnly);
+        }
+        QXmlStreamReader xmlReader;
+        qint64 bytesRead{0};
+        while(bytesRead < maximumSize) {
+            const QByteArray chunk = device->read(chunkSize);
+            if(chunk.isEmpty()) {
+                break;
+            }
+            bytesRead += chunk.size();
+            xmlReader.addData(chunk);
+            while(!xmlReader.atEnd()) {
+                if(xmlReader.readNext() == QXmlStreamReader::StartElement) {
+                    return xmlReader.name().toString();
+                }
+            }
+            if(xmlReader.hasError() && xmlReader.error() != QXmlStreamReader::PrematureEndOfDocumentError) {
+                break;
+            }
+        }
+        return QString();
+    }
+
+    struct CoMetEntry {
+        QDateTime lastModified;
+        qint64 size{0};
+        QString entry;
+    };
+    QMutex coMetEntriesMutex;
+    QCache<QString, CoMetEntry> coMetEntries(1000);
+}
+
+class ArchiveMetadataProbe::Private
+{
+public:
+    Private(const QString& fileName, const QString& mimetype)
+        : fileName(fileName)
+        , mimetype(mimetype)
+    {}
+    QString fileName;
+    QString mimetype;
+
+    Format format{NoMetadata};
+    QString metadataEntry;
+
+    QString title;
+    QStringList authors;
+    QString publisher;
+    QList<Sequence> sequences;
+    QStringList genres;
+    QStringList characters;
+    QStringList keywords;
+    QStringList description;
+    int pageCount{0};
+
+    void clearMetadata() {
+        format = NoMetadata;
+        metadataEntry.clear();
+        title.clear();
+        authors.clear();
+        publisher.clear();
+        sequences.clear();
+        genres.clear();
+        characters.clear();
+        keywords.clear();
+        description.clear();
+        pageCount = 0;
+    }
+
+    void addGenre(const QString& genre) {
+        if(!genres.contains(genre)) {
+            genres.append(genre);
+        }
+    }
+
+    void readAcbfAuthor(QXmlStreamReader& xmlReader) {
+        QString firstName, middleName, lastName, nickName, homePage, email;
+        while(xmlReader.readNextStartElement()) {
+            if(xmlReader.name() == QStringLiteral("first-name")) {
+                firstName = xmlReader.readElementText(QXmlStreamReader::IncludeChildElements);
+            } else if(xmlReader.name() == QStringLiteral("middle-name")) {
+                middleName = xmlReader.readElementText(QXmlStreamReader::IncludeChildElements);
+            } else if(xmlReader.name() == QStringLiteral("last-name")) {
+                lastName = xmlReader.readElementText(QXmlStreamReader::IncludeChildElements);
+            } else if(xmlReader.name() == QStringLiteral("nickname")) {
+                nickName = xmlReader.readElementText(QXmlStreamReader::IncludeChildElements);
+            } else if(xmlReader.name() == QStringLiteral("home-page") && homePage.isEmpty()) {
+                homePage = xmlReader.readElementText(QXmlStreamReader::IncludeChildElements);
+            } else if(xmlReader.name() == QStringLiteral("email") && email.isEmpty()) {
+                email = xmlReader.readElementText(QXmlStreamReader::IncludeChildElements);
+            } else {
+                xmlReader.skipCurrentElement();
+            }
+        }
+        // Matches Author::displayName()
+        if(!nickName.isEmpty()) {
+            authors.append(nickName);
+        } else if(!firstName.isEmpty() || !middleName.isEmpty() || !lastName.isEmpty()) {
+            authors.append(QStringLiteral("%1 %2 %3").arg(firstName).arg(middleName).arg(lastName).simplified());
+        } else if(!email.isEmpty()) {
+            authors.append(email);
+        } else if(!homePage.isEmpty()) {
+            authors.append(homePage);
+        } else {
+            authors.append(QString());
+        }
+    }
+
+    // BookInfo keeps the raw markup of annotation paragraphs, which we can't cut out of
+    // the document when streaming it, so write it back out again instead
+    QString readAcbfParagraph(QXmlStreamReader& xmlReader) {
+        QString paragraph;
+        QXmlStreamWriter writer(&paragraph);
+        int depth = 0;
+        while(!xmlReader.atEnd()) {
+            xmlReader.readNext();
+            if(xmlReader.isEndElement()) {
+                if(depth == 0) {
+                    break;
+                }
+                --depth;
+            } else if(xmlReader.isStartElement()) {
+                ++depth;
+            }
+            writer.writeCurrentToken(xmlReader);
+        }
+        return paragraph;
+    }
+
+    void readAcbfBookInfo(QXmlStreamReader& xmlReader) {
+        QHash<QString, QString> titles;
+        QHash<QString, QStringList> annotations;
+        QHash<QString, QStringList> languageKeywords;
+        QString firstLanguage;
+        while(xmlReader.readNextStartElement()) {
+            if(xmlReader.name() == QStringLiteral("author")) {
+                readAcbfAuthor(xmlReader);
+            } else if(xmlReader.name() == QStringLiteral("book-title")) {
+                const QString language = xmlReader.attributes().value(QStringLiteral("lang")).toString();
+                titles[language] = xmlReader.readElementText(QXmlStreamReader::IncludeChildElements);
+            } else if(xmlReader.name() == QStringLiteral("genre")) {
+                addGenre(xmlReader.readElementText(QXmlStreamReader::IncludeChildElements));
+            } else if(xmlReader.name() == QStringLiteral("characters")) {
+                while(xmlReader.readNextStartElement()) {
+                    if(xmlReader.name() == QStringLiteral("name")) {
+                        characters.append(xmlReader.readElementText(QXmlStreamReader::IncludeChildElements));
+                    } else {
+                        xmlReader.skipCurrentElement();
+                    }
+                }
+            } else if(xmlReader.name() == QStringLiteral("annotation")) {
+                const QString language = xmlReader.attributes().value(QStringLiteral("lang")).toString();
+                QStringList paragraphs;
+                while(xmlReader.readNextStartElement()) {
+                    if(xmlReader.name() == QStringLiteral("p")) {
+                        paragraphs.append(readAcbfParagraph(xmlReader));
+                    } else {
+                        xmlReader.skipCurrentElement();
+                    }
+                }
+                annotations[language] = paragraphs;
+            } else if(xmlReader.name() == QStringLiteral("keywords")) {
+                const QString language = xmlReader.attributes().value(QStringLiteral("lang")).toString();
+                languageKeywords[language] = xmlReader.readElementText(QXmlStreamReader::IncludeChildElements).split(QLatin1Char(','));
+            } else if(xmlReader.name() == QStringLiteral("languages")) {
+                while(xmlReader.readNextStartElement()) {
+                    if(xmlReader.name() == QStringLiteral("text-layer") && firstLanguage.isEmpty()) {
+                        firstLanguage = xmlReader.attributes().value(QStringLiteral("lang")).toString();
+                    }
+                    xmlReader.skipCurrentElement();
+                }
+            } else if(xmlReader.name() == QStringLiteral("sequence")) {
+                Sequence sequence;
+                sequence.volume = xmlReader.attributes().value(QStringLiteral("volume")).toInt();
+                sequence.title = xmlReader.attributes().value(QStringLiteral("title")).toString();
+                sequence.number = xmlReader.readElementText(QXmlStreamReader::IncludeChildElements).toInt();
+                sequences.append(sequence);
+            } else {
+                xmlReader.skipCurrentElement();
+            }
+        }
+        title = forDefaultLanguage(titles, firstLanguage);
+        description = forDefaultLanguage(annotations, firstLanguage);
+        keywords = forDefaultLanguage(languageKeywords, firstLanguage);
+    }
+
+    bool readAcbf(QIODevice* device) {
+        QXmlStreamReader xmlReader(device);
+        if(!xmlReader.readNextStartElement() || xmlReader.name() != QStringLiteral("ACBF")) {
+            return false;
+        }
+        // The cover is always counted, whether or not the document has one
+        pageCount = 1;
+        while(xmlReader.readNextStartElement()) {
+            if(xmlReader.name() == QStringLiteral("meta-data")) {
+                while(xmlReader.readNextStartElement()) {
+                    if(xmlReader.name() == QStringLiteral("book-info")) {
+                        readAcbfBookInfo(xmlReader);
+                    } else if(xmlReader.name() == QStringLiteral("publish-info")) {
+                        while(xmlReader.readNextStartElement()) {
+                            if(xmlReader.name() == QStringLiteral("publisher")) {
+                                publisher = xmlReader.readElementText(QXmlStreamReader::IncludeChildElements);
+                            } else {
+                                xmlReader.skipCurrentElement();
+                            }
+                        }
+                    } else {
+                        xmlReader.skipCurrentElement();
+                    }
+                }
+            } else if(xmlReader.name() == QStringLiteral("body")) {
+                while(xmlReader.readNextStartElement()) {
+                    if(xmlReader.name() == QStringLiteral("page")) {
+                        ++pageCount;
+                    }
+                    xmlReader.skipCurrentElement();
+                }
+                // Everything after the body (references, embedded binaries and styles) is
+                // of no interest to us, and the binaries are by far the largest part of the file
+                break;
+            } else {
+                xmlReader.skipCurrentElement();
+            }
+        }
+        if(xmlReader.hasError()) {
+            qCWarning(QTQUICK_LOG) << Q_FUNC_INFO << "Failed to read ACBF document in" << fileName << "at" << xmlReader.lineNumber() << ":" << xmlReader.columnNumber() << "The reported error was:" << xmlReader.errorString();
+        }
+        return !xmlReader.hasError();
+    }
+
+    // ComicInfo.xml and CoMet documents are read the same way ArchiveBookModel reads them
+    void takeComicMetadata(const ComicMetadata& metadata) {
+        title = metadata.title;
+        description = metadata.annotation;
+        publisher = metadata.publisher;
+        for(const ComicMetadata::Sequence& sequence : metadata.sequences) {
+            sequences.append(Sequence{sequence.title, sequence.number, sequence.volume});
+        }
+        genres = metadata.genres;
+        keywords = metadata.keywords;
+        for(const ComicMetadata::Author& author : metadata.authors) {
+            authors.append(author.name);
+        }
+        characters = metadata.characters;
+    }
+
+    bool readComicInfo(QIODevice* device, int imageCount) {
+        ComicMetadata metadata;
+        if(!metadata.readComicInfo(device, metadataEntry)) {
+            return false;
+        }
+        takeComicMetadata(metadata);
+        // Like for ACBF, the cover is counted whether or not one was marked as such. Without
+        // a page list, the images in the archive are what will be shown.
+        if(metadata.hasPageList) {
+            pageCount = 1;
+            for(const ComicMetadata::Page& page : qAsConst(metadata.pages)) {
+                if(page.type != QStringLiteral("FrontCover")) {
+                    ++pageCount;
+                }
+            }
+        } else {
+            pageCount = imageCount;
+        }
+        return true;
+    }
+
+    bool readCoMet(QIODevice* device, const QStringList& images) {
+        ComicMetadata metadata;
+        if(!metadata.readCoMet(device, metadataEntry)) {
+            return false;
+        }
+        takeComicMetadata(metadata);
+        // The cover, followed by all the other images
+        pageCount = images.contains(metadata.coverImage) ? images.count() : images.count() + 1;
+        return true;
+    }
+};
+
+ArchiveMetadataProbe::ArchiveMetadataProbe(const QString& fileName, const QString& mimetype)
+    : d(new Private(fileName, mimetype))
+{
+}
+
+ArchiveMetadataProbe::~ArchiveMetadataProbe()
+{
+    delete d;
+}
+
+bool ArchiveMetadataProbe::probe()
+{
+    QMimeDatabase mimeDatabase;
+    QMimeType mime = d->mimetype.isEmpty() ? mimeDatabase.mimeTypeForFile(d->fileName) : mimeDatabase.mimeTypeForName(d->mimetype);
+    std::unique_ptr<KArchive> archive;
+    if(mime.inherits(QStringLiteral("application/zip"))) {
+        archive.reset(new KZip(d->fileName));
+    } else if(mime.inherits(QStringLiteral("application/x-rar"))) {
+        archive.reset(new KRar(d->fileName));
+    }
+    if(!archive || !archive->open(QIODevice::ReadOnly)) {
+        qCDebug(QTQUICK_LOG) << "Failed to open archive" << d->fileName;
+        return false;
+    }
+
+    const KArchiveDirectory* directory = archive->directory();
+    QStringList entries = recursiveEntries(directory);
+    entries.sort();
+
+    // Pick the metadata document the same way ArchiveBookModel::setFilename() does
+    QString acbfEntry;
+    QString comicInfoEntry;
+    QStringList xmlFiles;
+    QStringList images;
+    int fileCount{0};
+    const QString undesired{QStringLiteral("/Thumbs.db")};
+    for(const QString& entry : qAsConst(entries)) {
+        const QString lowerEntry = entry.toLower();
+        if(acbfEntry.isEmpty()) {
+            if(lowerEntry.endsWith(QStringLiteral(".acbf"))) {
+                acbfEntry = entry;
+            } else if(lowerEntry.endsWith(QStringLiteral("comicinfo.xml"))) {
+                comicInfoEntry = entry;
+            } else if(lowerEntry.endsWith(QStringLiteral(".xml"))) {
+                xmlFiles.append(entry);
+            }
+        }
+        if(lowerEntry.endsWith(QStringLiteral(".jpg")) || lowerEntry.endsWith(QStringLiteral(".jpeg"))
+                || lowerEntry.endsWith(QStringLiteral(".gif")) || lowerEntry.endsWith(QStringLiteral(".png")) || lowerEntry.endsWith(QStringLiteral(".webp"))) {
+            images.append(entry);
+        }
+        const KArchiveEntry* archEntry = directory->entry(entry);
+        if(archEntry && archEntry->isFile() && !entry.endsWith(undesired)) {
+            ++fileCount;
+        }
+    }
+
+    if(!acbfEntry.isEmpty()) {
+        const KArchiveFile* archFile = directory->file(acbfEntry);
+        if(archFile) {
+            std::unique_ptr<QIODevice> device = openEntry(archFile);
+            d->metadataEntry = acbfEntry;
+            if(d->readAcbf(device.get())) {
+                d->format = AcbfMetadata;
+            }
+        }
+    } else if(!comicInfoEntry.isEmpty()) {
+        const KArchiveFile* archFile = directory->file(comicInfoEntry);
+        if(archFile) {
+            std::unique_ptr<QIODevice> device = openEntry(archFile);
+            d->metadataEntry = comicInfoEntry;
+            if(d->readComicInfo(device.get(), images.count())) {
+                d->format = ComicInfoMetadata;
+            }
+        }
+    } else {
+        const QString coMetEntry = findCoMetEntry(d->fileName, directory, xmlFiles);
+        const KArchiveFile* archFile = coMetEntry.isEmpty() ? nullptr : directory->file(coMetEntry);
+        if(archFile) {
+            std::unique_ptr<QIODevice> device = openEntry(archFile);
+            d->metadataEntry = coMetEntry;
+            if(d->readCoMet(device.get(), images)) {
+                d->format = CoMetMetadata;
+            }
+        }
+    }
+
+    if(d->format == NoMetadata) {
+        // Throw away anything a failed attempt at reading a document left behind
+        d->clearMetadata();
+        // Without metadata, every file in the archive is shown as a page
+        d->pageCount = fileCount;
+    }
+    archive->close();
+    return true;
+}
+
+ArchiveMetadataProbe::Format ArchiveMetadataProbe::format() const
+{
+    return d->format;
+}
+
+QString ArchiveMetadataProbe::metadataEntry() const
+{
+    return d->metadataEntry;
+}
+
+QString ArchiveMetadataProbe::title() const
+{
+    return d->title;
+}
+
+QStringList ArchiveMetadataProbe::authors() const
+{
+    return d->authors;
+}
+
+QString ArchiveMetadataProbe::publisher() const
+{
+    return d->publisher;
+}
+
+QList<ArchiveMetadataProbe::Sequence> ArchiveMetadataProbe::sequences() const
+{
+    return d->sequences;
+}
+
+QStringList ArchiveMetadataProbe::genres() const
+{
+    return d->genres;
+}
+
+QStringList ArchiveMetadataProbe::characters() const
+{
+    return d->characters;
+}
+
+QStringList ArchiveMetadataProbe::keywords() const
+{
+    return d->keywords;
+}
+
+QStringList ArchiveMetadataProbe::description() const
+{
+    return d->description;
+}
+
+int ArchiveMetadataProbe::pageCount() const
+{
+    return d->pageCount;
+}
+
+QString ArchiveMetadataProbe::findCoMetEntry(const QString& fileName, const KArchiveDirectory* directory, const QStringList& candidates)
+{
+    const QFileInfo fileInfo(fileName);
+    const QString key = fileInfo.absoluteFilePath();
+    {
+        QMutexLocker locker(&coMetEntriesMutex);
+        const CoMetEntry* cached = coMetEntries.object(key);
+        if(cached && cached->lastModified == fileInfo.lastModified() && cached->size == fileInfo.size()) {
+            return cached->entry;
+        }
+    }
+
+    QString found;
+    for(const QString& candidate : candidates) {
+        const KArchiveFile* archFile = directory->file(candidate);
+        if(archFile && rootElementName(archFile) == QStringLiteral("comet")) {
+            found = candidate;
+            break;
+        }
+    }
+
+    CoMetEntry* entry = new CoMetEntry;
+    entry->lastModified = fileInfo.lastModified();
+    entry->size = fileInfo.size();
+    entry->entry = found;
+    QMutexLocker locker(&coMetEntriesMutex);
+    coMetEntries.insert(key, entry);
+    return found;
+}
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2026 Dan Leinir Turthra Jensen <admin@leinir.dk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ARCHIVEMETADATAPROBE_H
+#define ARCHIVEMETADATAPROBE_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+class KArchiveDirectory;
+/**
+ * \brief Reads the information the library needs about a comic book archive
+ *
+ * Loading an archive into an ArchiveBookModel builds a complete ACBF document,
+ * including every page, frame and text layer, and for ACBF books also reads any
+ * embedded binaries. When all we want is to list the book in the library, that
+ * is a lot of work to throw away again straight after.
+ *
+ * This class instead streams through the metadata document in the archive (an
+ * ACBF document, a ComicInfo.xml or a CoMet document, picked in the same order
+ * ArchiveBookModel uses), picking out only the information which ends up in the
+ * library, and stops reading as soon as it has that. ComicInfo.xml and CoMet
+ * documents are read through ComicMetadata, just like ArchiveBookModel reads them.
+ * Nothing is written back to the archive or the file's extended attributes.
+ */
+class ArchiveMetadataProbe
+{
+public:
+    /**
+     * \brief The type of metadata document found in the archive
+     */
+    enum Format {
+        NoMetadata = 0,
+        AcbfMetadata,
+        ComicInfoMetadata,
+        CoMetMetadata
+    };
+    /**
+     * \brief One series the book is a part of
+     */
+    struct Sequence {
+        QString title;
+        int number{0};
+        int volume{0};
+    };
+
+    /**
+     * @param fileName The archive to read
+     * @param mimetype The mimetype of the archive, if already known. If this is left
+     * empty, it is looked up from the file itself.
+     */
+    explicit ArchiveMetadataProbe(const QString& fileName, const QString& mimetype = QString());
+    ~ArchiveMetadataProbe();
+
+    /**
+     * \brief Open the archive and read the metadata out of it.
+     * @return True if the archive could be opened (whether or not it contained any
+     * metadata documents)
+     */
+    bool probe();
+
+    /**
+     * @return The kind of metadata document the information was read from
+     */
+    Format format() const;
+    /**
+     * @return The name of the entry the metadata was read from, or an empty string
+     * if there was none
+     */
+    QString metadataEntry() const;
+
+    /**
+     * @return The title of the book, in the book's default language. Empty if the
+     * metadata did not contain a title.
+     */
+    QString title() const;
+    /**
+     * @return The display names of all the authors of the book
+     */
+    QStringList authors() const;
+    /**
+     * @return The name of the publisher (joined with the imprint, for ComicInfo)
+     */
+    QString publisher() const;
+    /**
+     * @return The series this book is a part of, in the order they were listed
+     */
+    QList<Sequence> sequences() const;
+    /**
+     * @return The ACBF genre keys of the book
+     */
+    QStringList genres() const;
+    /**
+     * @return The names of the characters appearing in the book
+     */
+    QStringList characters() const;
+    /**
+     * @return The keywords for the book, in the book's default language
+     */
+    QStringList keywords() const;
+    /**
+     * @return The paragraphs of the book's description, in the book's default language
+     */
+    QStringList description() const;
+    /**
+     * @return The number of pages in the book, counted the same way ArchiveBookModel
+     * would (that is, including the cover)
+     */
+    int pageCount() const;
+
+    /**
+     * \brief Find the CoMet document amongst the xml files in an archive.
+     *
+     * Archives often contain other xml files than the metadata (scanner logs, per-page
+     * information and the like), so only the first few hundred bytes of each candidate
+     * are read, which is enough to find the root element. The result is remembered for
+     * each archive until the archive file changes, so loading the same archive again
+     * (or loading a book which has just been added to the library) does not check the
+     * candidates again.
+     *
+     * @param fileName The archive file the directory belongs to
+     * @param directory The root directory of the opened archive
+     * @param candidates The xml entries to check, in the order they should be checked
+     * @return The name of the first CoMet document, or an empty string if there is none
+     */
+    static QString findCoMetEntry(const QString& fileName, const KArchiveDirectory* directory, const QStringList& candidates);
+private:
+    class Private;
+    Private* d;
+};
+
+#endif//ARCHIVEMETADATAPROBE_H
@@ -0,0 +1,393 @@
+/*
+ * Copyright (C) 2026 Dan Leinir Turthra Jensen <admin@leinir.dk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ArchiveSaveJob.h"
+#include "ZipRewriter.h"
+
+#include <QAtomicInt>
+#include <QFileInfo>
+#include <QMimeDatabase>
+#include <QSaveFile>
+#include <QScopedPointer>
+#include <QSemaphore>
+#include <QSharedPointer>
+#include <QTemporaryFile>
+#include <QThreadPool>
+
+#include <KFileMetaData/UserMetaData>
+#include <KLocalizedString>
+#include <karchive.h>
+#include <kzip.h>
+#include "KRar.h"
+
+#include <qtquick_debug.h>
+
+namespace {
+    const qint64 copyChunkSize{1024 * 1024};
+    // An archive is compacted (written out as a new copy without the unused space) when saving
+    // once more than this much of it is unused, or this fraction of its size, whichever is larger
+    const qint64 compactionMinimum{1024 * 1024};
+    const qint64 compactionRatio{10};
+
+    // The user metadata stored in extended attributes on the archive file, which gets lost
+    // when the file is replaced by a new copy, so we carry it across by hand
+    struct FileMetaData {
+        explicit FileMetaData(const QString& fileName) {
+            KFileMetaData::UserMetaData data(fileName);
+            tags = data.tags();
+            rating = data.rating();
+            userComment = data.userComment();
+            for (const QString& key : attributeKeys()) {
+                if (data.hasAttribute(key)) {
+                    attributes[key] = data.attribute(key);
+                }
+            }
+        }
+        void writeTo(const QString& fileName) const {
+            KFileMetaData::UserMetaData data(fileName);
+            if (!tags.isEmpty()) {
+                data.setTags(tags);
+            }
+            if (rating > 0) {
+                data.setRating(rating);
+            }
+            if (!userComment.isEmpty()) {
+                data.setUserComment(userComment);
+            }
+            for (auto attribute = attributes.constBegin(); attribute != attributes.constEnd(); ++attribute) {
+                data.setAttribute(attribute.key(), attribute.value());
+            }
+        }
+        static QStringList attributeKeys() {
+            return {QStringLiteral("peruse.currentPage"), QStringLiteral("peruse.totalPages")};
+        }
+        QStringList tags;
+        int rating{0};
+        QString userComment;
+        QHash<QString, QString> attributes;
+    };
+}
+
+class ArchiveSaveJob::Private
+{
+public:
+    Private(ArchiveSaveJob* qq)
+        : q(qq)
+    {}
+    ArchiveSaveJob* q;
+    // Everything the worker thread needs. This is set up before the job is started, and
+    // not touched by the job itself again until the worker is done with it.
+    struct State {
+        QString fileName;
+        QString acbfEntryName;
+        QByteArray acbfData;
+        QStringList entriesToDelete;
+        QList<QPair<QString, QString>> localFiles;
+        QAtomicInt cancelled{0};
+        // Released by the worker when it is done, so we can wait for it if the job is deleted early
+        QSemaphore finished;
+        QString errorString;
+    };
+    QSharedPointer<State> state{new State};
+    bool started{false};
+
+    // Called on the worker thread, and passes things on to the job on its own thread
+    void reportProgress(qint64 processed, qint64 total) {
+        QMetaObject::invokeMethod(q, [this, processed, total](){
+            q->setTotalAmount(KJob::Bytes, qulonglong(total));
+            q->setProcessedAmount(KJob::Bytes, qulonglong(processed));
+            q->emitPercent(qulonglong(processed), qulonglong(total));
+        }, Qt::QueuedConnection);
+    }
+    void reportDescription(const QString& description) {
+        QMetaObject::invokeMethod(q, [this, description](){
+            Q_EMIT q->infoMessage(q, description);
+        }, Qt::QueuedConnection);
+    }
+
+    static bool copyFile(const QString& from, QIODevice* to, qint64 processed, qint64 total, const std::function<bool(qint64, qint64)>& progress) {
+        QFile file(from);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return false;
+        }
+        while (!file.atEnd()) {
+            const QByteArray chunk = file.read(copyChunkSize);
+            if (chunk.isEmpty() || to->write(chunk) != chunk.size()) {
+                return false;
+            }
+            processed += chunk.size();
+            if (!progress(processed, total)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Write the archive by unpacking and repacking every entry with KArchive. This is slow, but
+    // works for anything KArchive can read (such as rar archives), and for creating new archives.
+    bool recompress(const std::function<bool(qint64, qint64)>& progress) {
+        QScopedPointer<KArchive> source;
+        if (QFile::exists(state->fileName)) {
+            QMimeDatabase mimeDatabase;
+            const QMimeType mime = mimeDatabase.mimeTypeForFile(state->fileName);
+            if (mime.inherits(QStringLiteral("application/zip"))) {
+                source.reset(new KZip(state->fileName));
+            } else if (mime.inherits(QStringLiteral("application/x-rar"))) {
+                source.reset(new KRar(state->fileName));
+            }
+            if (!source || !source->open(QIODevice::ReadOnly)) {
+                state->errorString = i18n("Could not read the existing archive %1", state->fileName);
+                return false;
+            }
+        }
+
+        // Work out what goes into the new archive, so we can tell how far along we are
+        QList<const KArchiveFile*> files;
+        QStringList fileNames;
+        qint64 total{state->acbfData.size()};
+        if (source) {
+            QList<QPair<QString, const KArchiveDirectory*>> directories{{QString(), source->directory()}};
+            while (!directories.isEmpty()) {
+                const auto directory = directories.takeFirst();
+                const QStringList entries = directory.second->entries();
+                for (const QString& entryName : entries) {
+                    const QString path = directory.first.isEmpty() ? entryName : QStringLiteral("%1/%2").arg(directory.first, entryName);
+                    const KArchiveEntry* entry = directory.second->entry(entryName);
+                    if (entry->isDirectory()) {
+                        directories << qMakePair(path, static_cast<const KArchiveDirectory*>(entry));
+                    } else if (entry->isFile() && path != state->acbfEntryName && !state->entriesToDelete.contains(path)) {
+                        files << static_cast<const KArchiveFile*>(entry);
+                        fileNames << path;
+                        total += files.last()->size();
+                    }
+                }
+            }
+        }
+        for (const auto& localFile : qAsConst(state->localFiles)) {
+            total += QFileInfo(localFile.second).size();
+        }
+        // The finished archive is copied over the old one at the end, which we guess will
+        // take around as much as writing it did
+        total *= 2;
+
+        QTemporaryFile temporaryFile(QStringLiteral("%1/.XXXXXX.cbz").arg(QFileInfo(state->fileName).absolutePath()));
+        if (!temporaryFile.open()) {
+            state->errorString = i18n("Could not create a temporary file next to %1", state->fileName);
+            return false;
+        }
+        qint64 processed{0};
+        {
+            KZip archive(&temporaryFile);
+            if (!archive.open(QIODevice::WriteOnly)) {
+                state->errorString = archive.errorString();
+                return false;
+            }
+            bool success = archive.writeFile(state->acbfEntryName, state->acbfData);
+            processed += state->acbfData.size();
+            for (int i = 0; success && i < files.count(); ++i) {
+                if (!progress(processed, total)) {
+                    success = false;
+                    break;
+                }
+                const KArchiveFile* file = files.at(i);
+                success = archive.writeFile(fileNames.at(i), file->data(), file->permissions(), file->user(), file->group());
+                processed += file->size();
+            }
+            for (const auto& localFile : qAsConst(state->localFiles)) {
+                if (!success || !progress(processed, total)) {
+                    success = false;
+                    break;
+                }
+                success = archive.addLocalFile(localFile.second, localFile.first);
+                processed += QFileInfo(localFile.second).size();
+            }
+            if (!archive.close() || !success) {
+                if (state->errorString.isEmpty()) {
+                    state->errorString = archive.errorString();
+                }
+                return false;
+            }
+        }
+
+        total = processed + temporaryFile.size();
+        const FileMetaData metaData(state->fileName);
+        QSaveFile target(state->fileName);
+        if (!target.open(QIODevice::WriteOnly)
+            || !copyFile(temporaryFile.fileName(), &target, processed, total, progress)
+            || !target.commit()) {
+            if (state->errorString.isEmpty()) {
+                state->errorString = target.errorString();
+            }
+            target.cancelWriting();
+            return false;
+        }
+        metaData.writeTo(state->fileName);
+        return true;
+    }
+
+    void setUpRewriter(ZipRewriter& rewriter, const std::function<bool(qint64, qint64)>& progress) {
+        for (const QString& entry : qAsConst(state->entriesToDelete)) {
+            rewriter.removeEntry(entry);
+        }
+        rewriter.setEntryData(state->acbfEntryName, state->acbfData);
+        for (const auto& localFile : qAsConst(state->localFiles)) {
+            rewriter.setEntryFile(localFile.first, localFile.second);
+        }
+        rewriter.setProgressFunction(progress);
+    }
+
+    // Write the archive without touching any of the unchanged entries' data, see ZipRewriter
+    // Returns false, and leaves the error string empty, if this cannot be done for this archive
+    bool rewrite(const std::function<bool(qint64, qint64)>& progress) {
+        {
+            ZipRewriter rewriter(state->fileName);
+            if (!rewriter.open()) {
+                return false;
+            }
+            setUpRewriter(rewriter, progress);
+
+            // Only the new entries need writing when updating the archive in place, which also leaves
+            // the file itself (and so its extended attributes) alone. The space taken by the entries
+            // which were replaced is not reclaimed by this though, so once enough has built up, we
+            // write a compacted copy instead.
+            const qint64 archiveSize = QFileInfo(state->fileName).size();
+            if (rewriter.unusedSize() <= qMax(compactionMinimum, archiveSize / compactionRatio)) {
+                reportDescription(i18n("Updating %1", state->fileName));
+                if (rewriter.updateInPlace()) {
+                    return true;
+                }
+                if (state->cancelled) {
+                    state->errorString = rewriter.errorString();
+                    return false;
+                }
+                qCWarning(QTQUICK_LOG) << "Failed to update the archive in place, writing a new copy instead:" << rewriter.errorString();
+            }
+        }
+
+        // Unchanged entries are copied across verbatim, so this is still much cheaper than recompressing everything
+        ZipRewriter rewriter(state->fileName);
+        if (!rewriter.open()) {
+            return false;
+        }
+        setUpRewriter(rewriter, progress);
+        reportDescription(i18n("Copying across all files not marked for deletion"));
+        const FileMetaData metaData(state->fileName);
+        QSaveFile target(state->fileName);
+        if (target.open(QIODevice::WriteOnly) && rewriter.writeTo(&target) && target.commit()) {
+            metaData.writeTo(state->fileName);
+            return true;
+        }
+        target.cancelWriting();
+        if (state->cancelled) {
+            state->errorString = rewriter.errorString();
+        } else {
+            qCWarning(QTQUICK_LOG) << "Failed to copy the archive across directly, falling back to recompressing it:" << rewriter.errorString() << target.errorString();
+        }
+        return false;
+    }
+
+    bool run() {
+        const std::function<bool(qint64, qint64)> progress = [this](qint64 processed, qint64 total) {
+            reportProgress(processed, total);
+            return !state->cancelled;
+        };
+        if (rewrite(progress)) {
+            return true;
+        }
+        if (state->cancelled) {
+            return false;
+        }
+        reportDescription(i18n("Recompressing all files not marked for deletion"));
+        return recompress(progress);
+    }
+};
+
+ArchiveSaveJob::ArchiveSaveJob(const QString& fileName, QObject* parent)
+    : KJob(parent)
+    , d(new Private(this))
+{
+    d->state->fileName = fileName;
+}
+
+ArchiveSaveJob::~ArchiveSaveJob()
+{
+    if (d->started) {
+        // Stop the worker as soon as possible, and make sure it is done before we go away
+        d->state->cancelled = 1;
+        d->state->finished.acquire();
+    }
+    delete d;
+}
+
+QString ArchiveSaveJob::fileName() const
+{
+    return d->state->fileName;
+}
+
+void ArchiveSaveJob::setAcbfData(const QString& entryName, const QByteArray& data)
+{
+    d->state->acbfEntryName = entryName;
+    d->state->acbfData = data;
+}
+
+void ArchiveSaveJob::setEntriesToDelete(const QStringList& entries)
+{
+    d->state->entriesToDelete = entries;
+}
+
+void ArchiveSaveJob::addLocalFile(const QString& entryName, const QString& localFile)
+{
+    d->state->localFiles << qMakePair(entryName, localFile);
+}
+
+void ArchiveSaveJob::start()
+{
+    if (d->started) {
+        return;
+    }
+    d->started = true;
+    Q_EMIT infoMessage(this, i18n("Saving %1", d->state->fileName));
+    // The job may be gone as soon as it has its result, so the worker only touches the state after that
+    QSharedPointer<Private::State> state = d->state;
+    QThreadPool::globalInstance()->start([this, state](){
+        const bool success = d->run();
+        const QString errorString = state->errorString;
+        QMetaObject::invokeMethod(this, [this, success, errorString](){
+            if (!success) {
+                if (d->state->cancelled) {
+                    setError(KJob::KilledJobError);
+                } else {
+                    setError(KJob::UserDefinedError);
+                }
+                setErrorText(errorString.isEmpty() ? i18n("Failed to save %1", d->state->fileName) : errorString);
+            }
+            emitResult();
+        }, Qt::QueuedConnection);
+        state->finished.release();
+    });
+}
+
+void ArchiveSaveJob::cancel()
+{
+    // The worker thread stops at the next opportunity, and we finish with KilledJobError
+    // then, rather than right now (which would have us deleted while the worker runs)
+    d->state->cancelled = 1;
+}
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2026 Dan Leinir Turthra Jensen <admin@leinir.dk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ARCHIVESAVEJOB_H
+#define ARCHIVESAVEJOB_H
+
+#include <KJob>
+
+/**
+ * \brief A job which writes the changes to an archive based book to disk
+ *
+ * The actual work happens on a thread in the global thread pool, so the user
+ * interface stays responsive while saving even very large books. Progress is
+ * reported in bytes (through the usual KJob amount and percent signals), and
+ * what is currently happening is described through infoMessage().
+ *
+ * Zip archives are usually updated in place, by writing only what changed where
+ * the central directory used to be (see ZipRewriter), which means saving metadata
+ * changes takes time in proportion to the size of the metadata rather than to
+ * that of the book. Once too much of the archive is taken up by entries which have
+ * been replaced, or for anything which is not a zip archive, a new copy of the
+ * archive is written next to the old one instead (copying unchanged entries across
+ * without recompressing them where possible), which then replaces the old one in a
+ * single rename once it is complete. Either way, cancelling the job, or the
+ * application going away part way through saving, leaves the original archive
+ * as it was (or in the case of an in place update, able to be put back the way it was). The job cannot be killed, as the
+ * worker thread needs it to stay around until it has stopped; use cancel() instead.
+ * For the same reason, the job should not be given a parent which might be deleted
+ * before the save is done. Like other jobs, it deletes itself once it has finished.
+ *
+ * The job does not touch the model the book was loaded into. Once the job has
+ * finished successfully, the archive on disk contains the new data, and anything
+ * still holding the old archive open should reopen it.
+ */
+class ArchiveSaveJob : public KJob
+{
+    Q_OBJECT
+public:
+    /**
+     * @param fileName The archive to save to. This does not need to exist yet.
+     * @param parent The object which owns the job. Deleting the job while it is saving
+     * cancels the save and blocks until the worker has stopped, so this is best left empty.
+     */
+    explicit ArchiveSaveJob(const QString& fileName, QObject* parent = nullptr);
+    ~ArchiveSaveJob() override;
+
+    /**
+     * @return The name of the archive file being written
+     */
+    QString fileName() const;
+
+    /**
+     * \brief Set the ACBF document to write into the archive.
+     * @param entryName The name of the entry to write it as. Any existing entry by that name is replaced.
+     * @param data The document, as UTF-8 encoded XML
+     */
+    void setAcbfData(const QString& entryName, const QByteArray& data);
+    /**
+     * \brief Set the entries which should be left out of the saved archive.
+     * @param entries The names of the entries, as they are in ArchiveBookModel::fileEntries()
+     */
+    void setEntriesToDelete(const QStringList& entries);
+    /**
+     * \brief Add a file from disk to the archive.
+     * @param entryName The name the file will have inside the archive
+     * @param localFile The file to copy in
+     */
+    void addLocalFile(const QString& entryName, const QString& localFile);
+
+    void start() override;
+    /**
+     * \brief Stop writing the archive as soon as possible, leaving the original as it was.
+     * Unlike KJob::kill(), this is asynchronous: the job finishes with KJob::KilledJobError
+     * once the worker thread has noticed, and is not deleted until then.
+     */
+    void cancel();
+private:
+    class Private;
+    Private* d;
+};
+
+#endif//ARCHIVESAVEJOB_H
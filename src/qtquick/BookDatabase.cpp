@@ -22,6 +22,7 @@
 #include "BookDatabase.h"
 
 #include "CategoryEntriesModel.h"
+#include "PerformanceTimer.h"
 
 #include <QStandardPaths>
 #include <QSqlDatabase>
@@ -88,6 +89,38 @@ public:
         return true;
     }
 
+    bool updateField(const QString& fileName, const QString& property, const QVariant& value) {
+        if (!fieldNames.contains(property)) {
+            return false;
+        }
+
+        QStringList stringListValues;
+        stringListValues << "series" << "author" << "characters" << "genres" << "keywords" << "tags";
+        QString val;
+        if (stringListValues.contains(property)) {
+            val = value.toStringList().join(",");
+        } else if (property == "description") {
+            val = value.toStringList().join("\n");
+        }
+
+        QSqlQuery updateEntry;
+        updateEntry.prepare(QString("UPDATE books SET %1=:value WHERE fileName=:filename ").arg(property));
+        updateEntry.bindValue(":value", value);
+        if (!val.isEmpty()) {
+            updateEntry.bindValue(":value", val);
+        }
+        updateEntry.bindValue(":filename", fileName);
+        if (!updateEntry.exec()) {
+            qCDebug(QTQUICK_LOG) << updateEntry.lastError();
+            qCDebug(QTQUICK_LOG) << "Query failed, string:" << updateEntry.lastQuery();
+            qCDebug(QTQUICK_LOG) << updateEntry.boundValue(":value");
+            qCDebug(QTQUICK_LOG) << updateEntry.boundValue(":filename");
+            qCDebug(QTQUICK_LOG) << db.lastError();
+            return false;
+        }
+        return true;
+    }
+
     void closeDb() {
         db.close();
     }
@@ -106,6 +139,7 @@ BookDatabase::~BookDatabase()
 
 QList<BookEntry*> BookDatabase::loadEntries()
 {
+    PerformanceTimer timer("BookDatabase::loadEntries");
     if(!d->prepareDb()) {
         return QList<BookEntry*>();
     }
@@ -149,6 +183,7 @@ QList<BookEntry*> BookDatabase::loadEntries()
 
         entries.append(entry);
     }
+    timer.setCount(entries.count());
 
     d->closeDb();
     return entries;
@@ -156,6 +191,7 @@ QList<BookEntry*> BookDatabase::loadEntries()
 
 void BookDatabase::addEntry(BookEntry* entry)
 {
+    PerformanceTimer timer("BookDatabase::addEntry");
     if(!d->prepareDb()) {
         return;
     }
@@ -215,32 +251,31 @@ void BookDatabase::updateEntry(QString fileName, QString property, QVariant valu
     }
     //qCDebug(QTQUICK_LOG) << "Updating book in the database" << fileName << property << value;
 
-    if (!d->fieldNames.contains(property)) {
-        return;
-    }
+    d->updateField(fileName, property, value);
 
-    QStringList stringListValues;
-    stringListValues << "series" << "author" << "characters" << "genres" << "keywords" << "tags";
-    QString val;
-    if (stringListValues.contains(property)) {
-        val = value.toStringList().join(",");
-    } else if (property == "description") {
-        val = value.toStringList().join("\n");
-    }
+    d->closeDb();
+}
 
-    QSqlQuery updateEntry;
-    updateEntry.prepare(QString("UPDATE books SET %1=:value WHERE fileName=:filename ").arg(property));
-    updateEntry.bindValue(":value", value);
-    if (!val.isEmpty()) {
-        updateEntry.bindValue(":value", val);
+void BookDatabase::updateEntries(const QHash<QString, QVariantHash>& changes)
+{
+    PerformanceTimer timer("BookDatabase::updateEntries");
+    timer.setCount(changes.count());
+    if(changes.isEmpty() || !d->prepareDb()) {
+        return;
+    }
+    qCDebug(QTQUICK_LOG) << "Updating" << changes.count() << "books in the database";
+
+    // One transaction for the lot, so sqlite only has to sync the file once
+    const bool inTransaction = d->db.transaction();
+    for(auto book = changes.constBegin(); book != changes.constEnd(); ++book) {
+        const QVariantHash& fields = book.value();
+        for(auto field = fields.constBegin(); field != fields.constEnd(); ++field) {
+            d->updateField(book.key(), field.key(), field.value());
+        }
     }
-    updateEntry.bindValue(":filename", fileName);
-    if (!updateEntry.exec()) {
-        qCDebug(QTQUICK_LOG) << updateEntry.lastError();
-        qCDebug(QTQUICK_LOG) << "Query failed, string:" << updateEntry.lastQuery();
-        qCDebug(QTQUICK_LOG) << updateEntry.boundValue(":value");
-        qCDebug(QTQUICK_LOG) << updateEntry.boundValue(":filename");
-        qCDebug(QTQUICK_LOG) << d->db.lastError();
+    if(inTransaction && !d->db.commit()) {
+        qCDebug(QTQUICK_LOG) << "Failed to commit the changes to the database" << d->db.lastError();
+        d->db.rollback();
     }
 
     d->closeDb();
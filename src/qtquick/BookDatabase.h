@@ -23,6 +23,7 @@
 #define BOOKDATABASE_H
 
 #include <QObject>
+#include <QVariant>
 
 struct BookEntry;
 /**
@@ -61,6 +62,13 @@ public:
      * @param value a QVariant with the value.
      */
     void updateEntry(QString fileName, QString property, QVariant value);
+    /**
+     * @brief updateEntries update a number of fields on a number of entries in one go.
+     * All the changes are written in a single transaction.
+     * @param changes The new values of the fields to update (by fieldname), for each
+     * filename.
+     */
+    void updateEntries(const QHash<QString, QVariantHash>& changes);
 private:
     class Private;
     Private* d;
@@ -23,17 +23,16 @@
 
 #include "BookDatabase.h"
 #include "CategoryEntriesModel.h"
-#include "ArchiveBookModel.h"
-
-#include "AcbfAuthor.h"
-#include "AcbfSequence.h"
-#include "AcbfBookinfo.h"
+#include "ArchiveMetadataProbe.h"
+#include "PerformanceTimer.h"
+#include "ReadingProgressJournal.h"
 
 #include <kio/deletejob.h>
 #include <KFileMetaData/UserMetaData>
 
 #include <QCoreApplication>
 #include <QDir>
+#include <QHash>
 #include <QMimeDatabase>
 #include <QTimer>
 #include <QUrl>
@@ -54,13 +53,17 @@ public:
         , cacheLoaded(false)
     {
         db = new BookDatabase();
+        ReadingProgressJournal::instance()->setDatabase(db);
     };
     ~Private()
     {
+        // Write out anything still waiting for the database before it goes away
+        ReadingProgressJournal::instance()->flush();
         qDeleteAll(entries);
         db->deleteLater();
     }
     QList<BookEntry*> entries;
+    QHash<QString, BookEntry*> entriesByFilename;
 
     QAbstractListModel* contentModel;
     CategoryEntriesModel* titleCategoryModel;
@@ -128,6 +131,7 @@ public:
 
     void addEntry(BookListModel* q, BookEntry* entry) {
         entries.append(entry);
+        entriesByFilename.insert(entry->filename, entry);
         q->append(entry);
         titleCategoryModel->addCategoryEntry(entry->title.left(1).toUpper(), entry);
         for (int i=0; i<entry->author.size(); i++) {
@@ -136,7 +140,7 @@ public:
         for (int i=0; i<entry->series.size(); i++) {
             seriesCategoryModel->addCategoryEntry(entry->series.at(i), entry, SeriesRole);
         }
-        if (newlyAddedCategoryModel->indexOfFile(entry->filename) == -1) {
+        if (!newlyAddedCategoryModel->containsFile(entry->filename)) {
             newlyAddedCategoryModel->append(entry, CreatedRole);
         }
         publisherCategoryModel->addCategoryEntry(entry->publisher, entry);
@@ -228,6 +232,8 @@ QObject * BookListModel::contentModel() const
 
 void BookListModel::contentModelItemsInserted(QModelIndex index, int first, int last)
 {
+    PerformanceTimer timer("BookListModel::contentModelItemsInserted");
+    timer.setCount(last - first + 1);
     d->initializeSubModels(this);
     int newRow = d->entries.count();
     beginInsertRows(QModelIndex(), newRow, newRow + (last - first));
@@ -293,39 +299,38 @@ void BookListModel::contentModelItemsInserted(QModelIndex index, int first, int
         QMimeDatabase db;
         QString mimetype = db.mimeTypeForFile(entry->filename).name();
         if(mimetype == "application/x-cbz" || mimetype == "application/x-cbr" || mimetype == "application/vnd.comicbook+zip" || mimetype == "application/vnd.comicbook+rar") {
-            ArchiveBookModel* bookModel = new ArchiveBookModel(this);
-            bookModel->setFilename(entry->filename);
-
-            AdvancedComicBookFormat::Document* acbfDocument = qobject_cast<AdvancedComicBookFormat::Document*>(bookModel->acbfData());
-            if(acbfDocument) {
-                for(AdvancedComicBookFormat::Sequence* sequence : acbfDocument->metaData()->bookInfo()->sequence()) {
-                    if (!entry->series.contains(sequence->title())) {
-                        entry->series.append(sequence->title());
-                        entry->seriesNumbers.append(QString::number(sequence->number()));
-                        entry->seriesVolumes.append(QString::number(sequence->volume()));
+            // Only the metadata is needed here, so don't go through loading the whole book
+            ArchiveMetadataProbe probe(entry->filename, mimetype);
+            if(probe.probe() && probe.format() != ArchiveMetadataProbe::NoMetadata) {
+                for(const ArchiveMetadataProbe::Sequence& sequence : probe.sequences()) {
+                    if (!entry->series.contains(sequence.title)) {
+                        entry->series.append(sequence.title);
+                        entry->seriesNumbers.append(QString::number(sequence.number));
+                        entry->seriesVolumes.append(QString::number(sequence.volume));
                     } else {
-                        int series = entry->series.indexOf(sequence->title());
-                        entry->seriesNumbers.replace(series, QString::number(sequence->number()));
-                        entry->seriesVolumes.replace(series, QString::number(sequence->volume()));
+                        int series = entry->series.indexOf(sequence.title);
+                        entry->seriesNumbers.replace(series, QString::number(sequence.number));
+                        entry->seriesVolumes.replace(series, QString::number(sequence.volume));
                     }
-
-                }
-                for(AdvancedComicBookFormat::Author* author : acbfDocument->metaData()->bookInfo()->author()) {
-                    entry->author.append(author->displayName());
                 }
-                entry->description = acbfDocument->metaData()->bookInfo()->annotation("");
-                entry->genres = acbfDocument->metaData()->bookInfo()->genres();
-                entry->characters = acbfDocument->metaData()->bookInfo()->characters();
-                entry->keywords = acbfDocument->metaData()->bookInfo()->keywords("");
+                entry->author.append(probe.authors());
+                entry->description = probe.description();
+                entry->genres = probe.genres();
+                entry->characters = probe.characters();
+                entry->keywords = probe.keywords();
             }
 
+            // These match what ArchiveBookModel reports for the book: an author entry (empty when
+            // unknown), and without a title in the metadata, the title BookModel gets from the filename
             if (entry->author.isEmpty()) {
-                entry->author.append(bookModel->author());
+                entry->author.append(probe.authors().value(0));
             }
-            entry->title = bookModel->title();
-            entry->publisher = bookModel->publisher();
-            entry->totalPages = bookModel->pageCount();
-            bookModel->deleteLater();
+            entry->title = probe.title();
+            if (entry->title.isEmpty()) {
+                entry->title = entry->filename.split('/').last().left(entry->filename.lastIndexOf('.'));
+            }
+            entry->publisher = probe.publisher();
+            entry->totalPages = probe.pageCount();
         }
 
         d->addEntry(this, entry);
@@ -358,12 +363,10 @@ QObject * BookListModel::seriesCategoryModel() const
 
 QObject * BookListModel::seriesModelForEntry(QString fileName)
 {
-    for(BookEntry* entry : d->entries)
+    BookEntry* entry = d->entriesByFilename.value(fileName);
+    if(entry)
     {
-        if(entry->filename == fileName)
-        {
-            return d->seriesCategoryModel->leafModelForEntry(entry);
-        }
+        return d->seriesCategoryModel->leafModelForEntry(entry);
     }
     return nullptr;
 }
@@ -390,37 +393,35 @@ int BookListModel::count() const
 
 void BookListModel::setBookData(QString fileName, QString property, QString value)
 {
-    for(BookEntry* entry : d->entries)
+    BookEntry* entry = d->entriesByFilename.value(fileName);
+    if(entry)
     {
-        if(entry->filename == fileName)
+        // These change with every page turn, so let the journal write them out in batches
+        if(property == "totalPages")
         {
-            if(property == "totalPages")
-            {
-                entry->totalPages = value.toInt();
-                d->db->updateEntry(entry->filename, property, QVariant(value.toInt()));
-            }
-            else if(property == "currentPage")
-            {
-                entry->currentPage = value.toInt();
-                d->db->updateEntry(entry->filename, property, QVariant(value.toInt()));
-            }
-            else if(property == "rating")
-            {
-                entry->rating = value.toInt();
-                d->db->updateEntry(entry->filename, property, QVariant(value.toInt()));
-            }
-            else if(property == "tags")
-            {
-                entry->tags = value.split(",");
-                d->db->updateEntry(entry->filename, property, QVariant(value.split(",")));
-            }
-            else if(property == "comment") {
-                entry->comment = value;
-                d->db->updateEntry(entry->filename, property, QVariant(value));
-            }
-            emit entryDataUpdated(entry);
-            break;
+            entry->totalPages = value.toInt();
+            ReadingProgressJournal::instance()->setDatabaseValue(entry->filename, property, QVariant(value.toInt()));
+        }
+        else if(property == "currentPage")
+        {
+            entry->currentPage = value.toInt();
+            ReadingProgressJournal::instance()->setDatabaseValue(entry->filename, property, QVariant(value.toInt()));
+        }
+        else if(property == "rating")
+        {
+            entry->rating = value.toInt();
+            d->db->updateEntry(entry->filename, property, QVariant(value.toInt()));
         }
+        else if(property == "tags")
+        {
+            entry->tags = value.split(",");
+            d->db->updateEntry(entry->filename, property, QVariant(value.split(",")));
+        }
+        else if(property == "comment") {
+            entry->comment = value;
+            d->db->updateEntry(entry->filename, property, QVariant(value));
+        }
+        emit entryDataUpdated(entry);
     }
 }
 
@@ -431,15 +432,13 @@ void BookListModel::removeBook(QString fileName, bool deleteFile)
         job->start();
     }
 
-    for(BookEntry* entry : d->entries)
+    BookEntry* entry = d->entriesByFilename.take(fileName);
+    if(entry)
     {
-        if(entry->filename == fileName)
-        {
-            emit entryRemoved(entry);
-            d->db->removeEntry(entry);
-            delete entry;
-            break;
-        }
+        emit entryRemoved(entry);
+        d->db->removeEntry(entry);
+        d->entries.removeAll(entry);
+        delete entry;
     }
 }
 
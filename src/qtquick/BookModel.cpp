@@ -20,12 +20,12 @@
  */
 
 #include "BookModel.h"
+#include "DecodeScheduler.h"
+#include "ReadingProgressJournal.h"
 #include "qtquick_debug.h"
 
 #include <AcbfDocument.h>
 
-#include <KFileMetaData/UserMetaData>
-
 struct BookPage {
     BookPage() {}
     QString url;
@@ -48,6 +48,13 @@ public:
     AdvancedComicBookFormat::Document* acbfData;
     bool processing;
     QString processingDescription;
+
+    QString pageUrl(int page) const {
+        if(page > -1 && page < entries.count()) {
+            return entries.at(page)->url;
+        }
+        return QString();
+    }
 };
 
 BookModel::BookModel(QObject* parent)
@@ -58,6 +65,9 @@ BookModel::BookModel(QObject* parent)
 
 BookModel::~BookModel()
 {
+    // Make sure where the reader got to is stored when the book is closed
+    ReadingProgressJournal::instance()->flush();
+    DecodeScheduler::instance()->clearPriority(d->pageUrl(d->currentPage));
     delete d;
 }
 
@@ -122,6 +132,7 @@ void BookModel::removePage(int pageNumber)
 void BookModel::clearPages()
 {
     beginResetModel();
+    DecodeScheduler::instance()->clearPriority(d->pageUrl(d->currentPage));
     qDeleteAll(d->entries);
     d->entries.clear();
     emit pageCountChanged();
@@ -135,6 +146,9 @@ QString BookModel::filename() const
 
 void BookModel::setFilename(QString newFilename)
 {
+    if(!d->filename.isEmpty() && d->filename != newFilename) {
+        ReadingProgressJournal::instance()->flush();
+    }
     d->filename = newFilename;
     d->title = newFilename.split('/').last().left(newFilename.lastIndexOf('.'));
     emit filenameChanged();
@@ -189,9 +203,13 @@ void BookModel::setCurrentPage(int newCurrentPage, bool updateFilesystem)
 //     qCDebug(QTQUICK_LOG) << Q_FUNC_INFO << d->filename << newCurrentPage << updateFilesystem;
     if(updateFilesystem)
     {
-        KFileMetaData::UserMetaData data(d->filename);
-        data.setAttribute("peruse.currentPage", QString::number(newCurrentPage));
+        ReadingProgressJournal::instance()->setCurrentPageAttribute(d->filename, newCurrentPage);
+    }
+    // Make sure the page being read gets decoded ahead of anything else waiting
+    if(d->currentPage != newCurrentPage) {
+        DecodeScheduler::instance()->clearPriority(d->pageUrl(d->currentPage));
     }
+    DecodeScheduler::instance()->setPriority(d->pageUrl(newCurrentPage), DecodeScheduler::VisiblePage);
     d->currentPage = newCurrentPage;
     emit currentPageChanged();
 }
@@ -24,6 +24,10 @@
 #include <KFileMetaData/UserMetaData>
 #include <QDir>
 #include <QFileInfo>
+#include <QHash>
+#include <QSet>
+
+#include <algorithm>
 
 class CategoryEntriesModel::Private {
 public:
@@ -41,6 +45,35 @@ public:
     QList<BookEntry*> entries;
     QList<CategoryEntriesModel*> categoryModels;
 
+    // Lookups for the entries and categories above, so that finding a book or a category
+    // doesn't mean going through every one of them (which adds up quickly, as every
+    // change to a book is announced to every category model in the library)
+    QSet<BookEntry*> entrySet;
+    QHash<QString, BookEntry*> entriesByFilename;
+    QHash<QString, CategoryEntriesModel*> categoriesByName;
+    // Which of the categories in this model each entry was added to
+    QMultiHash<BookEntry*, CategoryEntriesModel*> categoriesByEntry;
+
+    void entryAdded(BookEntry* entry) {
+        entrySet.insert(entry);
+        if(!entriesByFilename.contains(entry->filename)) {
+            entriesByFilename.insert(entry->filename, entry);
+        }
+    }
+    void entryRemoved(BookEntry* entry) {
+        entrySet.remove(entry);
+        if(entriesByFilename.value(entry->filename) == entry) {
+            entriesByFilename.remove(entry->filename);
+            // In case the same file was added more than once
+            for(BookEntry* other : qAsConst(entries)) {
+                if(other->filename == entry->filename) {
+                    entriesByFilename.insert(other->filename, other);
+                    break;
+                }
+            }
+        }
+    }
+
     QObject* wrapBookEntry(const BookEntry* entry) {
         PropertyContainer* obj = new PropertyContainer("book", q);
         obj->setProperty("author", entry->author);
@@ -127,6 +160,7 @@ QHash<int, QByteArray> CategoryEntriesModel::roleNames() const
     roles[CommentRole] = "comment";
     roles[TagsRole] = "tags";
     roles[RatingRole] = "rating";
+    roles[SearchTextRole] = "searchText";
     return roles;
 }
 
@@ -142,6 +176,7 @@ QVariant CategoryEntriesModel::data(const QModelIndex& index, int role) const
             {
                 case Qt::DisplayRole:
                 case TitleRole:
+                case SearchTextRole:
                     result.setValue(model->name());
                     break;
                 case CategoryEntryCountRole:
@@ -227,6 +262,14 @@ QVariant CategoryEntriesModel::data(const QModelIndex& index, int role) const
                 case RatingRole:
                     result.setValue(entry->rating);
                     break;
+                case SearchTextRole:
+                {
+                    QStringList text{entry->title, entry->filetitle, entry->publisher, entry->comment};
+                    text << entry->author << entry->series << entry->genres << entry->characters
+                         << entry->keywords << entry->tags << entry->description;
+                    result.setValue(text.join(QLatin1Char('\n')));
+                    break;
+                }
                 default:
                     result.setValue(QString("Unknown role"));
                     break;
@@ -307,6 +350,7 @@ void CategoryEntriesModel::append(BookEntry* entry, Roles compareRole)
     }
     beginInsertRows(QModelIndex(), insertionIndex, insertionIndex);
     d->entries.insert(insertionIndex, entry);
+    d->entryAdded(entry);
     Q_EMIT countChanged();
     endInsertRows();
 }
@@ -322,6 +366,8 @@ void CategoryEntriesModel::clear()
     qDeleteAll(d->unwrappedBooks);
     d->unwrappedBooks.clear();
     d->entries.clear();
+    d->entrySet.clear();
+    d->entriesByFilename.clear();
     endResetModel();
 }
 
@@ -340,13 +386,21 @@ QObject * CategoryEntriesModel::leafModelForEntry(BookEntry* entry)
     QObject* model(nullptr);
     if(d->categoryModels.count() == 0)
     {
-        if(d->entries.contains(entry)) {
+        if(d->entrySet.contains(entry)) {
             model = this;
         }
     }
     else
     {
-        for(CategoryEntriesModel* testModel : d->categoryModels)
+        // Only the categories the entry was added to can contain it. It is usually only
+        // in the one, but if not, check them in the order they are shown in.
+        QList<CategoryEntriesModel*> candidates = d->categoriesByEntry.values(entry);
+        if(candidates.count() > 1) {
+            std::sort(candidates.begin(), candidates.end(), [this](CategoryEntriesModel* first, CategoryEntriesModel* second) {
+                return d->categoryModels.indexOf(first) < d->categoryModels.indexOf(second);
+            });
+        }
+        for(CategoryEntriesModel* testModel : qAsConst(candidates))
         {
             model = testModel->leafModelForEntry(entry);
             if(model) {
@@ -367,15 +421,9 @@ void CategoryEntriesModel::addCategoryEntry(const QString& categoryName, BookEnt
         if(splitPos > -1) {
             desiredCategory = categoryName.left(splitPos);
         }
-        CategoryEntriesModel* categoryModel = nullptr;
-        for(CategoryEntriesModel *existingModel : qAsConst(d->categoryModels))
-        {
-            if(QString::compare(existingModel->name(), desiredCategory, Qt::CaseInsensitive) == 0)
-            {
-                categoryModel = existingModel;
-                break;
-            }
-        }
+        // Category names are compared case insensitively
+        const QString categoryKey = desiredCategory.toCaseFolded();
+        CategoryEntriesModel* categoryModel = d->categoriesByName.value(categoryKey);
         if(!categoryModel)
         {
             categoryModel = new CategoryEntriesModel(this);
@@ -393,11 +441,15 @@ void CategoryEntriesModel::addCategoryEntry(const QString& categoryName, BookEnt
             }
             beginInsertRows(QModelIndex(), insertionIndex, insertionIndex);
             d->categoryModels.insert(insertionIndex, categoryModel);
+            d->categoriesByName.insert(categoryKey, categoryModel);
             endInsertRows();
         }
-        if (categoryModel->indexOfFile(entry->filename) == -1) {
+        if (!categoryModel->containsFile(entry->filename)) {
             categoryModel->append(entry, compareRole);
         }
+        if (!d->categoriesByEntry.contains(entry, categoryModel)) {
+            d->categoriesByEntry.insert(entry, categoryModel);
+        }
         if(splitPos > -1)
             categoryModel->addCategoryEntry(categoryName.mid(splitPos + 1), entry);
     }
@@ -432,22 +484,20 @@ BookEntry * CategoryEntriesModel::getBookEntry ( int index )
 
 int CategoryEntriesModel::indexOfFile(const QString& filename)
 {
-    int index = -1, i = 0;
-    if(QFile::exists(filename))
+    int index = -1;
+    BookEntry* entry = d->entriesByFilename.value(filename);
+    if(entry && QFile::exists(filename))
     {
-        for(BookEntry* entry : d->entries)
-        {
-            if(entry->filename == filename)
-            {
-                index = i;
-                break;
-            }
-            ++i;
-        }
+        index = d->entries.indexOf(entry);
     }
     return index;
 }
 
+bool CategoryEntriesModel::containsFile(const QString& filename) const
+{
+    return d->entriesByFilename.contains(filename);
+}
+
 bool CategoryEntriesModel::indexIsBook(int index)
 {
     if(index < d->categoryModels.count() || index >= rowCount()) {
@@ -524,6 +574,9 @@ QObject* CategoryEntriesModel::bookFromFile(const QString& filename)
 
 void CategoryEntriesModel::entryDataChanged(BookEntry* entry)
 {
+    if(!d->entrySet.contains(entry)) {
+        return;
+    }
     int entryIndex = d->entries.indexOf(entry) + d->categoryModels.count();
     QModelIndex changed = index(entryIndex);
     dataChanged(changed, changed);
@@ -531,11 +584,16 @@ void CategoryEntriesModel::entryDataChanged(BookEntry* entry)
 
 void CategoryEntriesModel::entryRemove(BookEntry* entry)
 {
+    d->categoriesByEntry.remove(entry);
+    if(!d->entrySet.contains(entry)) {
+        return;
+    }
     int listIndex = d->entries.indexOf(entry);
     if(listIndex > -1) {
         int entryIndex = listIndex + d->categoryModels.count();
         beginRemoveRows(QModelIndex(), entryIndex, entryIndex);
         d->entries.removeAll(entry);
+        d->entryRemoved(entry);
         endRemoveRows();
     }
 }
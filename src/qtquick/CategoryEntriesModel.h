@@ -108,7 +108,8 @@ public:
         RatingRole, /// For getting an int with the rating of the comic. This is gotten from KFileMeta and thus goes from 1-10 with 0 being no rating.
         GenreRole, /// For getting a stringlist with genres assigned to this book.
         KeywordRole, /// For getting a stringlist with keywords assigned to this book. Where tags are user assigned, keywords come from the book itself.
-        CharacterRole /// For getting a stringlist with names of characters in this book.
+        CharacterRole, /// For getting a stringlist with names of characters in this book.
+        SearchTextRole /// For getting a string with all the text the entry can be found by when searching (for categories, just the name).
     };
     Q_ENUMS(Roles)
 
@@ -198,6 +199,12 @@ public:
      * @param filename the filename associated with an entry object.
      */
     Q_INVOKABLE int indexOfFile(const QString &filename);
+    /**
+     * @return whether there is a book with the given filename directly in this model.
+     * Unlike indexOfFile(), this does not check whether the file exists on disk.
+     * @param filename the filename associated with an entry object.
+     */
+    bool containsFile(const QString &filename) const;
     /**
      * @return whether the entry is a bookentry or a category entry.
      * @param index the index of the entry.
@@ -231,7 +238,8 @@ public:
      */
     Q_SLOT void entryRemove(BookEntry* entry);
 
-    // This will iterate over all sub-models and find the model which contains the entry, or null if not found
+    // This will follow the sub-models which contain the entry down to the model with no further
+    // categories which contains it, or null if not found
     QObject* leafModelForEntry(BookEntry* entry);
 protected:
     /**
@@ -20,6 +20,11 @@
  */
 
 #include "ComicCoverImageProvider.h"
+#include "DecodeScheduler.h"
+#include "ImageTextureFactory.h"
+#include "PerformanceTimer.h"
+#include "SharedImageRequests.h"
+#include "ThumbnailStore.h"
 
 #include <KRar.h>
 #include <KZip>
@@ -30,20 +35,13 @@
 #include <QIcon>
 #include <QMimeDatabase>
 #include <QMutex>
-#include <QThreadPool>
 
 #include <qtquick_debug.h>
 
 class ComicCoverImageProvider::Private {
 public:
-    Private() {
-        // We'll just stick with a 100MiB cache for now - something to expose later maybe?
-        imageCache = new KImageCache("peruse-comiccover", 104857600);
-    }
-    ~Private() {
-        delete imageCache;
-    }
-    KImageCache* imageCache;
+    Private() {}
+    SharedImageRequests requests;
 };
 
 ComicCoverImageProvider::ComicCoverImageProvider()
@@ -60,13 +58,23 @@ ComicCoverImageProvider::~ComicCoverImageProvider()
 class ComicCoverResponse : public QQuickImageResponse
 {
     public:
-        ComicCoverResponse(const QString &id, const QSize &requestedSize, KImageCache* imageCache)
+        ComicCoverResponse(const QString &id, const QSize &requestedSize, SharedImageRequests* requests)
+            : m_requests(requests)
+            , m_key(SharedImageRequests::key(id, requestedSize))
         {
-            m_runnable = new ComicCoverRunnable(id, requestedSize, imageCache);
-            m_runnable->setAutoDelete(false);
-            connect(m_runnable, &ComicCoverRunnable::done, this, &ComicCoverResponse::handleDone, Qt::QueuedConnection);
-            connect(this, &QQuickImageResponse::finished, m_runnable, &QObject::deleteLater,  Qt::QueuedConnection);
-            QThreadPool::globalInstance()->start(m_runnable);
+            // If this image is already on its way to somebody else, just wait for that one
+            if (m_requests->attach(m_key, this, [this](QImage image){ handleDone(image); })) {
+                ComicCoverRunnable* runnable = new ComicCoverRunnable(id, requestedSize);
+                const QString key = m_key;
+                connect(runnable, &ComicCoverRunnable::done, runnable, [requests, key, runnable](QImage image){
+                    requests->finish(key, runnable, image);
+                }, Qt::DirectConnection);
+                m_requests->setWork(m_key, runnable, [runnable](){
+                    runnable->abort();
+                    DecodeScheduler::instance()->cancel(runnable);
+                });
+                DecodeScheduler::instance()->schedule(runnable, DecodeScheduler::Thumbnail);
+            }
         }
 
         void handleDone(QImage image) {
@@ -76,21 +84,25 @@ class ComicCoverResponse : public QQuickImageResponse
 
         QQuickTextureFactory *textureFactory() const override
         {
-            return QQuickTextureFactory::textureFactoryForImage(m_image);
+            return new ImageTextureFactory(m_image);
         }
 
         void cancel() override
         {
-            m_runnable->abort();
+            // If we were still waiting, nothing will finish the response for us
+            if (m_requests->detach(m_key, this)) {
+                Q_EMIT finished();
+            }
         }
 
-        ComicCoverRunnable* m_runnable{nullptr};
+        SharedImageRequests* m_requests{nullptr};
+        QString m_key;
         QImage m_image;
 };
 
 QQuickImageResponse * ComicCoverImageProvider::requestImageResponse(const QString& id, const QSize& requestedSize)
 {
-    ComicCoverResponse* response = new ComicCoverResponse(id, requestedSize, d->imageCache);
+    ComicCoverResponse* response = new ComicCoverResponse(id, requestedSize, &d->requests);
     return response;
 }
 
@@ -100,7 +112,6 @@ public:
     Private() {}
     QString id;
     QSize requestedSize;
-    KImageCache* imageCache;
 
     bool abort{false};
     QMutex abortMutex;
@@ -139,12 +150,11 @@ public:
     }
 };
 
-ComicCoverRunnable::ComicCoverRunnable(const QString& id, const QSize& requestedSize, KImageCache* imageCache)
+ComicCoverRunnable::ComicCoverRunnable(const QString& id, const QSize& requestedSize)
     : d(new Private)
 {
     d->id = id;
     d->requestedSize = requestedSize;
-    d->imageCache = imageCache;
 }
 
 ComicCoverRunnable::~ComicCoverRunnable()
@@ -160,14 +170,15 @@ void ComicCoverRunnable::abort()
 
 void ComicCoverRunnable::run()
 {
+    PerformanceTimer timer("ComicCoverRunnable::run");
     QSize ourSize(KIconLoader::SizeEnormous, KIconLoader::SizeEnormous);
     if(d->requestedSize.width() > 0 && d->requestedSize.height() > 0)
     {
         ourSize = d->requestedSize;
     }
 
-    QImage img;
-    if (!d->imageCache->findImage(d->id, &img)) {
+    QImage img = ThumbnailStore::instance()->find(d->id, ourSize);
+    if (img.isNull()) {
         KArchive* archive = nullptr;
         QMimeDatabase db;
         db.mimeTypeForFile(d->id, QMimeDatabase::MatchContent);
@@ -194,7 +205,9 @@ void ComicCoverRunnable::run()
                     const KArchiveFile *coverFile = static_cast<const KArchiveFile*>(cArchiveDir->entry(entries[0]));
                     if (!d->isAborted() && coverFile) {
                         bool success = img.loadFromData(coverFile->data());
-                        if(!d->isAborted() && !success) {
+                        if(!d->isAborted() && success) {
+                            img = ThumbnailStore::instance()->insert(d->id, ourSize, img);
+                        } else if(!d->isAborted()) {
                             QIcon oops = QIcon::fromTheme("unknown");
                             img = oops.pixmap(oops.availableSizes().last()).toImage();
                             qCDebug(QTQUICK_LOG) << "Failed to load image with id:" << d->id;
@@ -203,7 +216,7 @@ void ComicCoverRunnable::run()
                 }
             }
         }
-        d->imageCache->insertImage(d->id, img);
+        delete archive;
     }
-    Q_EMIT done(img.scaled(ourSize, Qt::KeepAspectRatio, Qt::SmoothTransformation));
+    Q_EMIT done(ImageTextureFactory::prepareImage(img.scaled(ourSize, Qt::KeepAspectRatio, Qt::SmoothTransformation)));
 }
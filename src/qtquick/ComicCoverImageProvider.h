@@ -25,7 +25,6 @@
 #include <QQuickAsyncImageProvider>
 #include <QRunnable>
 
-#include <kimagecache.h>
 #include <memory.h>
 
 /**
@@ -45,7 +44,8 @@ public:
      * \brief Get an image.
      * 
      * @param id The source of the image.
-     * @param requestedSize The required size of the final image, unused.
+     * @param requestedSize The required size of the final image. The cover is stored in the
+     * shared ThumbnailStore in the bucket for this size.
      * 
      * @return an asynchronous image response
      */
@@ -61,7 +61,7 @@ private:
 class ComicCoverRunnable : public QObject, public QRunnable {
     Q_OBJECT;
 public:
-    explicit ComicCoverRunnable(const QString &id, const QSize &requestedSize, KImageCache* imageCache);
+    explicit ComicCoverRunnable(const QString &id, const QSize &requestedSize);
     virtual ~ComicCoverRunnable();
 
     void run() override;
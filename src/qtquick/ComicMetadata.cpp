@@ -0,0 +1,248 @@
+/*
+ * Copyright (C) 2026 Dan Leinir Turthra Jensen <admin@leinir.dk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ComicMetadata.h"
+
+#include "AcbfBookinfo.h"
+
+#include <QXmlStreamReader>
+
+#include <qtquick_debug.h>
+
+namespace {
+    QStringList splitList(const QString& text)
+    {
+        QStringList items;
+        const QStringList parts = text.split(QLatin1Char(','), Qt::SkipEmptyParts);
+        for(const QString& part : parts) {
+            items.append(part.trimmed());
+        }
+        return items;
+    }
+
+    void addGenre(QStringList& genres, const QString& genre)
+    {
+        if(!genres.contains(genre)) {
+            genres.append(genre);
+        }
+    }
+
+    bool finishReading(const QXmlStreamReader& xmlReader, const char* format, const QString& documentName)
+    {
+        if(xmlReader.hasError()) {
+            qCWarning(QTQUICK_LOG) << "Failed to read" << format << "document" << documentName << "at token" << xmlReader.name() << "(" << xmlReader.lineNumber() << ":" << xmlReader.columnNumber() << ") The reported error was:" << xmlReader.errorString();
+        }
+        return !xmlReader.hasError();
+    }
+}
+
+bool ComicMetadata::readComicInfo(QIODevice* device, const QString& documentName)
+{
+    QXmlStreamReader xmlReader(device);
+    if(!xmlReader.readNextStartElement() || xmlReader.name() != QStringLiteral("ComicInfo")) {
+        return false;
+    }
+    const QStringList availableGenres = AdvancedComicBookFormat::BookInfo::availableGenres();
+    // ComicInfo only has two kinds of series, which are each spread across several elements
+    Sequence series;
+    Sequence alternateSeries;
+    QStringList publishers;
+    while(xmlReader.readNextStartElement()) {
+        const QStringRef name = xmlReader.name();
+        if(name == QStringLiteral("Title")) {
+            title = xmlReader.readElementText();
+        } else if(name == QStringLiteral("Summary")) {
+            annotation = xmlReader.readElementText().split(QStringLiteral("\n\n"));
+        } else if(name == QStringLiteral("Notes")) {
+            notes = xmlReader.readElementText();
+        } else if(name == QStringLiteral("Tags")) {
+            tags.append(xmlReader.readElementText().split(QLatin1Char(',')));
+        } else if(name == QStringLiteral("PageCount")) {
+            pageCount = xmlReader.readElementText();
+        } else if(name == QStringLiteral("ScanInformation")) {
+            scanInformation = xmlReader.readElementText();
+        } else if(name == QStringLiteral("Series")) {
+            series.title = xmlReader.readElementText();
+        } else if(name == QStringLiteral("Number")) {
+            series.number = xmlReader.readElementText().toInt();
+        } else if(name == QStringLiteral("Volume")) {
+            series.volume = xmlReader.readElementText().toInt();
+        } else if(name == QStringLiteral("AlternateSeries")) {
+            alternateSeries.title = xmlReader.readElementText();
+        } else if(name == QStringLiteral("AlternateNumber")) {
+            alternateSeries.number = xmlReader.readElementText().toInt();
+        } else if(name == QStringLiteral("AlternateVolume")) {
+            alternateSeries.volume = xmlReader.readElementText().toInt();
+        } else if(name == QStringLiteral("Year") || name == QStringLiteral("Month") || name == QStringLiteral("Day")) {
+            // The publishing date is not used yet
+            xmlReader.skipCurrentElement();
+        } else if(name == QStringLiteral("Publisher") || name == QStringLiteral("Imprint")) {
+            publishers.append(xmlReader.readElementText());
+        } else if(name == QStringLiteral("Genre")) {
+            const QString key = xmlReader.readElementText();
+            const QString genreKey = key.toLower().replace(QLatin1Char(' '), QLatin1Char('_'));
+            if(availableGenres.contains(genreKey)) {
+                addGenre(genres, genreKey);
+            } else {
+                // There must always be a genre in a proper acbf file...
+                addGenre(genres, QStringLiteral("other"));
+                keywords.append(key);
+            }
+        } else if(name == QStringLiteral("LanguageISO")) {
+            languages.append(xmlReader.readElementText());
+        } else if(name == QStringLiteral("Web")) {
+            source = xmlReader.readElementText();
+        } else if(name == QStringLiteral("Format")) {
+            keywords.append(xmlReader.readElementText());
+        } else if(name == QStringLiteral("Manga")) {
+            if(xmlReader.readElementText() == QStringLiteral("Yes")) {
+                addGenre(genres, QStringLiteral("manga"));
+                rightToLeft = true;
+            }
+        } else if(name == QStringLiteral("AgeRating")) {
+            contentRatings.append(xmlReader.readElementText());
+        } else if(name == QStringLiteral("Writer") || name == QStringLiteral("Plotter") || name == QStringLiteral("Scripter")
+            || name == QStringLiteral("Penciller") || name == QStringLiteral("Inker") || name == QStringLiteral("Colorist")
+            || name == QStringLiteral("CoverArtist") || name == QStringLiteral("Letterer") || name == QStringLiteral("Editor")
+            || name == QStringLiteral("Other")) {
+            // Plotters and scripters are writers as far as ACBF is concerned
+            const QString activity = (name == QStringLiteral("Plotter") || name == QStringLiteral("Scripter")) ? QStringLiteral("Writer") : name.toString();
+            const QStringList people = splitList(xmlReader.readElementText());
+            for(const QString& person : people) {
+                authors.append(Author{activity, person});
+            }
+        } else if(name == QStringLiteral("Characters")) {
+            characters.append(splitList(xmlReader.readElementText()));
+        } else if(name == QStringLiteral("Teams") || name == QStringLiteral("Locations")
+            || name == QStringLiteral("StoryArc") || name == QStringLiteral("SeriesGroup")) {
+            // Throw the rest into the keywords
+            keywords.append(splitList(xmlReader.readElementText()));
+        } else if(name == QStringLiteral("Pages")) {
+            hasPageList = true;
+            while(xmlReader.readNextStartElement()) {
+                if(xmlReader.name() == QStringLiteral("Page")) {
+                    Page page;
+                    page.image = xmlReader.attributes().value(QStringLiteral("Image")).toInt();
+                    page.type = xmlReader.attributes().value(QStringLiteral("Type")).toString();
+                    page.bookmark = xmlReader.attributes().value(QStringLiteral("Bookmark")).toString();
+                    pages.append(page);
+                }
+                xmlReader.skipCurrentElement();
+            }
+        } else {
+            qCDebug(QTQUICK_LOG) << Q_FUNC_INFO << "currently unsupported subsection:" << name;
+            xmlReader.skipCurrentElement();
+        }
+    }
+    if(!series.title.isEmpty() && series.number > -1) {
+        sequences.append(series);
+    }
+    if(!alternateSeries.title.isEmpty() && alternateSeries.number > -1) {
+        sequences.append(alternateSeries);
+    }
+    publisher = publishers.join(QStringLiteral(", "));
+    return finishReading(xmlReader, "ComicInfo", documentName);
+}
+
+bool ComicMetadata::readCoMet(QIODevice* device, const QString& documentName)
+{
+    QXmlStreamReader xmlReader(device);
+    if(!xmlReader.readNextStartElement() || xmlReader.name() != QStringLiteral("comet")) {
+        return false;
+    }
+    const QStringList availableGenres = AdvancedComicBookFormat::BookInfo::availableGenres();
+    Sequence series;
+    while(xmlReader.readNextStartElement()) {
+        const QStringRef name = xmlReader.name();
+        if(name == QStringLiteral("title")) {
+            title = xmlReader.readElementText();
+        } else if(name == QStringLiteral("description")) {
+            annotation = xmlReader.readElementText().split(QStringLiteral("\n\n"));
+        } else if(name == QStringLiteral("pages")) {
+            pageCount = xmlReader.readElementText();
+        } else if(name == QStringLiteral("lastMark")) {
+            lastMark = xmlReader.readElementText();
+        } else if(name == QStringLiteral("series")) {
+            series.title = xmlReader.readElementText();
+        } else if(name == QStringLiteral("issue")) {
+            series.number = xmlReader.readElementText().toInt();
+        } else if(name == QStringLiteral("volume")) {
+            series.volume = xmlReader.readElementText().toInt();
+        } else if(name == QStringLiteral("date")) {
+            publishDate = QDate::fromString(xmlReader.readElementText(), Qt::ISODate);
+        } else if(name == QStringLiteral("publisher")) {
+            publisher = xmlReader.readElementText();
+        } else if(name == QStringLiteral("rights")) {
+            license = xmlReader.readElementText();
+        } else if(name == QStringLiteral("identifier")) {
+            isbn = xmlReader.readElementText();
+        } else if(name == QStringLiteral("genre")) {
+            const QString key = xmlReader.readElementText();
+            const QString genreKey = key.toLower().replace(QLatin1Char(' '), QLatin1Char('_'));
+            if(availableGenres.contains(genreKey)) {
+                addGenre(genres, genreKey);
+            } else {
+                keywords.append(key);
+            }
+        } else if(name == QStringLiteral("language")) {
+            languages.append(xmlReader.readElementText());
+        } else if(name == QStringLiteral("isVersionOf")) {
+            source = xmlReader.readElementText();
+        } else if(name == QStringLiteral("format")) {
+            keywords.append(xmlReader.readElementText());
+        } else if(name == QStringLiteral("readingDirection")) {
+            if(xmlReader.readElementText() == QStringLiteral("rtl")) {
+                rightToLeft = true;
+            }
+        } else if(name == QStringLiteral("rating")) {
+            contentRatings.append(xmlReader.readElementText());
+        } else if(name == QStringLiteral("writer") || name == QStringLiteral("creator")) {
+            authors.append(Author{QStringLiteral("Writer"), xmlReader.readElementText()});
+        } else if(name == QStringLiteral("penciller")) {
+            authors.append(Author{QStringLiteral("Penciller"), xmlReader.readElementText()});
+        } else if(name == QStringLiteral("editor")) {
+            authors.append(Author{QStringLiteral("Editor"), xmlReader.readElementText()});
+        } else if(name == QStringLiteral("coverDesigner")) {
+            authors.append(Author{QStringLiteral("CoverArtist"), xmlReader.readElementText()});
+        } else if(name == QStringLiteral("letterer")) {
+            authors.append(Author{QStringLiteral("Letterer"), xmlReader.readElementText()});
+        } else if(name == QStringLiteral("inker")) {
+            authors.append(Author{QStringLiteral("Inker"), xmlReader.readElementText()});
+        } else if(name == QStringLiteral("colorist")) {
+            authors.append(Author{QStringLiteral("Colorist"), xmlReader.readElementText()});
+        } else if(name == QStringLiteral("character")) {
+            characters.append(xmlReader.readElementText());
+        } else if(name == QStringLiteral("coverImage")) {
+            coverImage = xmlReader.readElementText();
+        } else {
+            qCDebug(QTQUICK_LOG) << Q_FUNC_INFO << "currently unsupported subsection:" << name;
+            xmlReader.skipCurrentElement();
+        }
+    }
+    if(!series.title.isEmpty() && series.number > -1) {
+        sequences.append(series);
+    }
+    if(genres.isEmpty()) {
+        // There must always be a genre in a proper acbf file...
+        genres.append(QStringLiteral("other"));
+    }
+    return finishReading(xmlReader, "CoMet", documentName);
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2026 Dan Leinir Turthra Jensen <admin@leinir.dk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COMICMETADATA_H
+#define COMICMETADATA_H
+
+#include <QDate>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+class QIODevice;
+/**
+ * \brief The information in a ComicInfo.xml or CoMet document
+ *
+ * Both the library (through ArchiveMetadataProbe) and ArchiveBookModel (which
+ * builds an ACBF document out of it) read these documents, and this is the one
+ * place which knows how they are laid out. The documents are read in a single
+ * pass with a QXmlStreamReader, and their contents mapped onto ACBF concepts as
+ * they are read: genres are turned into ACBF genre keys (with anything unknown
+ * kept as a keyword instead), the various creator roles into ACBF activities,
+ * and the series into sequences.
+ *
+ * Information which does not belong in an ACBF document (such as the notes and
+ * tags in ComicInfo.xml, or the reading position in CoMet) is kept separately,
+ * for ArchiveBookModel to write into the file's extended attributes.
+ */
+struct ComicMetadata
+{
+    struct Author {
+        // The ACBF activity of the author (Writer, Penciller and so on)
+        QString activity;
+        QString name;
+    };
+    struct Sequence {
+        QString title;
+        int number{-1};
+        int volume{0};
+    };
+    // An entry in the page list of a ComicInfo.xml document
+    struct Page {
+        // The index of the image in the archive's sorted list of images
+        int image{0};
+        QString type;
+        QString bookmark;
+    };
+
+    QString title;
+    QStringList annotation;
+    QList<Sequence> sequences;
+    QString publisher;
+    QStringList genres;
+    QStringList keywords;
+    QList<Author> authors;
+    QStringList characters;
+    QStringList languages;
+    QString source;
+    bool rightToLeft{false};
+    QStringList contentRatings;
+    QDate publishDate;
+    QString license;
+    QString isbn;
+
+    // File level information, which does not go into the ACBF document
+    QString notes;
+    QStringList tags;
+    QString scanInformation;
+    QString pageCount;
+    QString lastMark;
+
+    // ComicInfo.xml lists its pages, and hasPageList tells an empty list apart from no list
+    bool hasPageList{false};
+    QList<Page> pages;
+    // CoMet only names the cover, and every other image in the archive is a page
+    QString coverImage;
+
+    /**
+     * \brief Read a ComicInfo.xml document.
+     * @param device The device to read the document from, opened for reading
+     * @param documentName The name of the document, used when reporting errors
+     * @return False if this is not a ComicInfo.xml document, or it could not be read
+     */
+    bool readComicInfo(QIODevice* device, const QString& documentName);
+    /**
+     * \brief Read a CoMet document, https://www.denvog.com/comet/comet-specification/
+     * @param device The device to read the document from, opened for reading
+     * @param documentName The name of the document, used when reporting errors
+     * @return False if this is not a CoMet document, or it could not be read
+     */
+    bool readCoMet(QIODevice* device, const QString& documentName);
+};
+
+#endif//COMICMETADATA_H
@@ -0,0 +1,201 @@
+/*
+ * Copyright (C) 2026 Dan Leinir Turthra Jensen <admin@leinir.dk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "DecodeScheduler.h"
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+#include <QVector>
+
+class DecodeScheduler::Private {
+public:
+    Private()
+        : queues(PriorityCount)
+        , running(PriorityCount, 0)
+    {
+        threadCount = qMax(2, QThread::idealThreadCount());
+        pool.setMaxThreadCount(threadCount);
+    }
+
+    struct Task {
+        QRunnable* runnable;
+        QString key;
+    };
+
+    // Runs a task on the pool, and tells the scheduler when it is done so the next one can start
+    class Job : public QRunnable {
+    public:
+        Job(Private* scheduler, QRunnable* runnable, int priority)
+            : scheduler(scheduler)
+            , runnable(runnable)
+            , priority(priority)
+        {
+            setAutoDelete(true);
+        }
+        void run() override {
+            runnable->run();
+            if (runnable->autoDelete()) {
+                delete runnable;
+            }
+            scheduler->finished(priority);
+        }
+    private:
+        Private* scheduler;
+        QRunnable* runnable;
+        int priority;
+    };
+
+    QMutex mutex;
+    QThreadPool pool;
+    int threadCount{2};
+    QVector<QList<Task>> queues;
+    QVector<int> running;
+    QHash<QString, Priority> keyPriorities;
+
+    // How many threads each priority may use at the same time
+    int limit(int priority) const {
+        switch (priority) {
+            case VisiblePage:
+                return threadCount;
+            case NearbyPage:
+                return threadCount - 1;
+            default:
+                return qMax(1, threadCount / 2);
+        }
+    }
+
+    // Start as much queued work as the limits allow. Call with the mutex held.
+    void dispatch() {
+        int total{0};
+        for (int count : qAsConst(running)) {
+            total += count;
+        }
+        // Between them, everything but the visible pages has to leave a thread free, or a burst of
+        // nearby pages and thumbnails could take every thread just before the visible page arrives
+        int background{total - running[VisiblePage]};
+        for (int priority = 0; priority < PriorityCount && total < threadCount; ++priority) {
+            QList<Task>& queue = queues[priority];
+            while (!queue.isEmpty() && running[priority] < limit(priority) && total < threadCount
+                    && (priority == VisiblePage || background < threadCount - 1)) {
+                const Task task = (priority == Thumbnail) ? queue.takeLast() : queue.takeFirst();
+                ++running[priority];
+                ++total;
+                if (priority != VisiblePage) {
+                    ++background;
+                }
+                pool.start(new Job(this, task.runnable, priority));
+            }
+        }
+    }
+
+    void finished(int priority) {
+        QMutexLocker locker(&mutex);
+        --running[priority];
+        dispatch();
+    }
+};
+
+DecodeScheduler* DecodeScheduler::instance()
+{
+    // Requests come in on the image loading threads, so this needs to be safe to create from any of them
+    static DecodeScheduler scheduler;
+    return &scheduler;
+}
+
+DecodeScheduler::DecodeScheduler()
+    : d(new Private)
+{
+}
+
+DecodeScheduler::~DecodeScheduler()
+{
+    {
+        QMutexLocker locker(&d->mutex);
+        for (QList<Private::Task>& queue : d->queues) {
+            for (const Private::Task& task : qAsConst(queue)) {
+                if (task.runnable->autoDelete()) {
+                    delete task.runnable;
+                }
+            }
+            queue.clear();
+        }
+    }
+    d->pool.waitForDone();
+    delete d;
+}
+
+void DecodeScheduler::schedule(QRunnable* runnable, Priority priority, const QString& key)
+{
+    QMutexLocker locker(&d->mutex);
+    if (!key.isEmpty()) {
+        priority = d->keyPriorities.value(key, priority);
+    }
+    d->queues[priority].append(Private::Task{runnable, key});
+    d->dispatch();
+}
+
+bool DecodeScheduler::cancel(QRunnable* runnable)
+{
+    QMutexLocker locker(&d->mutex);
+    for (QList<Private::Task>& queue : d->queues) {
+        for (int i = 0; i < queue.count(); ++i) {
+            if (queue.at(i).runnable == runnable) {
+                queue.removeAt(i);
+                if (runnable->autoDelete()) {
+                    delete runnable;
+                }
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void DecodeScheduler::setPriority(const QString& key, Priority priority)
+{
+    if (key.isEmpty()) {
+        return;
+    }
+    QMutexLocker locker(&d->mutex);
+    d->keyPriorities.insert(key, priority);
+    for (int queuePriority = 0; queuePriority < PriorityCount; ++queuePriority) {
+        if (queuePriority == priority) {
+            continue;
+        }
+        QList<Private::Task>& queue = d->queues[queuePriority];
+        for (int i = queue.count() - 1; i >= 0; --i) {
+            if (queue.at(i).key == key) {
+                d->queues[priority].append(queue.takeAt(i));
+            }
+        }
+    }
+    d->dispatch();
+}
+
+void DecodeScheduler::clearPriority(const QString& key)
+{
+    QMutexLocker locker(&d->mutex);
+    d->keyPriorities.remove(key);
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2026 Dan Leinir Turthra Jensen <admin@leinir.dk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef DECODESCHEDULER_H
+#define DECODESCHEDULER_H
+
+#include <QString>
+
+class QRunnable;
+/**
+ * \brief Runs the image decoding work for all the image providers, most important first
+ *
+ * The image providers used to all put their work in the global thread pool, in the order it
+ * was requested, which meant that while the bookshelf was busy loading the covers of a large
+ * library, the page the user had just turned to would be waiting behind all of those.
+ *
+ * The scheduler has its own thread pool, and a queue for each priority. Work is always taken
+ * from the most important queue which has any waiting, and each priority has a limit to how
+ * many threads it may use at once. On top of that, all the work for anything but the visible
+ * pages shares one thread less than the pool has, so there is always a thread left for the page
+ * being read.
+ * Thumbnails are started newest first, as the most recently requested ones are the ones the
+ * user is most likely to be looking at (the older ones having often been scrolled past, in
+ * which case they get cancelled anyway).
+ */
+class DecodeScheduler
+{
+public:
+    enum Priority {
+        VisiblePage = 0, ///< The page (or part of a page) the reader is looking at
+        NearbyPage, ///< Pages loaded ahead of time, and other pages of the open book
+        Thumbnail, ///< Covers and previews for the library
+        PriorityCount
+    };
+
+    /**
+     * @return The scheduler shared by everything in this process.
+     */
+    static DecodeScheduler* instance();
+    ~DecodeScheduler();
+
+    /**
+     * \brief Queue some work to be run on the scheduler's threads.
+     * The scheduler takes ownership of runnables which are set to auto delete, the same
+     * way QThreadPool does.
+     * @param runnable The work to run
+     * @param priority How important the work is
+     * @param key An optional key to identify the work by (such as the url of the image), used
+     * by setPriority(const QString&, Priority)
+     */
+    void schedule(QRunnable* runnable, Priority priority, const QString& key = QString());
+    /**
+     * \brief Remove work from the queue, if it has not been started yet.
+     * @param runnable The work to cancel
+     * @return True if the work was removed from the queue (and so will never run). If the
+     * runnable is set to auto delete, it has been deleted.
+     */
+    bool cancel(QRunnable* runnable);
+    /**
+     * \brief Change the priority of work with the given key.
+     * This changes the priority of any work already queued with the key, as well as any
+     * scheduled with it later on, until clearPriority() is called for the key.
+     * @param key The key the work was (or will be) scheduled with
+     * @param priority The new priority for the work
+     */
+    void setPriority(const QString& key, Priority priority);
+    /**
+     * \brief Stop overriding the priority of work with the given key.
+     * Work already queued keeps its current priority.
+     * @param key The key previously passed to setPriority()
+     */
+    void clearPriority(const QString& key);
+private:
+    DecodeScheduler();
+    class Private;
+    Private* d;
+};
+
+#endif//DECODESCHEDULER_H
@@ -20,19 +20,76 @@
  */
 
 #include "FilterProxy.h"
+#include "LibrarySearchIndex.h"
+#include "PerformanceTimer.h"
 
+#include <QElapsedTimer>
 #include <QTimer>
 
 class FilterProxy::Private {
 public:
     Private() {
-        updateTimer.setInterval(1);
+        updateTimer.setInterval(minimumUpdateInterval);
         updateTimer.setSingleShot(true);
     }
     bool filterBoolean{false};
     bool filterIntEnabled{false};
     int filterInt{INT_MIN}; // INT_MIN to ensure that we actually hold true to that thing where we said we'd change the filterIntEnabled thing as well...
     QTimer updateTimer;
+    // When changes keep arriving (such as while the library is being filled), the
+    // interval is doubled for each update, up to the maximum, and when things have
+    // quietened down, it drops back to the minimum again.
+    static constexpr int minimumUpdateInterval{1};
+    static constexpr int maximumUpdateInterval{250};
+    QElapsedTimer sinceLastUpdate;
+
+    void scheduleUpdate() {
+        // Don't restart a running timer, or a steady stream of changes would
+        // hold off the update indefinitely
+        if(updateTimer.isActive()) {
+            return;
+        }
+        if(sinceLastUpdate.isValid() && sinceLastUpdate.elapsed() < updateTimer.interval() + maximumUpdateInterval) {
+            updateTimer.setInterval(qMin(updateTimer.interval() * 2, int(maximumUpdateInterval)));
+        } else {
+            updateTimer.setInterval(minimumUpdateInterval);
+        }
+        updateTimer.start();
+    }
+
+    bool fullTextSearch{false};
+    bool searchIndexBuilt{false};
+    int searchIndexRole{-1};
+    LibrarySearchIndex searchIndex;
+    QList<QMetaObject::Connection> sourceConnections;
+
+    QString searchText(const QAbstractItemModel* model, int row, int role) const {
+        const QVariant value = model->data(model->index(row, 0), role);
+        if(value.type() == QVariant::StringList) {
+            return value.toStringList().join(QLatin1Char('\n'));
+        }
+        return value.toString();
+    }
+    QStringList searchTexts(const QAbstractItemModel* model, int first, int last, int role) const {
+        QStringList texts;
+        texts.reserve(last - first + 1);
+        for(int row = first; row <= last; ++row) {
+            texts.append(searchText(model, row, role));
+        }
+        return texts;
+    }
+    void buildSearchIndex(const QAbstractItemModel* model, int role) {
+        // Match all the rows in one go once they are all in, rather than one at a time
+        const QString query = searchIndex.query();
+        searchIndex.setQuery(QString());
+        searchIndex.clear();
+        if(model && model->rowCount() > 0) {
+            searchIndex.insertRows(0, searchTexts(model, 0, model->rowCount() - 1, role));
+        }
+        searchIndex.setQuery(query);
+        searchIndexRole = role;
+        searchIndexBuilt = true;
+    }
 };
 
 FilterProxy::FilterProxy(QObject* parent)
@@ -40,14 +97,25 @@ FilterProxy::FilterProxy(QObject* parent)
     , d(new Private)
 {
     connect(&d->updateTimer, &QTimer::timeout, this, [this](){
+        d->sinceLastUpdate.start();
         Q_EMIT countChanged();
-        sort(0);
+        // Once sorted, the dynamic sorting keeps the rows in order by itself, placing
+        // new and changed rows using a binary search, so we only need a full sort if
+        // we are not sorted yet
+        if (sortColumn() != 0 || sortOrder() != Qt::AscendingOrder) {
+            sort(0);
+        }
     } );
-    connect(this, &QAbstractItemModel::rowsInserted, this, [this](){ d->updateTimer.start(); });
-    connect(this, &QAbstractItemModel::rowsRemoved, this, [this](){ d->updateTimer.start(); });
-    connect(this, &QAbstractItemModel::dataChanged, this, [this](){ d->updateTimer.start(); });
-    connect(this, &QAbstractItemModel::layoutChanged, this, [this](){ d->updateTimer.start(); });
-    connect(this, &QAbstractItemModel::modelReset, this, [this](){ d->updateTimer.start(); });
+    connect(this, &QAbstractItemModel::rowsInserted, this, [this](){ d->scheduleUpdate(); });
+    connect(this, &QAbstractItemModel::rowsRemoved, this, [this](){ d->scheduleUpdate(); });
+    connect(this, &QAbstractItemModel::dataChanged, this, [this](const QModelIndex&, const QModelIndex&, const QVector<int>& roles){
+        // Changes which neither affect the order nor which rows are shown don't need an update
+        if (roles.isEmpty() || roles.contains(sortRole()) || roles.contains(filterRole())) {
+            d->scheduleUpdate();
+        }
+    });
+    connect(this, &QAbstractItemModel::layoutChanged, this, [this](){ d->scheduleUpdate(); });
+    connect(this, &QAbstractItemModel::modelReset, this, [this](){ d->scheduleUpdate(); });
     setDynamicSortFilter(true);
 }
 
@@ -55,8 +123,16 @@ FilterProxy::~FilterProxy() = default;
 
 void FilterProxy::setFilterString(const QString &string)
 {
+    PerformanceTimer timer("FilterProxy::setFilterString");
+    if (d->fullTextSearch) {
+        if (!string.isEmpty() && (!d->searchIndexBuilt || d->searchIndexRole != filterRole())) {
+            d->buildSearchIndex(sourceModel(), filterRole());
+        }
+        d->searchIndex.setQuery(string);
+    }
     QSortFilterProxyModel::setFilterFixedString(string);
     QSortFilterProxyModel::setFilterCaseSensitivity(Qt::CaseInsensitive);
+    timer.setCount(sourceModel() ? sourceModel()->rowCount() : 0);
     emit filterStringChanged();
 }
 
@@ -78,6 +154,10 @@ bool FilterProxy::filterBoolean() const
 
 bool FilterProxy::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const
 {
+    if (d->fullTextSearch) {
+        // The index only covers the top level rows, and everything matches an empty query
+        return sourceParent.isValid() || d->searchIndex.matches(sourceRow);
+    }
     QModelIndex index = sourceModel()->index(sourceRow, 0, sourceParent);
     if (d->filterBoolean) {
         return sourceModel()->data(index, filterRole()).toBool();
@@ -93,6 +173,73 @@ int FilterProxy::count() const
     return rowCount();
 }
 
+void FilterProxy::setFullTextSearch(const bool& value)
+{
+    if (d->fullTextSearch != value) {
+        d->fullTextSearch = value;
+        if (value) {
+            d->searchIndex.setQuery(filterString());
+            if (!filterString().isEmpty()) {
+                d->buildSearchIndex(sourceModel(), filterRole());
+            }
+        } else {
+            d->searchIndex.setQuery(QString());
+            d->searchIndex.clear();
+            d->searchIndexBuilt = false;
+        }
+        invalidateFilter();
+        Q_EMIT fullTextSearchChanged();
+    }
+}
+
+bool FilterProxy::fullTextSearch() const
+{
+    return d->fullTextSearch;
+}
+
+void FilterProxy::setSourceModel(QAbstractItemModel* sourceModel)
+{
+    for (const QMetaObject::Connection& connection : qAsConst(d->sourceConnections)) {
+        disconnect(connection);
+    }
+    d->sourceConnections.clear();
+    d->searchIndex.clear();
+    d->searchIndexBuilt = false;
+    if (sourceModel) {
+        // These must be connected before QSortFilterProxyModel connects to the same signals,
+        // so the search index is up to date by the time the changed rows are filtered
+        d->sourceConnections << connect(sourceModel, &QAbstractItemModel::rowsInserted, this, [this](const QModelIndex& parent, int first, int last){
+            if (d->searchIndexBuilt && !parent.isValid()) {
+                d->searchIndex.insertRows(first, d->searchTexts(this->sourceModel(), first, last, d->searchIndexRole));
+            }
+        });
+        d->sourceConnections << connect(sourceModel, &QAbstractItemModel::rowsRemoved, this, [this](const QModelIndex& parent, int first, int last){
+            if (d->searchIndexBuilt && !parent.isValid()) {
+                d->searchIndex.removeRows(first, last);
+            }
+        });
+        d->sourceConnections << connect(sourceModel, &QAbstractItemModel::dataChanged, this, [this](const QModelIndex& topLeft, const QModelIndex& bottomRight, const QVector<int>& roles){
+            if (d->searchIndexBuilt && !topLeft.parent().isValid() && (roles.isEmpty() || roles.contains(d->searchIndexRole))) {
+                for (int row = topLeft.row(); row <= bottomRight.row(); ++row) {
+                    d->searchIndex.updateRow(row, d->searchText(this->sourceModel(), row, d->searchIndexRole));
+                }
+            }
+        });
+        auto rebuild = [this](){
+            if (d->searchIndexBuilt) {
+                d->buildSearchIndex(this->sourceModel(), d->searchIndexRole);
+            }
+        };
+        d->sourceConnections << connect(sourceModel, &QAbstractItemModel::rowsMoved, this, rebuild);
+        d->sourceConnections << connect(sourceModel, &QAbstractItemModel::layoutChanged, this, rebuild);
+        d->sourceConnections << connect(sourceModel, &QAbstractItemModel::modelReset, this, rebuild);
+        if (d->fullTextSearch && !filterString().isEmpty()) {
+            d->buildSearchIndex(sourceModel, filterRole());
+        }
+    }
+    QSortFilterProxyModel::setSourceModel(sourceModel);
+}
+
 int FilterProxy::filterInt() const
 {
     return d->filterInt;
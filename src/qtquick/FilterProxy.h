@@ -42,6 +42,15 @@ class FilterProxy : public QSortFilterProxyModel
      */
     Q_PROPERTY(bool filterIntEnabled READ filterIntEnabled WRITE setFilterIntEnabled NOTIFY filterIntEnabledChanged)
     Q_PROPERTY(int count READ count NOTIFY countChanged)
+    /**
+     * When this is true, the filter string is used as a full text search query rather than
+     * as a substring to look for. The text in the filter role of every row is indexed (see
+     * LibrarySearchIndex) the first time the filter string is set, and the index is kept up
+     * to date as the source model changes, so filtering does not need to look at every row
+     * each time the search changes. The filter boolean and integer options do not apply
+     * in this mode.
+     */
+    Q_PROPERTY(bool fullTextSearch READ fullTextSearch WRITE setFullTextSearch NOTIFY fullTextSearchChanged)
 public:
     explicit FilterProxy(QObject* parent = nullptr);
     ~FilterProxy() override;
@@ -65,6 +74,12 @@ public:
     int count() const;
     Q_SIGNAL void countChanged();
 
+    void setFullTextSearch(const bool &value);
+    bool fullTextSearch() const;
+    Q_SIGNAL void fullTextSearchChanged();
+
+    void setSourceModel(QAbstractItemModel* sourceModel) override;
+
     Q_INVOKABLE int sourceIndex(const int &filterIndex);
 protected:
     bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
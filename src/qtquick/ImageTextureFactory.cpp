@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2026 Dan Leinir Turthra Jensen <admin@leinir.dk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ImageTextureFactory.h"
+
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QQuickWindow>
+#include <QSGRendererInterface>
+#include <QSGTexture>
+
+namespace {
+    // Scanned black and white pages are often saved as colour images, and the compression
+    // leaves them ever so slightly off grey, which nobody can see, so allow a little of that
+    const int greyTolerance{4};
+
+    bool isNearlyGrey(const QImage& image)
+    {
+        for (int y = 0; y < image.height(); ++y) {
+            const QRgb* line = reinterpret_cast<const QRgb*>(image.constScanLine(y));
+            for (int x = 0; x < image.width(); ++x) {
+                const int red = qRed(line[x]);
+                const int green = qGreen(line[x]);
+                const int blue = qBlue(line[x]);
+                if (qAbs(red - green) > greyTolerance || qAbs(green - blue) > greyTolerance || qAbs(red - blue) > greyTolerance) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    // Whether the window renders using an OpenGL context which has luminance textures
+    bool supportsLuminanceTextures(QQuickWindow* window)
+    {
+        if (!window || !window->rendererInterface() || window->rendererInterface()->graphicsApi() != QSGRendererInterface::OpenGL) {
+            return false;
+        }
+        QOpenGLContext* context = window->openglContext();
+        return context && (context->isOpenGLES() || context->format().profile() != QSurfaceFormat::CoreProfile);
+    }
+
+    class LuminanceTexture : public QSGTexture
+    {
+    public:
+        explicit LuminanceTexture(const QImage& image)
+            : m_image(image)
+            , m_size(image.size())
+        {}
+        ~LuminanceTexture() override {
+            if (m_textureId && QOpenGLContext::currentContext()) {
+                QOpenGLContext::currentContext()->functions()->glDeleteTextures(1, &m_textureId);
+            }
+        }
+
+        int textureId() const override {
+            return int(m_textureId);
+        }
+        QSize textureSize() const override {
+            return m_size;
+        }
+        bool hasAlphaChannel() const override {
+            return false;
+        }
+        bool hasMipmaps() const override {
+            return false;
+        }
+
+        void bind() override {
+            QOpenGLFunctions* functions = QOpenGLContext::currentContext()->functions();
+            if (m_textureId) {
+                functions->glBindTexture(GL_TEXTURE_2D, m_textureId);
+                updateBindOptions();
+                return;
+            }
+            functions->glGenTextures(1, &m_textureId);
+            functions->glBindTexture(GL_TEXTURE_2D, m_textureId);
+            updateBindOptions(true);
+            // QImage lines are aligned to four bytes, which is also the default unpack alignment
+            functions->glTexImage2D(GL_TEXTURE_2D, 0, GL_LUMINANCE, m_size.width(), m_size.height(), 0, GL_LUMINANCE, GL_UNSIGNED_BYTE, m_image.constBits());
+            // Once it's on the graphics card, we don't need our own copy any longer
+            m_image = QImage();
+        }
+    private:
+        QImage m_image;
+        QSize m_size;
+        GLuint m_textureId{0};
+    };
+}
+
+class ImageTextureFactory::Private {
+public:
+    Private() {}
+    QImage image;
+};
+
+ImageTextureFactory::ImageTextureFactory(const QImage& image)
+    : QQuickTextureFactory()
+    , d(new Private)
+{
+    d->image = image;
+}
+
+ImageTextureFactory::~ImageTextureFactory()
+{
+    delete d;
+}
+
+QImage ImageTextureFactory::prepareImage(const QImage& image, bool allowGreyscale)
+{
+    if (image.isNull()) {
+        return image;
+    }
+    if (allowGreyscale) {
+        if (image.format() == QImage::Format_Grayscale8) {
+            return image;
+        }
+        if (image.format() == QImage::Format_Grayscale16 || (image.depth() <= 8 && !image.hasAlphaChannel() && image.isGrayscale())) {
+            return image.convertToFormat(QImage::Format_Grayscale8);
+        }
+    }
+    QImage prepared = image;
+    if (prepared.format() != QImage::Format_RGB32 && prepared.format() != QImage::Format_ARGB32_Premultiplied) {
+        prepared = prepared.convertToFormat(prepared.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32);
+    }
+    if (allowGreyscale && prepared.format() == QImage::Format_RGB32 && isNearlyGrey(prepared)) {
+        prepared = prepared.convertToFormat(QImage::Format_Grayscale8);
+    }
+    return prepared;
+}
+
+QSGTexture* ImageTextureFactory::createTexture(QQuickWindow* window) const
+{
+    if (d->image.format() == QImage::Format_Grayscale8) {
+        if (supportsLuminanceTextures(window)) {
+            return new LuminanceTexture(d->image);
+        }
+        return window->createTextureFromImage(d->image.convertToFormat(QImage::Format_RGB32), QQuickWindow::TextureCanUseAtlas);
+    }
+    return window->createTextureFromImage(d->image, QQuickWindow::TextureCanUseAtlas);
+}
+
+int ImageTextureFactory::textureByteCount() const
+{
+    return int(d->image.sizeInBytes());
+}
+
+QSize ImageTextureFactory::textureSize() const
+{
+    return d->image.size();
+}
+
+QImage ImageTextureFactory::image() const
+{
+    return d->image;
+}
@@ -0,0 +1,67 @@
+/*
+ * Copyright (C) 2026 Dan Leinir Turthra Jensen <admin@leinir.dk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef IMAGETEXTUREFACTORY_H
+#define IMAGETEXTUREFACTORY_H
+
+#include <QQuickTextureFactory>
+
+/**
+ * \brief A texture factory for images which have already been prepared for uploading
+ *
+ * The scene graph can only upload 32 bit images as they are. Anything else (images with
+ * an alpha channel which is not premultiplied, indexed or greyscale images, or the 24 bit
+ * images some decoders produce) is converted on the render thread, just before the upload,
+ * which holds up the frame it happens in. Use prepareImage() on the thread which loads the
+ * image, and this factory in the image response, to do that work up front instead.
+ *
+ * Greyscale images (for example black and white manga pages) can also be kept as 8 bit
+ * images, which when rendering using OpenGL are uploaded as luminance textures, using
+ * a quarter of the memory a full colour texture would. If the scene graph is not able to
+ * use those, they are converted to 32 bit images when the texture is created.
+ */
+class ImageTextureFactory : public QQuickTextureFactory
+{
+public:
+    explicit ImageTextureFactory(const QImage& image);
+    ~ImageTextureFactory() override;
+
+    /**
+     * \brief Convert an image to the format it will be uploaded in.
+     * This is intended to be called on the thread which loaded the image.
+     * @param image The image to convert
+     * @param allowGreyscale Whether to return an 8 bit greyscale image if the image does not
+     * contain any colour. This checks every pixel of full colour images, so is best used for
+     * images which are likely to be black and white (such as pages).
+     * @return The image, converted if needed
+     */
+    static QImage prepareImage(const QImage& image, bool allowGreyscale = false);
+
+    QSGTexture* createTexture(QQuickWindow* window) const override;
+    int textureByteCount() const override;
+    QSize textureSize() const override;
+    QImage image() const override;
+private:
+    class Private;
+    Private* d;
+};
+
+#endif//IMAGETEXTUREFACTORY_H
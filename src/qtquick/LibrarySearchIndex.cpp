@@ -0,0 +1,369 @@
+/*
+ * Copyright (C) 2026 Dan Leinir Turthra Jensen <admin@leinir.dk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "LibrarySearchIndex.h"
+
+#include <QMap>
+#include <QSet>
+#include <QStringView>
+#include <QVector>
+
+namespace {
+    // Words shorter than this have to match exactly, as too many words are
+    // a single typo away from them for that to be useful
+    const int minimumFuzzyLength{4};
+
+    QStringList tokenize(const QString& text)
+    {
+        QStringList tokens;
+        // Decompose accented letters, so the accents can be dropped below
+        const QString decomposed = text.normalized(QString::NormalizationForm_KD);
+        QString current;
+        for(const QChar& character : decomposed) {
+            if(character.isLetterOrNumber()) {
+                current.append(character.toLower());
+            } else if(character.isMark()) {
+                continue;
+            } else if(!current.isEmpty()) {
+                tokens.append(current);
+                current.clear();
+            }
+        }
+        if(!current.isEmpty()) {
+            tokens.append(current);
+        }
+        return tokens;
+    }
+
+    // Whether the two strings are the same, or differ by a single inserted, removed,
+    // replaced or transposed character
+    bool oneEditApart(QStringView first, QStringView second)
+    {
+        const int firstLength = first.size();
+        const int secondLength = second.size();
+        if(qAbs(firstLength - secondLength) > 1) {
+            return false;
+        }
+        int common = 0;
+        while(common < firstLength && common < secondLength && first.at(common) == second.at(common)) {
+            ++common;
+        }
+        if(common == firstLength && common == secondLength) {
+            return true;
+        }
+        if(firstLength == secondLength) {
+            if(first.mid(common + 1) == second.mid(common + 1)) {
+                return true;
+            }
+            return common + 1 < firstLength
+                && first.at(common) == second.at(common + 1)
+                && first.at(common + 1) == second.at(common)
+                && first.mid(common + 2) == second.mid(common + 2);
+        }
+        if(firstLength > secondLength) {
+            return first.mid(common + 1) == second.mid(common);
+        }
+        return first.mid(common) == second.mid(common + 1);
+    }
+
+    // Whether the start of the token is (almost) the term
+    bool fuzzyMatch(const QString& token, const QString& term)
+    {
+        for(int length = term.size() - 1; length <= term.size() + 1; ++length) {
+            if(length <= token.size() && oneEditApart(QStringView(token).left(length), QStringView(term))) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Whether the word matches the search term. Rows matched all at once when the query changes
+    // and rows matched one at a time as they come in both go through this, so a row matches the
+    // same way whichever happened first.
+    bool tokenMatches(const QString& token, const QString& term, bool fuzzy)
+    {
+        if(token.startsWith(term)) {
+            return true;
+        }
+        // Assume the first letter is right, and look for a typo in the rest
+        return fuzzy && token.at(0) == term.at(0) && fuzzyMatch(token, term);
+    }
+}
+
+class LibrarySearchIndex::Private
+{
+public:
+    // All the words in the index, sorted, so prefix lookups are a range of it
+    QMap<QString, int> vocabulary;
+    QStringList tokens;
+    // For each word, the documents containing it
+    QVector<QVector<int>> postings;
+    // For each document, the words in it
+    QVector<QVector<int>> documents;
+    int deadCount{0};
+    // The document for each row
+    QVector<int> rows;
+
+    QString query;
+    QStringList terms;
+    QVector<bool> fuzzyTerms;
+    // Whether each row matches the query, only valid while there are terms
+    QVector<bool> matches;
+
+    int tokenId(const QString& token) {
+        auto it = vocabulary.constFind(token);
+        if(it != vocabulary.constEnd()) {
+            return it.value();
+        }
+        const int id = tokens.count();
+        vocabulary.insert(token, id);
+        tokens.append(token);
+        postings.append(QVector<int>());
+        return id;
+    }
+
+    int addDocument(const QString& text) {
+        const int documentId = documents.count();
+        const QStringList words = tokenize(text);
+        QVector<int> tokenIds;
+        tokenIds.reserve(words.count());
+        QSet<int> seen;
+        for(const QString& word : words) {
+            const int id = tokenId(word);
+            if(!seen.contains(id)) {
+                seen.insert(id);
+                tokenIds.append(id);
+                postings[id].append(documentId);
+            }
+        }
+        documents.append(tokenIds);
+        return documentId;
+    }
+
+    void removeDocument(int documentId) {
+        // Removing the document from the postings would mean going through the posting
+        // lists of common words for every removed row, so just leave it there until the
+        // next compaction. Nothing refers to it through the rows any more.
+        Q_UNUSED(documentId)
+        ++deadCount;
+    }
+
+    void compactIfNeeded() {
+        if(deadCount < 1024 || deadCount < rows.count()) {
+            return;
+        }
+        QVector<QVector<int>> newDocuments;
+        newDocuments.reserve(rows.count());
+        for(QVector<int>& posting : postings) {
+            posting.clear();
+        }
+        for(int row = 0; row < rows.count(); ++row) {
+            const QVector<int>& tokenIds = documents.at(rows.at(row));
+            for(int id : tokenIds) {
+                postings[id].append(row);
+            }
+            newDocuments.append(tokenIds);
+            rows[row] = row;
+        }
+        documents = newDocuments;
+        deadCount = 0;
+    }
+
+    bool documentMatches(int documentId) const {
+        const QVector<int>& tokenIds = documents.at(documentId);
+        for(int term = 0; term < terms.count(); ++term) {
+            bool found = false;
+            for(int id : tokenIds) {
+                const QString& token = tokens.at(id);
+                if(tokenMatches(token, terms.at(term), fuzzyTerms.at(term))) {
+                    found = true;
+                    break;
+                }
+            }
+            if(!found) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Terms are only matched fuzzily when no word in the index starts with them, which new rows can change
+    bool fuzzyTermsOutdated() const {
+        for(int term = 0; term < terms.count(); ++term) {
+            if(fuzzyTerms.at(term)) {
+                auto it = vocabulary.lowerBound(terms.at(term));
+                if(it != vocabulary.end() && it.key().startsWith(terms.at(term))) {
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    void updateMatches() {
+        matches.clear();
+        fuzzyTerms.clear();
+        if(terms.isEmpty()) {
+            return;
+        }
+        // The number of terms matched so far by each document. A document only counts
+        // as matching a term if it also matched all the ones before it.
+        QVector<int> hits(documents.count(), 0);
+        for(int term = 0; term < terms.count(); ++term) {
+            const QString& termText = terms.at(term);
+            QVector<int> tokenIds;
+            for(auto it = vocabulary.lowerBound(termText); it != vocabulary.end() && it.key().startsWith(termText); ++it) {
+                tokenIds.append(it.value());
+            }
+            bool fuzzy = false;
+            if(tokenIds.isEmpty() && termText.size() >= minimumFuzzyLength) {
+                // Only words with the same first letter can match, so only look at those
+                fuzzy = true;
+                const QString firstLetter = termText.left(1);
+                for(auto it = vocabulary.lowerBound(firstLetter); it != vocabulary.end() && it.key().startsWith(firstLetter); ++it) {
+                    if(tokenMatches(it.key(), termText, fuzzy)) {
+                        tokenIds.append(it.value());
+                    }
+                }
+            }
+            fuzzyTerms.append(fuzzy);
+            for(int id : qAsConst(tokenIds)) {
+                for(int documentId : postings.at(id)) {
+                    if(hits.at(documentId) == term) {
+                        hits[documentId] = term + 1;
+                    }
+                }
+            }
+        }
+        matches.resize(rows.count());
+        for(int row = 0; row < rows.count(); ++row) {
+            matches[row] = (hits.at(rows.at(row)) == terms.count());
+        }
+    }
+};
+
+LibrarySearchIndex::LibrarySearchIndex()
+    : d(new Private)
+{
+}
+
+LibrarySearchIndex::~LibrarySearchIndex()
+{
+    delete d;
+}
+
+void LibrarySearchIndex::clear()
+{
+    d->vocabulary.clear();
+    d->tokens.clear();
+    d->postings.clear();
+    d->documents.clear();
+    d->deadCount = 0;
+    d->rows.clear();
+    d->matches.clear();
+}
+
+int LibrarySearchIndex::rowCount() const
+{
+    return d->rows.count();
+}
+
+void LibrarySearchIndex::insertRows(int row, const QStringList& texts)
+{
+    row = qBound(0, row, d->rows.count());
+    QVector<int> newDocuments;
+    newDocuments.reserve(texts.count());
+    for(const QString& text : texts) {
+        newDocuments.append(d->addDocument(text));
+    }
+    d->rows.insert(row, newDocuments.count(), -1);
+    for(int i = 0; i < newDocuments.count(); ++i) {
+        d->rows[row + i] = newDocuments.at(i);
+    }
+    if(d->terms.isEmpty()) {
+        return;
+    }
+    if(d->fuzzyTermsOutdated()) {
+        // Match everything again, as it would be if the rows had been there before the query
+        d->updateMatches();
+    } else {
+        d->matches.insert(row, newDocuments.count(), false);
+        for(int i = 0; i < newDocuments.count(); ++i) {
+            d->matches[row + i] = d->documentMatches(newDocuments.at(i));
+        }
+    }
+}
+
+void LibrarySearchIndex::removeRows(int first, int last)
+{
+    first = qMax(0, first);
+    last = qMin(last, d->rows.count() - 1);
+    if(last < first) {
+        return;
+    }
+    for(int row = first; row <= last; ++row) {
+        d->removeDocument(d->rows.at(row));
+    }
+    d->rows.remove(first, last - first + 1);
+    if(!d->terms.isEmpty()) {
+        d->matches.remove(first, last - first + 1);
+    }
+    d->compactIfNeeded();
+}
+
+void LibrarySearchIndex::updateRow(int row, const QString& text)
+{
+    if(row < 0 || row >= d->rows.count()) {
+        return;
+    }
+    d->removeDocument(d->rows.at(row));
+    const int documentId = d->addDocument(text);
+    d->rows[row] = documentId;
+    if(!d->terms.isEmpty()) {
+        if(d->fuzzyTermsOutdated()) {
+            d->updateMatches();
+        } else {
+            d->matches[row] = d->documentMatches(documentId);
+        }
+    }
+    d->compactIfNeeded();
+}
+
+void LibrarySearchIndex::setQuery(const QString& query)
+{
+    d->query = query;
+    d->terms = tokenize(query);
+    d->terms.removeDuplicates();
+    d->updateMatches();
+}
+
+QString LibrarySearchIndex::query() const
+{
+    return d->query;
+}
+
+bool LibrarySearchIndex::matches(int row) const
+{
+    if(d->terms.isEmpty()) {
+        return true;
+    }
+    return row > -1 && row < d->matches.count() && d->matches.at(row);
+}
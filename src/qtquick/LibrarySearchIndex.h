@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2026 Dan Leinir Turthra Jensen <admin@leinir.dk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef LIBRARYSEARCHINDEX_H
+#define LIBRARYSEARCHINDEX_H
+
+#include <QString>
+#include <QStringList>
+
+/**
+ * \brief An in-memory full text index over the rows of a list model
+ *
+ * Each row is represented by a piece of text, which is split into words (lower
+ * cased, and with accents removed). Searching matches every word of the query
+ * against the start of the words of each row, so searching for "sand" finds
+ * "Sandman", and all the words in the query must be found for a row to match.
+ * Words of four or more letters which do not start any word in the index are
+ * instead matched allowing for a single typo (after the first letter).
+ *
+ * The index is kept in the order of the rows, and rows can be inserted, removed
+ * and updated as the model changes. Rows added while a query is set are matched
+ * against it straight away, so the result of the query is always up to date.
+ */
+class LibrarySearchIndex
+{
+public:
+    explicit LibrarySearchIndex();
+    ~LibrarySearchIndex();
+
+    /**
+     * \brief Remove all rows from the index (the query is kept).
+     */
+    void clear();
+    /**
+     * @return The number of rows in the index
+     */
+    int rowCount() const;
+    /**
+     * \brief Insert rows into the index.
+     * @param row The position of the first of the new rows
+     * @param texts The searchable text for each of the new rows
+     */
+    void insertRows(int row, const QStringList& texts);
+    /**
+     * \brief Remove rows from the index.
+     * @param first The first row to remove
+     * @param last The last row to remove
+     */
+    void removeRows(int first, int last);
+    /**
+     * \brief Replace the text of a row.
+     * @param row The row to update
+     * @param text The new searchable text for the row
+     */
+    void updateRow(int row, const QString& text);
+
+    /**
+     * \brief Set the text to search for.
+     * @param query The search string. If this is empty (or contains no words), every row matches.
+     */
+    void setQuery(const QString& query);
+    /**
+     * @return The query currently being searched for
+     */
+    QString query() const;
+    /**
+     * @param row The row to check
+     * @return Whether the row matches the current query
+     */
+    bool matches(int row) const;
+private:
+    class Private;
+    Private* d;
+};
+
+#endif//LIBRARYSEARCHINDEX_H
@@ -20,6 +20,11 @@
  */
 
 #include "PDFCoverImageProvider.h"
+#include "DecodeScheduler.h"
+#include "ImageTextureFactory.h"
+#include "PerformanceTimer.h"
+#include "SharedImageRequests.h"
+#include "ThumbnailStore.h"
 
 #include <kiconloader.h>
 
@@ -30,8 +35,13 @@
 #include <QMutex>
 #include <QProcess>
 #include <QStandardPaths>
-#include <QThreadPool>
-#include <QUrl>
+#include <QTemporaryFile>
+
+#ifdef HAVE_POPPLER
+#include <poppler-qt5.h>
+
+#include <memory>
+#endif
 
 #include <qtquick_debug.h>
 
@@ -47,6 +57,7 @@ public:
         thumbDir.cd(subpath);
     }
     QDir thumbDir;
+    SharedImageRequests requests;
 };
 
 PDFCoverImageProvider::PDFCoverImageProvider()
@@ -63,13 +74,23 @@ PDFCoverImageProvider::~PDFCoverImageProvider()
 class PDFCoverResponse : public QQuickImageResponse
 {
     public:
-        PDFCoverResponse(const QString &id, const QSize &requestedSize, const QDir& thumbDir)
+        PDFCoverResponse(const QString &id, const QSize &requestedSize, const QDir& thumbDir, SharedImageRequests* requests)
+            : m_requests(requests)
+            , m_key(SharedImageRequests::key(id, requestedSize))
         {
-            m_runnable = new PDFCoverRunnable(id, requestedSize, thumbDir);
-            m_runnable->setAutoDelete(false);
-            connect(m_runnable, &PDFCoverRunnable::done, this, &PDFCoverResponse::handleDone, Qt::QueuedConnection);
-            connect(this, &QQuickImageResponse::finished, m_runnable, &QObject::deleteLater,  Qt::QueuedConnection);
-            QThreadPool::globalInstance()->start(m_runnable);
+            // If this image is already on its way to somebody else, just wait for that one
+            if (m_requests->attach(m_key, this, [this](QImage image){ handleDone(image); })) {
+                PDFCoverRunnable* runnable = new PDFCoverRunnable(id, requestedSize, thumbDir);
+                const QString key = m_key;
+                connect(runnable, &PDFCoverRunnable::done, runnable, [requests, key, runnable](QImage image){
+                    requests->finish(key, runnable, image);
+                }, Qt::DirectConnection);
+                m_requests->setWork(m_key, runnable, [runnable](){
+                    runnable->abort();
+                    DecodeScheduler::instance()->cancel(runnable);
+                });
+                DecodeScheduler::instance()->schedule(runnable, DecodeScheduler::Thumbnail);
+            }
         }
 
         void handleDone(QImage image) {
@@ -79,21 +100,25 @@ class PDFCoverResponse : public QQuickImageResponse
 
         QQuickTextureFactory *textureFactory() const override
         {
-            return QQuickTextureFactory::textureFactoryForImage(m_image);
+            return new ImageTextureFactory(m_image);
         }
 
         void cancel() override
         {
-            m_runnable->abort();
+            // If we were still waiting, nothing will finish the response for us
+            if (m_requests->detach(m_key, this)) {
+                Q_EMIT finished();
+            }
         }
 
-        PDFCoverRunnable* m_runnable{nullptr};
+        SharedImageRequests* m_requests{nullptr};
+        QString m_key;
         QImage m_image;
 };
 
 QQuickImageResponse * PDFCoverImageProvider::requestImageResponse(const QString& id, const QSize& requestedSize)
 {
-    PDFCoverResponse* response = new PDFCoverResponse(id, requestedSize, d->thumbDir);
+    PDFCoverResponse* response = new PDFCoverResponse(id, requestedSize, d->thumbDir, &d->requests);
     return response;
 }
 
@@ -131,54 +156,83 @@ void PDFCoverRunnable::abort()
 
 void PDFCoverRunnable::run()
 {
-    QImage img;
-
+    PerformanceTimer timer("PDFCoverRunnable::run");
     QSize ourSize(KIconLoader::SizeEnormous, KIconLoader::SizeEnormous);
     if(d->requestedSize.width() > 0 && d->requestedSize.height() > 0)
     {
         ourSize = d->requestedSize;
     }
 
+    QImage img = ThumbnailStore::instance()->find(d->id, ourSize);
     QMimeDatabase db;
-    db.mimeTypeForFile(d->id, QMimeDatabase::MatchContent);
-    const QMimeType mime = db.mimeTypeForFile(d->id, QMimeDatabase::MatchContent);
-    if(!d->isAborted() && mime.inherits("application/pdf")) {
+    if(!d->isAborted() && img.isNull() && db.mimeTypeForFile(d->id).inherits("application/pdf")) {
+        // then we've not already generated a thumbnail, try to make one...
+        const int bucketSize = ThumbnailStore::bucketSize(ourSize);
+#ifdef HAVE_POPPLER
+        // Render the first page straight at the size it is stored in, in this process
+        std::unique_ptr<Poppler::Document> document(Poppler::Document::load(d->id));
+        if(!d->isAborted() && document && !document->isLocked()) {
+            document->setRenderHint(Poppler::Document::Antialiasing);
+            document->setRenderHint(Poppler::Document::TextAntialiasing);
+            std::unique_ptr<Poppler::Page> page(document->page(0));
+            if(!d->isAborted() && page) {
+                // The page size is in points, of which there are 72 to the inch
+                const QSizeF pageSize = page->pageSizeF();
+                if(!pageSize.isEmpty()) {
+                    const qreal scale = bucketSize / qMax(pageSize.width(), pageSize.height());
+                    img = page->renderToImage(72.0 * scale, 72.0 * scale);
+                }
+            }
+        }
+#else
+        // Ghostscript needs somewhere to put the page, which we read back in and then get rid of.
+        // Requests for the same file in different sizes can run at the same time, so each gets its own.
+        QTemporaryFile pageFile(d->thumbDir.absoluteFilePath(QStringLiteral("XXXXXX.png")));
+        const bool havePageFile = pageFile.open();
+        if(!havePageFile) {
+            qCDebug(QTQUICK_LOG) << "Failed to create a temporary file for rendering" << d->id << pageFile.errorString();
+        }
+        pageFile.close();
+        const QString outFile = pageFile.fileName();
         //-sOutputFile=FILENAME.png FILENAME
-        QString outFile = QString("%1/%2.png").arg(d->thumbDir.absolutePath()).arg(QUrl(d->id).toString().replace("/", "-").replace(":", "-"));
-        if(!d->isAborted() && !QFile::exists(outFile)) {
-            // then we've not already generated a thumbnail, try to make one...
-            QStringList args;
-            args << "-sPageList=1" << "-dLastPage=1" << "-dSAFER" << "-dBATCH" << "-dNOPAUSE" << "-dQUIET" << "-sDEVICE=png16m" << "-dGraphicsAlphaBits=4" << "-r150";
-            args << QString("-sOutputFile=%1").arg(outFile) << d->id;
-            QString gsApp;
-            #ifdef Q_OS_WIN
-                #ifdef __MINGW32__
-                    gsApp = qApp->applicationDirPath() + "/gsc.exe";
+        QStringList args;
+        args << "-sPageList=1" << "-dLastPage=1" << "-dSAFER" << "-dBATCH" << "-dNOPAUSE" << "-dQUIET" << "-sDEVICE=png16m" << "-dGraphicsAlphaBits=4" << "-r150";
+        args << QString("-sOutputFile=%1").arg(outFile) << d->id;
+        QString gsApp;
+        #ifdef Q_OS_WIN
+            #ifdef __MINGW32__
+                gsApp = qApp->applicationDirPath() + "/gsc.exe";
+            #else
+                gsApp = qApp->applicationDirPath();
+                #ifdef Q_OS_WIN64
+                    gsApp += "/gswin64c.exe";
                 #else
-                    gsApp = qApp->applicationDirPath();
-                    #ifdef Q_OS_WIN64
-                        gsApp += "/gswin64c.exe";
-                    #else
-                        gsApp += "/gswin32c.exe";
-                    #endif
+                    gsApp += "/gswin32c.exe";
                 #endif
-            #else
-                gsApp = "gs";
             #endif
+        #else
+            gsApp = "gs";
+        #endif
+        if(!d->isAborted() && havePageFile) {
             d->thumbnailer.start(gsApp, args);
             d->thumbnailer.waitForFinished();
+            if(!d->isAborted()) {
+                img.load(outFile);
+            }
         }
-        bool success = false;
-        // Now, does it exist this time?
-        if(!d->isAborted() && QFile::exists(outFile)) {
-            success = img.load(outFile);
-        }
-        if(!d->isAborted() && !success) {
+#endif
+        if(!d->isAborted() && !img.isNull()) {
+            img = ThumbnailStore::instance()->insert(d->id, ourSize, img);
+        } else if(!d->isAborted()) {
             QIcon oops = QIcon::fromTheme("application-pdf");
             img = oops.pixmap(oops.availableSizes().last()).toImage();
-            qCDebug(QTQUICK_LOG) << "Failed to load image with id" << d->id << "from thumbnail file" << outFile;
+            qCDebug(QTQUICK_LOG) << "Failed to make a thumbnail for" << d->id;
         }
     }
 
-    Q_EMIT done(img.scaled(ourSize, Qt::KeepAspectRatio, Qt::SmoothTransformation));
+    // Only scale if we have to (the stored thumbnails are already close to the right size)
+    if(img.width() > ourSize.width() || img.height() > ourSize.height()) {
+        img = img.scaled(ourSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    Q_EMIT done(ImageTextureFactory::prepareImage(img));
 }
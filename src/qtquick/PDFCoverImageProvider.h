@@ -27,6 +27,11 @@
 
 /**
  * \brief Get file previews of PDF files, where the thumbnailer isn't available...
+ *
+ * When built with Poppler, the first page is rendered in process, straight at the
+ * size it is stored in. Otherwise Ghostscript is run to render it. Either way, the
+ * result is kept in the shared ThumbnailStore, so it is only made again when the
+ * file changes.
  * 
  * NOTE: As this task is potentially heavy, make sure to mark any Image using this provider asynchronous
  */
@@ -40,7 +45,7 @@ public:
      * \brief Get an image.
      * 
      * @param id The source of the image.
-     * @param requestedSize The required size of the final image, unused.
+     * @param requestedSize The required size of the final image. The cover is rendered to fit inside this.
      * 
      * @return an asynchronous image response
      */
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2026 Dan Leinir Turthra Jensen <admin@leinir.dk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "PerformanceTimer.h"
+
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <qtquick_timing.h>
+
+PerformanceTimer::PerformanceTimer(const char* measurement)
+    : m_measurement(measurement)
+{
+    if (QTQUICK_TIMING_LOG().isDebugEnabled()) {
+        m_timer.start();
+    }
+}
+
+PerformanceTimer::~PerformanceTimer()
+{
+    if (!m_timer.isValid()) {
+        return;
+    }
+    QJsonObject result;
+    result.insert(QStringLiteral("measurement"), QString::fromLatin1(m_measurement));
+    result.insert(QStringLiteral("msecs"), double(m_timer.nsecsElapsed()) / 1000000.0);
+    result.insert(QStringLiteral("timestamp"), QDateTime::currentMSecsSinceEpoch());
+    if (m_count > -1) {
+        result.insert(QStringLiteral("count"), m_count);
+    }
+    qCDebug(QTQUICK_TIMING_LOG).noquote() << QString::fromUtf8(QJsonDocument(result).toJson(QJsonDocument::Compact));
+}
+
+void PerformanceTimer::setCount(qint64 count)
+{
+    m_count = count;
+}
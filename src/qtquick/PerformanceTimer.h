@@ -0,0 +1,69 @@
+/*
+ * Copyright (C) 2026 Dan Leinir Turthra Jensen <admin@leinir.dk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef PERFORMANCETIMER_H
+#define PERFORMANCETIMER_H
+
+#include <QElapsedTimer>
+
+/**
+ * \brief Measures how long a piece of work takes, and writes the result out as JSON
+ *
+ * Put one of these at the start of the work to measure, and the time until it goes out of
+ * scope is written to the org.kde.peruse.timing logging category as a single line holding
+ * a JSON object, for example:
+ *
+ * \code
+ * org.kde.peruse.timing: {"count":1834,"measurement":"BookDatabase::loadEntries","msecs":41.27,"timestamp":1792412345678}
+ * \endcode
+ *
+ * The category is off by default. Enable it by setting QT_LOGGING_RULES to
+ * "org.kde.peruse.timing.debug=true", load the same library or book a few times, and
+ * collect the lines for the measurements you are interested in. Comparing those between
+ * builds shows which changes made things faster or slower. While the category is off, the
+ * timer does not even read the clock.
+ */
+class PerformanceTimer
+{
+public:
+    /**
+     * @param measurement The name of what is being measured (usually the function doing the
+     * work). This is not copied, so it must live at least as long as the timer does (as a
+     * string literal does).
+     */
+    explicit PerformanceTimer(const char* measurement);
+    ~PerformanceTimer();
+
+    /**
+     * \brief Set how many things the work dealt with (such as entries or pages), which is
+     * written out alongside the time, so runs on different amounts of data can be compared.
+     * @param count The number of things dealt with
+     */
+    void setCount(qint64 count);
+private:
+    Q_DISABLE_COPY(PerformanceTimer)
+    const char* m_measurement{nullptr};
+    qint64 m_count{-1};
+    QElapsedTimer m_timer;
+};
+
+#endif//PERFORMANCETIMER_H
@@ -20,23 +20,37 @@
  */
 
 #include "PreviewImageProvider.h"
+#include "ImageTextureFactory.h"
+#include "ThumbnailStore.h"
 
 #include <kiconloader.h>
 #include <kio/previewjob.h>
 
 #include <QCoreApplication>
-#include <QDir>
-#include <QTimer>
+#include <QFile>
+#include <QHash>
 #include <QIcon>
 #include <QMimeDatabase>
 #include <QMutex>
-#include <QThreadPool>
-#include <QDebug>
+#include <QPointer>
+#include <QTimer>
+
+#include <algorithm>
+
+namespace {
+    // How long to wait for more requests to come in before starting a job, in milliseconds
+    const int batchInterval{50};
+    // How long a job may go without producing any previews before we give up on it, in milliseconds
+    const int stallTimeout{3000};
+}
 
 class PreviewImageProvider::Private
 {
 public:
-    Private() {};
+    Private() {
+        batcher = new PreviewBatcher(qApp);
+    };
+    QPointer<PreviewBatcher> batcher;
 };
 
 PreviewImageProvider::PreviewImageProvider()
@@ -54,31 +68,51 @@ PreviewImageProvider::~PreviewImageProvider()
 class PreviewResponse : public QQuickImageResponse
 {
     public:
-        PreviewResponse(const QString &id, const QSize &requestedSize)
+        PreviewResponse(const QString &id, const QSize &requestedSize, PreviewBatcher* batcher)
+            : m_batcher(batcher)
         {
-            m_runnable = new PreviewRunnable(id, requestedSize);
-            m_runnable->setAutoDelete(false);
-            connect(m_runnable, &PreviewRunnable::done, this, &PreviewResponse::handleDone, Qt::QueuedConnection);
-            connect(this, &QQuickImageResponse::finished, m_runnable, &QObject::deleteLater,  Qt::QueuedConnection);
-            QThreadPool::globalInstance()->start(m_runnable);
+            if(requestedSize.width() > 0 && requestedSize.height() > 0)
+            {
+                m_size = requestedSize;
+            }
+
+            QImage preview;
+            if(QFile::exists(id)) {
+                // KIO stores its previews in the same place as the store does, so if there is one
+                // already, there is no need to ask for it
+                preview = ThumbnailStore::instance()->find(id, m_size);
+                if(preview.isNull() && m_batcher) {
+                    m_batcher->request(id, m_size, this);
+                    return;
+                }
+            }
+            // Nobody is listening to us yet, so finish once they are
+            QMetaObject::invokeMethod(this, [this, preview](){ handleDone(preview); }, Qt::QueuedConnection);
         }
 
         void handleDone(QImage image) {
-            m_image = image;
+            if(image.width() > m_size.width() || image.height() > m_size.height()) {
+                image = image.scaled(m_size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+            }
+            m_image = ImageTextureFactory::prepareImage(image);
             Q_EMIT finished();
         }
 
         QQuickTextureFactory *textureFactory() const override
         {
-            return QQuickTextureFactory::textureFactoryForImage(m_image);
+            return new ImageTextureFactory(m_image);
         }
 
         void cancel() override
         {
-            m_runnable->abort();
+            // If we were still waiting, nothing will finish the response for us
+            if (m_batcher && m_batcher->cancel(this)) {
+                Q_EMIT finished();
+            }
         }
 
-        PreviewRunnable* m_runnable{nullptr};
+        QPointer<PreviewBatcher> m_batcher;
+        QSize m_size{KIconLoader::SizeEnormous, KIconLoader::SizeEnormous};
         QImage m_image;
 };
 
@@ -89,134 +123,204 @@ QQuickImageResponse * PreviewImageProvider::requestImageResponse(const QString&
     while (adjustedId.startsWith("//")) {
         adjustedId = adjustedId.mid(1);
     }
-    PreviewResponse* response = new PreviewResponse(adjustedId, requestedSize);
+    PreviewResponse* response = new PreviewResponse(adjustedId, requestedSize, d->batcher);
     return response;
 }
 
-class PreviewRunnable::Private {
+class PreviewBatcher::Private {
 public:
-    Private() {}
-    QString id;
-    QSize requestedSize;
-
-    bool abort{false};
-    QMutex abortMutex;
-    bool isAborted() {
-        QMutexLocker locker(&abortMutex);
-        return abort;
-    }
+    Private(PreviewBatcher* qq) : q(qq) {}
+    PreviewBatcher* q;
 
-    QImage preview;
-    QPointer<KIO::PreviewJob> job{nullptr};
-    QString mimetype;
-};
+    // Everything waiting for the preview of one file in one size
+    struct Request {
+        QString id;
+        QSize size;
+        QList<PreviewResponse*> responses;
+        KIO::PreviewJob* job{nullptr};
+    };
+    // One running job, and which request each of its items belongs to
+    struct Batch {
+        QSize size;
+        QHash<QUrl, QString> keys;
+        QTimer* breaker{nullptr};
+    };
 
-PreviewRunnable::PreviewRunnable(const QString& id, const QSize& requestedSize)
-    : d(new Private)
-{
-    d->id = id;
-    d->requestedSize = requestedSize;
-}
+    QMutex mutex;
+    QHash<QString, Request> requests;
+    QHash<PreviewResponse*, QString> responseKeys;
+    QStringList pending;
+    bool batchScheduled{false};
+    QTimer* batchTimer{nullptr};
+    // Only touched on the batcher's own thread
+    QHash<KJob*, Batch> batches;
 
-PreviewRunnable::~PreviewRunnable()
-{
-    abort();
-    delete d;
-}
+    static QString requestKey(const QString& id, const QSize& size) {
+        return QString("%1x%2:%3").arg(size.width()).arg(size.height()).arg(id);
+    }
 
-void PreviewRunnable::run()
-{
+    static QImage mimetypeIcon(const QString& mimetype, const QSize& size) {
+        QMimeDatabase db;
+        QIcon mimeIcon = QIcon::fromTheme(db.mimeTypeForName(mimetype).iconName());
+        return mimeIcon.pixmap(mimeIcon.actualSize(size)).toImage();
+    }
 
-    QSize ourSize(KIconLoader::SizeEnormous, KIconLoader::SizeEnormous);
-    if(d->requestedSize.width() > 0 && d->requestedSize.height() > 0)
-    {
-        ourSize = d->requestedSize;
+    // Hand the preview to everybody waiting for it. The mutex must be held.
+    void deliver(const QString& key, const QImage& image) {
+        const Request request = requests.take(key);
+        for(PreviewResponse* response : request.responses) {
+            responseKeys.remove(response);
+            QMetaObject::invokeMethod(response, [response, image](){ response->handleDone(image); }, Qt::QueuedConnection);
+        }
     }
 
-    if(QFile(d->id).exists())
-    {
-        QMimeDatabase db;
-        QList<QMimeType> mimetypes = db.mimeTypesForFileName(d->id);
-        if(mimetypes.count() > 0)
-        {
-            d->mimetype = mimetypes.first().name();
+    // Start a job for everything which was requested since the last batch
+    void startBatch() {
+        QMutexLocker locker(&mutex);
+        batchScheduled = false;
+        // Each job only gets previews of one size, so split the requests up by size
+        QList<QPair<QSize, QStringList>> keysBySize;
+        for(const QString& key : qAsConst(pending)) {
+            if(!requests.contains(key)) {
+                continue;
+            }
+            const QSize size = requests.value(key).size;
+            auto sizeKeys = std::find_if(keysBySize.begin(), keysBySize.end(), [&size](const QPair<QSize, QStringList>& entry){ return entry.first == size; });
+            if(sizeKeys == keysBySize.end()) {
+                keysBySize.append(qMakePair(size, QStringList{key}));
+            } else {
+                sizeKeys->second.append(key);
+            }
         }
+        pending.clear();
 
-        if(!d->isAborted()) {
-            static QStringList allPlugins{KIO::PreviewJob::availablePlugins()};
-            d->job = new KIO::PreviewJob(KFileItemList() << KFileItem(QUrl::fromLocalFile(d->id), d->mimetype, 0), ourSize, &allPlugins);
-            d->job->setIgnoreMaximumSize(true);
-            d->job->setScaleType(KIO::PreviewJob::ScaledAndCached);
-            connect(d->job, &KIO::PreviewJob::gotPreview, this, &PreviewRunnable::updatePreview);
-            connect(d->job, &KIO::PreviewJob::failed, this, &PreviewRunnable::fallbackPreview);
-            connect(d->job, &KIO::PreviewJob::finished, this, &PreviewRunnable::finishedPreview);
-            d->job->start();
-
-            QTimer* breaker = new QTimer();
-            breaker->moveToThread(thread());
-            breaker->setParent(this);
-            breaker->setSingleShot(true);
-            breaker->setInterval(3000);
-            connect(breaker, &QTimer::timeout, this, [this](){
-                if (!d->isAborted()) {
-                    abort();
-                }
+        static QStringList allPlugins{KIO::PreviewJob::availablePlugins()};
+        QMimeDatabase db;
+        for(const QPair<QSize, QStringList>& sizeKeys : qAsConst(keysBySize)) {
+            Batch batch;
+            batch.size = sizeKeys.first;
+            KFileItemList items;
+            for(const QString& key : sizeKeys.second) {
+                const QString& id = requests[key].id;
+                const QUrl url = QUrl::fromLocalFile(id);
+                // Going by the file name is enough to pick the plugin, and means not reading the file here
+                items << KFileItem(url, db.mimeTypeForFile(id, QMimeDatabase::MatchExtension).name());
+                batch.keys.insert(url, key);
+            }
+            KIO::PreviewJob* job = new KIO::PreviewJob(items, batch.size, &allPlugins);
+            job->setIgnoreMaximumSize(true);
+            job->setScaleType(KIO::PreviewJob::ScaledAndCached);
+            for(const QString& key : sizeKeys.second) {
+                requests[key].job = job;
+            }
+            QObject::connect(job, &KIO::PreviewJob::gotPreview, q, [this, job](const KFileItem& item, const QPixmap& preview){
+                handleResult(job, item, preview.toImage());
+            });
+            QObject::connect(job, &KIO::PreviewJob::failed, q, [this, job](const KFileItem& item){
+                handleResult(job, item, mimetypeIcon(item.mimetype(), batches.value(job).size));
             });
-            QTimer::singleShot(0, breaker, [breaker](){ breaker->start(); });
-        } else {
-            finishedPreview(nullptr);
+            QObject::connect(job, &KJob::finished, q, [this, job](){ handleFinished(job); });
+
+            // Give up on the job if it stops producing previews
+            batch.breaker = new QTimer(job);
+            batch.breaker->setSingleShot(true);
+            batch.breaker->setInterval(stallTimeout);
+            QObject::connect(batch.breaker, &QTimer::timeout, job, [job](){ job->kill(); });
+            batch.breaker->start();
+            batches.insert(job, batch);
+            job->start();
         }
     }
-    else
-    {
-        finishedPreview(nullptr);
+
+    void handleResult(KIO::PreviewJob* job, const KFileItem& item, const QImage& image) {
+        auto batch = batches.find(job);
+        if(batch == batches.end()) {
+            return;
+        }
+        batch->breaker->start();
+        const QString key = batch->keys.take(item.url());
+        QMutexLocker locker(&mutex);
+        if(!key.isEmpty() && requests.contains(key)) {
+            deliver(key, image);
+        }
     }
-}
 
-void PreviewRunnable::abort()
-{
-    if (d->job) {
-        QMutexLocker locker(&d->abortMutex);
-        d->abort = true;
-        locker.unlock();
-        d->job->kill();
+    void handleFinished(KJob* job) {
+        const Batch batch = batches.take(job);
+        QMutexLocker locker(&mutex);
+        // Anything the job did not get to (because it was killed, or just skipped it) gets an icon instead
+        QMimeDatabase db;
+        for(auto it = batch.keys.constBegin(); it != batch.keys.constEnd(); ++it) {
+            if(requests.contains(it.value())) {
+                const QString mimetype = db.mimeTypeForFile(requests.value(it.value()).id, QMimeDatabase::MatchExtension).name();
+                deliver(it.value(), mimetypeIcon(mimetype, batch.size));
+            }
+        }
     }
+};
+
+PreviewBatcher::PreviewBatcher(QObject* parent)
+    : QObject(parent)
+    , d(new Private(this))
+{
+    d->batchTimer = new QTimer(this);
+    d->batchTimer->setSingleShot(true);
+    d->batchTimer->setInterval(batchInterval);
+    connect(d->batchTimer, &QTimer::timeout, this, [this](){ d->startBatch(); });
 }
 
-void PreviewRunnable::fallbackPreview(const KFileItem& item)
+PreviewBatcher::~PreviewBatcher()
 {
-    KIO::PreviewJob* previewJob = qobject_cast<KIO::PreviewJob*>(sender());
-    if(previewJob)
-    {
-        QMimeDatabase db;
-        QIcon mimeIcon = QIcon::fromTheme(db.mimeTypeForName(item.mimetype()).iconName());
-        QSize actualSize = mimeIcon.actualSize(d->requestedSize);
-        d->preview = mimeIcon.pixmap(actualSize).toImage();
-    }
+    delete d;
 }
 
-void PreviewRunnable::updatePreview(const KFileItem&, const QPixmap& p)
+void PreviewBatcher::request(const QString& id, const QSize& requestedSize, PreviewResponse* response)
 {
-    KIO::PreviewJob* previewJob = qobject_cast<KIO::PreviewJob*>(sender());
-    if(previewJob)
-    {
-        d->preview = p.toImage();
+    QMutexLocker locker(&d->mutex);
+    const QString key = Private::requestKey(id, requestedSize);
+    auto it = d->requests.find(key);
+    if(it == d->requests.end()) {
+        Private::Request request;
+        request.id = id;
+        request.size = requestedSize;
+        it = d->requests.insert(key, request);
+        d->pending.append(key);
+    }
+    it->responses.append(response);
+    d->responseKeys.insert(response, key);
+    // Start the batch a little while after the first request for it, and do not wait any longer
+    // than that even if more keep coming in
+    if(!d->batchScheduled) {
+        d->batchScheduled = true;
+        QMetaObject::invokeMethod(d->batchTimer, QOverload<>::of(&QTimer::start), Qt::QueuedConnection);
     }
 }
 
-void PreviewRunnable::finishedPreview(KJob* /*job*/)
+bool PreviewBatcher::cancel(PreviewResponse* response)
 {
-    if(d->isAborted()) {
-        if (d->preview.isNull()) {
-            QMimeDatabase db;
-            QIcon mimeIcon = QIcon::fromTheme(db.mimeTypeForName(d->mimetype).iconName());
-            QSize actualSize = mimeIcon.actualSize(d->requestedSize);
-            d->preview = mimeIcon.pixmap(actualSize).toImage();
-        }
-    } else {
-        if(d->requestedSize.width() > 0 && d->requestedSize.height() > 0) {
-            d->preview = d->preview.scaled(d->requestedSize, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    QMutexLocker locker(&d->mutex);
+    if(!d->responseKeys.contains(response)) {
+        return false;
+    }
+    const QString key = d->responseKeys.take(response);
+    auto it = d->requests.find(key);
+    if(it != d->requests.end()) {
+        it->responses.removeAll(response);
+        if(it->responses.isEmpty()) {
+            // Nobody wants this one any more, so don't go and get it
+            KIO::PreviewJob* job = it->job;
+            const QUrl url = QUrl::fromLocalFile(it->id);
+            d->requests.erase(it);
+            d->pending.removeAll(key);
+            if(job) {
+                QMetaObject::invokeMethod(this, [this, job, url](){
+                    if(d->batches.contains(job)) {
+                        d->batches[job].keys.remove(url);
+                        job->removeItem(url);
+                    }
+                }, Qt::QueuedConnection);
+            }
         }
     }
-    Q_EMIT done(d->preview);
+    return true;
 }
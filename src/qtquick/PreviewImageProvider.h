@@ -23,15 +23,12 @@
 #define PREVIEWIMAGEPROVIDER_H
 
 #include <QQuickAsyncImageProvider>
-#include <QRunnable>
 
 /**
  * \brief Get file previews using KIO::PreviewJob
  *
  * NOTE: As this task is potentially heavy, make sure to mark any Image using this provider asynchronous
  */
-class KFileItem;
-class KJob;
 class PreviewImageProvider : public QQuickAsyncImageProvider
 {
 public:
@@ -52,45 +49,41 @@ private:
     Private* d;
 };
 
+class PreviewResponse;
 /**
- * \brief A worker class which does the bulk of the work for PreviewImageProvider
+ * \brief Gets the previews for PreviewImageProvider, many at a time
+ *
+ * Starting a KIO::PreviewJob for every single preview meant that scrolling through a shelf
+ * of books started one job for each of them. The batcher instead collects the requests which
+ * arrive within a short time of each other, and gets all of them using one job (one for each
+ * size requested), handing the results out to the responses waiting for them as they arrive.
+ * Requests for the same file in the same size share a single preview.
+ *
+ * The batcher lives in the thread it was created in (which must have an event loop, for the
+ * jobs to run), but responses may be added and cancelled from any thread.
  */
-class PreviewRunnable : public QObject, public QRunnable {
-    Q_OBJECT;
+class PreviewBatcher : public QObject {
+    Q_OBJECT
 public:
-    explicit PreviewRunnable(const QString &id, const QSize &requestedSize);
-    ~PreviewRunnable() override;
-
-    void run() override;
+    explicit PreviewBatcher(QObject* parent = nullptr);
+    ~PreviewBatcher() override;
 
     /**
-     * Request that the preview worker abort what it's doing
+     * \brief Ask for the preview of a file.
+     * Once the preview is available (or it has been decided that there will not be one),
+     * PreviewResponse::handleDone() is called on the response, in the response's thread.
+     * @param id The local file to get a preview of
+     * @param requestedSize The size to get the preview in
+     * @param response The response waiting for the preview
      */
-    Q_SLOT void abort();
-
+    void request(const QString& id, const QSize& requestedSize, PreviewResponse* response);
     /**
-     * \brief Emitted once the preview has been retrieved (successfully or not)
-     * @param image The preview image in the requested size (possibly a placeholder)
-     */
-    Q_SIGNAL void done(QImage image);
-    /**
-     *\brief Get an icon associated with the mimetype of the image as a fallback.
-     * 
-     * @param p Pointer to pixmap to write this fallback into.
-     */
-    Q_SLOT void updatePreview(const KFileItem&, const QPixmap& p);
-    /**
-     *\brief Get an icon associated with the mimetype of the image as a fallback.
-     * 
-     * @param item The image to write a fallback for.
-     */
-    Q_SLOT void fallbackPreview(const KFileItem& item);
-    /**
-     * \brief Set whether the preview generation is finished.
-     * 
-     * @param job The job to mark finished.
+     * \brief Stop waiting for a preview.
+     * @param response The response which no longer wants its preview
+     * @return True if the response was still waiting. If this is false, the preview is already
+     * on its way to the response.
      */
-    Q_SLOT void finishedPreview(KJob* job);
+    bool cancel(PreviewResponse* response);
 private:
     class Private;
     Private* d;
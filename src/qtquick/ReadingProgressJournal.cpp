@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2026 Dan Leinir Turthra Jensen <admin@leinir.dk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ReadingProgressJournal.h"
+
+#include "BookDatabase.h"
+
+#include <KFileMetaData/UserMetaData>
+
+#include <QCoreApplication>
+#include <QHash>
+#include <QPointer>
+#include <QTimer>
+
+#include <qtquick_debug.h>
+
+class ReadingProgressJournal::Private {
+public:
+    Private(ReadingProgressJournal* qq)
+        : q(qq)
+    {
+        flushTimer = new QTimer(qq);
+        // Not restarted by further changes, so nothing waits longer than this to be written
+        flushTimer->setInterval(5000);
+        flushTimer->setSingleShot(true);
+        QObject::connect(flushTimer, &QTimer::timeout, qq, &ReadingProgressJournal::flush);
+    }
+    ReadingProgressJournal* q;
+    QTimer* flushTimer{nullptr};
+    QPointer<BookDatabase> database;
+    // The latest value of each changed field, per book
+    QHash<QString, QVariantHash> databaseValues;
+    QHash<QString, int> currentPageAttributes;
+
+    void scheduleFlush() {
+        if(!flushTimer->isActive()) {
+            flushTimer->start();
+        }
+    }
+};
+
+ReadingProgressJournal* ReadingProgressJournal::instance()
+{
+    // Books may still be closed while the application object (and so the journal) is torn down
+    static QPointer<ReadingProgressJournal> journal;
+    if (!journal) {
+        journal = new ReadingProgressJournal(QCoreApplication::instance());
+    }
+    return journal;
+}
+
+ReadingProgressJournal::ReadingProgressJournal(QObject* parent)
+    : QObject(parent)
+    , d(new Private(this))
+{
+    if (QCoreApplication::instance()) {
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &ReadingProgressJournal::flush);
+    }
+}
+
+ReadingProgressJournal::~ReadingProgressJournal()
+{
+    flush();
+    delete d;
+}
+
+void ReadingProgressJournal::setDatabase(BookDatabase* database)
+{
+    if (d->database != database) {
+        flush();
+        d->database = database;
+    }
+}
+
+void ReadingProgressJournal::setDatabaseValue(const QString& fileName, const QString& property, const QVariant& value)
+{
+    d->databaseValues[fileName].insert(property, value);
+    d->scheduleFlush();
+}
+
+void ReadingProgressJournal::setCurrentPageAttribute(const QString& fileName, int currentPage)
+{
+    d->currentPageAttributes.insert(fileName, currentPage);
+    d->scheduleFlush();
+}
+
+void ReadingProgressJournal::flush()
+{
+    d->flushTimer->stop();
+    if (!d->databaseValues.isEmpty()) {
+        if (d->database) {
+            d->database->updateEntries(d->databaseValues);
+        } else {
+            qCDebug(QTQUICK_LOG) << "No database to write the reading progress of" << d->databaseValues.count() << "books to";
+        }
+        d->databaseValues.clear();
+    }
+    for (auto it = d->currentPageAttributes.constBegin(); it != d->currentPageAttributes.constEnd(); ++it) {
+        KFileMetaData::UserMetaData data(it.key());
+        data.setAttribute("peruse.currentPage", QString::number(it.value()));
+    }
+    d->currentPageAttributes.clear();
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2026 Dan Leinir Turthra Jensen <admin@leinir.dk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef READINGPROGRESSJOURNAL_H
+#define READINGPROGRESSJOURNAL_H
+
+#include <QObject>
+#include <QVariant>
+
+class BookDatabase;
+/**
+ * \brief Collects changes to the reading progress of books, and writes them out in batches
+ *
+ * Every page turn changes the current page of the book being read, and writing that
+ * straight to the library database and the extended attributes of the book's file
+ * means a burst of synchronous writes per page, which is noticeable on slow storage
+ * (network shares, sd cards and the like). Instead, the latest value for each book is
+ * kept here, and written out a few seconds after the first change, when a book is
+ * closed, and when the application quits. All the database changes are written in a
+ * single transaction, and each file's attribute is written once, however many pages
+ * were turned in the meantime.
+ */
+class ReadingProgressJournal : public QObject
+{
+    Q_OBJECT
+public:
+    /**
+     * @return The journal shared by everything in this process.
+     */
+    static ReadingProgressJournal* instance();
+    ~ReadingProgressJournal() override;
+
+    /**
+     * \brief Set the database the recorded database values are written to.
+     * Any values already waiting to be written to the previous database are written first.
+     * @param database The library database (the journal does not take ownership)
+     */
+    void setDatabase(BookDatabase* database);
+    /**
+     * \brief Record a new value for a field of a book in the library database.
+     * @param fileName The file name of the book
+     * @param property The name of the field to update
+     * @param value The new value, replacing any value recorded earlier for the same field
+     */
+    void setDatabaseValue(const QString& fileName, const QString& property, const QVariant& value);
+    /**
+     * \brief Record the current page of a book, to be stored in the extended attributes of its file.
+     * @param fileName The file (or folder) the book was opened from
+     * @param currentPage The page the reader is on
+     */
+    void setCurrentPageAttribute(const QString& fileName, int currentPage);
+    /**
+     * \brief Write out everything recorded so far.
+     */
+    Q_SLOT void flush();
+private:
+    explicit ReadingProgressJournal(QObject* parent = nullptr);
+    class Private;
+    Private* d;
+};
+
+#endif//READINGPROGRESSJOURNAL_H
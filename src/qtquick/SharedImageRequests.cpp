@@ -0,0 +1,115 @@
+/*
+ * Copyright (C) 2026 Dan Leinir Turthra Jensen <admin@leinir.dk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "SharedImageRequests.h"
+
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QPair>
+
+#include <algorithm>
+
+class SharedImageRequests::Private {
+public:
+    Private() {}
+
+    struct Request {
+        QRunnable* work{nullptr};
+        std::function<void()> cancel;
+        QList<QPair<QObject*, std::function<void(QImage)>>> receivers;
+    };
+
+    QMutex mutex;
+    QHash<QString, Request> requests;
+};
+
+SharedImageRequests::SharedImageRequests()
+    : d(new Private)
+{
+}
+
+SharedImageRequests::~SharedImageRequests()
+{
+    delete d;
+}
+
+QString SharedImageRequests::key(const QString& id, const QSize& requestedSize)
+{
+    return QString("%1x%2:%3").arg(requestedSize.width()).arg(requestedSize.height()).arg(id);
+}
+
+bool SharedImageRequests::attach(const QString& key, QObject* receiver, std::function<void(QImage)> deliver)
+{
+    QMutexLocker locker(&d->mutex);
+    const bool isNew = !d->requests.contains(key);
+    d->requests[key].receivers.append(qMakePair(receiver, deliver));
+    return isNew;
+}
+
+void SharedImageRequests::setWork(const QString& key, QRunnable* work, std::function<void()> cancel)
+{
+    QMutexLocker locker(&d->mutex);
+    auto it = d->requests.find(key);
+    if (it != d->requests.end()) {
+        it->work = work;
+        it->cancel = cancel;
+    }
+}
+
+bool SharedImageRequests::detach(const QString& key, QObject* receiver)
+{
+    QMutexLocker locker(&d->mutex);
+    auto it = d->requests.find(key);
+    if (it == d->requests.end()) {
+        return false;
+    }
+    auto receiverIt = std::find_if(it->receivers.begin(), it->receivers.end(), [receiver](const QPair<QObject*, std::function<void(QImage)>>& entry){ return entry.first == receiver; });
+    if (receiverIt == it->receivers.end()) {
+        return false;
+    }
+    it->receivers.erase(receiverIt);
+    if (it->receivers.isEmpty()) {
+        // Nobody wants the image any more, so stop making it
+        const std::function<void()> cancel = it->cancel;
+        d->requests.erase(it);
+        if (cancel) {
+            cancel();
+        }
+    }
+    return true;
+}
+
+void SharedImageRequests::finish(const QString& key, QRunnable* work, const QImage& image)
+{
+    QMutexLocker locker(&d->mutex);
+    auto it = d->requests.find(key);
+    if (it == d->requests.end() || it->work != work) {
+        return;
+    }
+    const Private::Request request = d->requests.take(key);
+    for (const auto& entry : request.receivers) {
+        const std::function<void(QImage)> deliver = entry.second;
+        QMetaObject::invokeMethod(entry.first, [deliver, image](){ deliver(image); }, Qt::QueuedConnection);
+    }
+}
@@ -0,0 +1,101 @@
+/*
+ * Copyright (C) 2026 Dan Leinir Turthra Jensen <admin@leinir.dk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef SHAREDIMAGEREQUESTS_H
+#define SHAREDIMAGEREQUESTS_H
+
+#include <QImage>
+#include <QSize>
+#include <QString>
+
+#include <functional>
+
+class QObject;
+class QRunnable;
+/**
+ * \brief Lets the responses for the same image share one decode
+ *
+ * When several views show the same cover (the bookshelf and the welcome page, say), each
+ * of them asks the image provider for it, and each of those requests used to start its own
+ * runnable to open the same archive and decode the same image.
+ *
+ * Each image provider keeps one of these, and the responses attach themselves to it. The
+ * first response asking for an image in a given size starts the work, and any others asking
+ * for the same image in the same size while that is still in flight simply wait for it to
+ * finish, and get the same image. The work is only aborted once every response waiting for
+ * it has been cancelled.
+ *
+ * All functions are safe to call from any thread.
+ */
+class SharedImageRequests
+{
+public:
+    explicit SharedImageRequests();
+    ~SharedImageRequests();
+
+    /**
+     * @param id The id of the image, as passed to the image provider
+     * @param requestedSize The size the image was requested in
+     * @return The key to identify the request by
+     */
+    static QString key(const QString& id, const QSize& requestedSize);
+
+    /**
+     * \brief Wait for the image with the given key.
+     * @param key The key of the image
+     * @param receiver The object waiting for the image (usually the response). The image is
+     * handed to it in its own thread.
+     * @param deliver The function to call with the image, once it is there
+     * @return True if nothing was in flight for the key yet, in which case the caller must start
+     * the work, and call setWork() and finish() for it
+     */
+    bool attach(const QString& key, QObject* receiver, std::function<void(QImage)> deliver);
+    /**
+     * \brief Set the work which will produce the image with the given key.
+     * @param key The key of the image
+     * @param work The work producing the image (used to recognise its result in finish())
+     * @param cancel Called if every receiver is detached before the work is finished. This
+     * should abort the work, and take it off the decode scheduler's queue if it is still there.
+     */
+    void setWork(const QString& key, QRunnable* work, std::function<void()> cancel);
+    /**
+     * \brief Stop waiting for the image with the given key.
+     * @param key The key of the image
+     * @param receiver The object which no longer wants the image
+     * @return True if the receiver was still waiting. If this is false, the image is already
+     * on its way to the receiver.
+     */
+    bool detach(const QString& key, QObject* receiver);
+    /**
+     * \brief Hand the image to everybody waiting for it.
+     * @param key The key of the image
+     * @param work The work which produced the image. If this is no longer the work in flight for
+     * the key (because it was cancelled), the image is not handed out.
+     * @param image The finished image
+     */
+    void finish(const QString& key, QRunnable* work, const QImage& image);
+private:
+    class Private;
+    Private* d;
+};
+
+#endif//SHAREDIMAGEREQUESTS_H
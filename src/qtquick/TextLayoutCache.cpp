@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2026 Dan Leinir Turthra Jensen <admin@leinir.dk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#include "TextLayoutCache.h"
+
+#include <QCache>
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTimer>
+
+#include <qtquick_debug.h>
+
+class TextLayoutCache::Private {
+public:
+    Private(TextLayoutCache* qq)
+        : q(qq)
+    {
+        entries.setMaxCost(maximumEntries);
+        saveTimer = new QTimer(qq);
+        saveTimer->setInterval(30000);
+        saveTimer->setSingleShot(true);
+        QObject::connect(saveTimer, &QTimer::timeout, qq, [this](){ save(); });
+
+        QDir location{QStandardPaths::writableLocation(QStandardPaths::CacheLocation)};
+        if(!location.exists())
+            location.mkpath(".");
+        cacheFile = location.absoluteFilePath("textlayouts.cache");
+        load();
+    }
+    TextLayoutCache* q;
+    static const int maximumEntries{4096};
+    // Bump this whenever the format of the file, or the way layouts are calculated, changes
+    static const quint32 fileVersion{1};
+    static const quint32 fileMagic{0x7065746c}; // "petl"
+    QCache<QByteArray, Entry> entries;
+    QString cacheFile;
+    QTimer* saveTimer{nullptr};
+    bool dirty{false};
+
+    void load() {
+        QFile file(cacheFile);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return;
+        }
+        QDataStream stream(&file);
+        quint32 magic{0};
+        quint32 version{0};
+        stream >> magic >> version;
+        if (magic != fileMagic || version != fileVersion) {
+            qCDebug(QTQUICK_LOG) << "Ignoring text layout cache with unknown format" << cacheFile;
+            return;
+        }
+        qint32 count{0};
+        stream >> count;
+        for (qint32 i = 0; i < count && i < maximumEntries && stream.status() == QDataStream::Ok; ++i) {
+            QByteArray key;
+            Entry* entry = new Entry();
+            qint32 paragraphCount{0};
+            stream >> key >> entry->pixelSize >> entry->fitted >> paragraphCount;
+            entry->paragraphs.resize(qMax(0, paragraphCount));
+            for (QVector<Line>& paragraph : entry->paragraphs) {
+                qint32 lineCount{0};
+                stream >> lineCount;
+                paragraph.resize(qMax(0, lineCount));
+                for (Line& line : paragraph) {
+                    stream >> line.position >> line.width >> line.textLength;
+                }
+            }
+            if (stream.status() == QDataStream::Ok) {
+                entries.insert(key, entry);
+            } else {
+                delete entry;
+            }
+        }
+    }
+
+    void save() {
+        if (!dirty) {
+            return;
+        }
+        QSaveFile file(cacheFile);
+        if (!file.open(QIODevice::WriteOnly)) {
+            qCDebug(QTQUICK_LOG) << "Failed to open the text layout cache for writing" << cacheFile << file.errorString();
+            return;
+        }
+        QDataStream stream(&file);
+        const QList<QByteArray> keys = entries.keys();
+        stream << fileMagic << fileVersion << qint32(keys.count());
+        for (const QByteArray& key : keys) {
+            const Entry* entry = entries.object(key);
+            stream << key << entry->pixelSize << entry->fitted << qint32(entry->paragraphs.count());
+            for (const QVector<Line>& paragraph : entry->paragraphs) {
+                stream << qint32(paragraph.count());
+                for (const Line& line : paragraph) {
+                    stream << line.position << line.width << line.textLength;
+                }
+            }
+        }
+        if (file.commit()) {
+            dirty = false;
+        }
+    }
+};
+
+TextLayoutCache* TextLayoutCache::instance()
+{
+    static TextLayoutCache* cache{nullptr};
+    if (!cache) {
+        cache = new TextLayoutCache(QCoreApplication::instance());
+    }
+    return cache;
+}
+
+TextLayoutCache::TextLayoutCache(QObject* parent)
+    : QObject(parent)
+    , d(new Private(this))
+{
+    if (QCoreApplication::instance()) {
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, [this](){ d->save(); });
+    }
+}
+
+TextLayoutCache::~TextLayoutCache()
+{
+    d->save();
+    delete d;
+}
+
+bool TextLayoutCache::find(const QByteArray& key, Entry& entry) const
+{
+    const Entry* found = d->entries.object(key);
+    if (found) {
+        entry = *found;
+        return true;
+    }
+    return false;
+}
+
+void TextLayoutCache::insert(const QByteArray& key, const Entry& entry)
+{
+    d->entries.insert(key, new Entry(entry));
+    d->dirty = true;
+    d->saveTimer->start();
+}
+
+void TextLayoutCache::remove(const QByteArray& key)
+{
+    if (d->entries.remove(key)) {
+        d->dirty = true;
+        d->saveTimer->start();
+    }
+}
@@ -0,0 +1,88 @@
+/*
+ * Copyright (C) 2026 Dan Leinir Turthra Jensen <admin@leinir.dk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ *
+ */
+
+#ifndef TEXTLAYOUTCACHE_H
+#define TEXTLAYOUTCACHE_H
+
+#include <QObject>
+#include <QPointF>
+#include <QVector>
+
+/**
+ * \brief A cache of the results of fitting text into a shape, shared by all TextViewerItem instances
+ *
+ * Finding the largest font size which lets a set of paragraphs fit inside a polygon
+ * means laying out the text many times over. The result of that only depends on the
+ * text, the font and style, and the shape and scale of the polygon, so once it has
+ * been found it is stored here, keyed on a hash of all those things. Showing the
+ * same text area again (turning back to a page, or looking at it at the same zoom
+ * level) then only needs to lay the text out once, using the stored lines.
+ *
+ * The cache is written to the user's cache location when the application quits
+ * (and periodically while it is running), so the work also carries over between
+ * sessions. It is bounded, so old entries are discarded as new ones come in.
+ */
+class TextLayoutCache : public QObject
+{
+    Q_OBJECT
+public:
+    struct Line {
+        QPointF position;
+        qreal width{0};
+        int textLength{0};
+    };
+    struct Entry {
+        int pixelSize{-1};
+        bool fitted{false};
+        // One list of lines per paragraph, in the order they were laid out
+        QVector<QVector<Line>> paragraphs;
+    };
+
+    /**
+     * @return The cache shared by everything in this process.
+     */
+    static TextLayoutCache* instance();
+    ~TextLayoutCache() override;
+
+    /**
+     * Look up the layout for a key.
+     * @param key The key as created by the user of the cache
+     * @param entry If found, the entry is written into this
+     * @return True if an entry was found for the key
+     */
+    bool find(const QByteArray& key, Entry& entry) const;
+    /**
+     * Store a layout in the cache, replacing any existing entry for the same key.
+     * @param key The key as created by the user of the cache
+     * @param entry The layout to store
+     */
+    void insert(const QByteArray& key, const Entry& entry);
+    /**
+     * Forget the layout for a key (for example if it turned out not to produce the
+     * same lines when it was replayed).
+     * @param key The key to forget
+     */
+    void remove(const QByteArray& key);
+private:
+    explicit TextLayoutCache(QObject* parent = nullptr);
+    class Private;
+    Private* d;
+};
+
+#endif//TEXTLAYOUTCACHE_H
@@ -18,12 +18,17 @@
  */
 
 #include "TextViewerItem.h"
+#include "TextLayoutCache.h"
+#include "PerformanceTimer.h"
 
 #include "AcbfStyle.h"
 
+#include <QCryptographicHash>
 #include <QCursor>
 #include <QFontMetrics>
+#include <QMatrix4x4>
 #include <qmath.h>
+#include <QSGTransformNode>
 #include <QTimer>
 #include <private/qquicktextnode_p.h>
 
@@ -42,6 +47,43 @@ public:
     }
     TextViewerItem* q;
     QTimer* throttle{nullptr};
+    // How long to wait after the last change to the scale before laying the text out
+    // again. Until then, the existing glyphs are simply scaled to match.
+    static const int scaleSettleInterval{150};
+    // Whether something which affects the layout has changed since it was last done
+    bool layoutDirty{true};
+    // Whether the layouts have changed since the scene graph nodes were last built from them
+    bool nodesDirty{true};
+    // The shape multiplier and offset the current layouts were created for
+    double laidOutMultiplier{0};
+    QPoint laidOutOffset{0, 0};
+    // Whether the text has been laid out since what is being shown last changed, and whether
+    // the scale has changed since then. Layouts for zoom levels passed through on the way
+    // somewhere else are not worth remembering, so only the layout done for the scale the
+    // text was first shown at goes into the shared cache.
+    bool laidOutSinceContentChange{false};
+    bool zoomedSinceContentChange{false};
+
+    // Something changed which means the text needs laying out again as soon as possible
+    void scheduleLayout() {
+        layoutDirty = true;
+        laidOutSinceContentChange = false;
+        zoomedSinceContentChange = false;
+        if (q->isEnabled()) {
+            throttle->start(1);
+        }
+    }
+    // The scale changed, which we handle by transforming the existing nodes until it settles
+    void scheduleScaledLayout() {
+        layoutDirty = true;
+        if (laidOutSinceContentChange) {
+            zoomedSinceContentChange = true;
+        }
+        if (q->isEnabled()) {
+            throttle->start(scaleSettleInterval);
+        }
+        q->update();
+    }
     QStringList paragraphs;
     QList<QPoint> shape;
     QPoint shapeOffset{0, 0};
@@ -51,11 +93,29 @@ public:
     int margin{2};
 
     QPolygonF shapePolygon;
+    // The horizontal extent of the inside of shapePolygon for each pixel row of the item,
+    // built once whenever the polygon changes, so the fitting does not need to intersect
+    // the polygon with anything while probing for a font size
+    QVector<qreal> spanLeft;
+    QVector<qreal> spanRight;
+    qreal shapeArea{0};
+    // The font size the layouts were last laid out for, so we can avoid redoing the same work
+    int laidOutSize{-1};
+    bool laidOutSuccessfully{false};
     QFont font;
     QStringList internalParagraphs;
     QList<QVector<QTextLayout::FormatRange> > formats;
     // First is the index in formats, and second is the index is the list at that index
     QHash<QPair<int,int>, QList<QRectF>> anchorRects;
+    // A lookup structure for the anchor rects, sorted by the top of the rect, so that
+    // finding the anchor underneath a position does not require looking at every rect
+    struct AnchorRect {
+        QRectF rect;
+        QPair<int, int> anchor;
+    };
+    QVector<AnchorRect> anchorIndex;
+    QRectF anchorIndexBounds;
+    qreal anchorIndexMaxHeight{0};
     QList<QTextLayout*> layouts;
 
     // State tracker for making sure that if the user moves outside of the anchor they originally
@@ -230,6 +290,40 @@ public:
             internalParagraphs.append(text);
             formats.append(lineFormats);
         }
+
+        // Create the layouts up front, so the probes for the font size can all reuse them,
+        // rather than each of them creating (and throwing away) one per paragraph
+        qDeleteAll(layouts);
+        layouts.clear();
+        QTextOption option = QTextOption(Qt::AlignCenter);
+        option.setWrapMode(QTextOption::WordWrap);
+        for (const QString& text : qAsConst(internalParagraphs)) {
+            QTextLayout *textLayout = new QTextLayout(text, font);
+            textLayout->setTextOption(option);
+            layouts.append(textLayout);
+        }
+        laidOutSize = -1;
+    }
+
+    /**
+     * Work out the horizontal space available for a line which occupies the rows from y
+     * to y + lineHeight, which is the innermost left and right edge of the shape across
+     * all of those rows.
+     * @return False if any of the rows is outside the shape, otherwise true
+     */
+    bool lineSpan(qreal y, qreal lineHeight, qreal& xLeft, qreal& xRight) const {
+        const int firstRow = qMax(0, qFloor(y));
+        const int lastRow = qCeil(y + lineHeight) - 1;
+        if (lastRow >= spanLeft.count() || lastRow < firstRow) {
+            return false;
+        }
+        xLeft = spanLeft[firstRow];
+        xRight = spanRight[firstRow];
+        for (int row = firstRow + 1; row <= lastRow; ++row) {
+            xLeft = qMax(xLeft, spanLeft[row]);
+            xRight = qMin(xRight, spanRight[row]);
+        }
+        return xRight > xLeft;
     }
 
     bool attemptLayout(bool debug = false) {
@@ -241,88 +335,22 @@ public:
         qreal y = margin;
         qreal ymax = shapePolygon.boundingRect().height() - margin * 2;
 
-        qDeleteAll(layouts);
-        layouts.clear();
-
-        for (int p = 0; p < internalParagraphs.size(); ++p) {
+        int p = 0;
+        while (p < internalParagraphs.size()) {
             // Use a separate text layout for each paragraph in the document.
-            QTextLayout *textLayout = new QTextLayout(internalParagraphs[p], font);
-            QTextOption option = QTextOption(Qt::AlignCenter);
-            option.setWrapMode(QTextOption::WordWrap);
-            textLayout->setTextOption(option);
-            textLayout->setFormats(formats[p]);
+            QTextLayout *textLayout = layouts[p];
+            ++p;
+            textLayout->setFont(font);
+            textLayout->setFormats(formats[p - 1]);
             textLayout->beginLayout();
 
             QTextLine line = textLayout->createLine();
 
             while (line.isValid()) {
-                QPolygonF intersection = shapePolygon.intersected(QPolygonF(QRectF(0, y, q->width(), lineHeight)));
-                if (intersection.size() > 0) {
-                    qreal xLeft{0};
-                    qreal xRight{q->width()};
-                    // find leftmost and rightmost x values along top and bottom lines,
-                    // and pick the innermost of those as the left/right bits of our current line
-                    QVector<qreal> topAndBottom{y, y + lineHeight};
-                    QVector<QPointF> cornerPoints{QPolygonF(intersection.boundingRect())};
-                    if (debug) qDebug() << "intersection:" << intersection;
-                    int step{0};
-                    for (const qreal& position : topAndBottom) {
-                        QVector<qreal> coords;
-                        for (const QPointF& point : intersection) {
-                            if (point.y() == position) {
-                                coords.append(point.x());
-                            }
-                        }
-                        if (coords.count() > 0) {
-                            std::sort(coords.begin(), coords.end());
-                            if (xLeft < coords.first()) {
-                                xLeft = coords.first();
-                            }
-                            if (xRight > coords.last()) {
-                                xRight = coords.last();
-                            }
-                            cornerPoints[(step == 0) ? 0 : 3] = QPointF(coords.first(), position);
-                            cornerPoints[(step == 0) ? 1 : 2] = QPointF(coords.last(), position);
-                        }
-                        coords.clear();
-                        ++step;
-                    }
-
-                    // At this point it's entirely possible that we might still have an overlap, if the polygon
-                    // we're fitting things into has bits poking /in/ rather than out along the sides, so...
-                    // maybe we want to try and figure this out. Maybe store the four innermost corner points,
-                    // and then find them on each side, and pick the innermost x coord from that list of points
-                    // on the polygon.
-
-                    // First, we've no idea of where the polygon actually starts, so let's make sure it's the top-left corner
-                    int firstPointPosition{intersection.indexOf(cornerPoints[0])};
-                    if (firstPointPosition > 0) {
-                        QPolygonF snippet{intersection.mid(0, firstPointPosition)};
-                        intersection.remove(0, firstPointPosition);
-                        intersection.append(snippet);
-                    }
-                    QPolygonF::const_iterator i;
-                    step = 0;
-                    for (i = intersection.constBegin(); i != intersection.constEnd(); ++i) {
-                        if (step == 1) {
-                            // From top-rightmost to bottom-rightmost
-                            // find the leftmost x in that list of points
-                            if (xRight > i->x()) {
-                                xRight = i->x();
-                                if (debug) qDebug() << "Discovered new right hand innermost";
-                            }
-                        } else if (step == 4) {
-                            // From bottom-leftmost to end
-                            // find the leftmost x in that list of points
-                            if (xLeft < i->x()) {
-                                xLeft = i->x();
-                                if (debug) qDebug() << "Discovered new left hand innermost";
-                            }
-                        }
-                        if (*i == cornerPoints[step]) {
-                            ++step;
-                        }
-                    }
+                qreal xLeft{0};
+                qreal xRight{0};
+                if (lineSpan(y, lineHeight, xLeft, xRight)) {
+                    if (debug) qDebug() << "span for line at" << y << "is" << xLeft << "to" << xRight;
                     xLeft = xLeft - margin;
                     xRight = xRight - margin;
                     // we now have our true xLeft and xRight
@@ -365,7 +393,6 @@ public:
             }
 
             textLayout->endLayout();
-            layouts.append(textLayout);
 
             if (!managedToFitEverything) {
                 break;
@@ -374,6 +401,10 @@ public:
                 break;
             }
         }
+        // Any paragraph we didn't get to should not keep the lines from an earlier attempt around
+        for (; p < layouts.size(); ++p) {
+            layouts[p]->clearLayout();
+        }
         return managedToFitEverything;
     }
 
@@ -391,7 +422,9 @@ public:
 
     bool sizeAccepted(int size) {
         setFontSize(size);
-        return attemptLayout();
+        laidOutSize = size;
+        laidOutSuccessfully = attemptLayout();
+        return laidOutSuccessfully;
     }
 
     int findMaxSize(int searchMin, int searchMax) {
@@ -435,9 +468,27 @@ public:
             }
             ++layoutIndex;
         }
+        buildAnchorIndex();
         Q_EMIT q->linkRectsChanged();
     }
 
+    void buildAnchorIndex() {
+        anchorIndex.clear();
+        anchorIndexBounds = QRectF();
+        anchorIndexMaxHeight = 0;
+        QHash<QPair<int, int>, QList<QRectF>>::const_iterator i;
+        for (i = anchorRects.constBegin(); i != anchorRects.constEnd(); ++i) {
+            for (const QRectF& rect : i.value()) {
+                anchorIndex.append({rect, i.key()});
+                anchorIndexBounds = anchorIndexBounds.united(rect);
+                anchorIndexMaxHeight = qMax(anchorIndexMaxHeight, rect.height());
+            }
+        }
+        std::sort(anchorIndex.begin(), anchorIndex.end(), [](const AnchorRect& first, const AnchorRect& second) {
+            return first.rect.top() < second.rect.top();
+        });
+    }
+
     /**
      * Find the identifier pair (used to find formats in the anchorRects variable)
      * which identifies the format for the given local position. If there is none,
@@ -448,32 +499,151 @@ public:
      */
     QPair<int, int> getAnchor(const QPointF& localPos) {
         QPair<int, int> anchor{-1, -1};
-        QHash<QPair<int, int>, QList<QRectF>>::const_iterator i;
-        for (i = anchorRects.constBegin(); i != anchorRects.constEnd(); ++i) {
-            for (const QRectF& rect : i.value()) {
-                if (rect.contains(localPos)) {
-                    anchor = i.key();
+        if (anchorIndexBounds.contains(localPos)) {
+            // Only rects starting above the position can contain it, and none of those which
+            // start more than the tallest rect's height above it can reach down to it either
+            auto candidate = std::upper_bound(anchorIndex.constBegin(), anchorIndex.constEnd(), localPos.y(), [](qreal y, const AnchorRect& entry) {
+                return y < entry.rect.top();
+            });
+            while (candidate != anchorIndex.constBegin()) {
+                --candidate;
+                if (candidate->rect.top() < localPos.y() - anchorIndexMaxHeight) {
+                    break;
+                }
+                if (candidate->rect.contains(localPos)) {
+                    anchor = candidate->anchor;
                     break;
                 }
-            }
-            if (anchor.first > -1 && anchor.second > -1) {
-                break;
             }
         }
         return anchor;
     }
 
+    /**
+     * The key used to find this item's layout in the TextLayoutCache. It covers everything
+     * which goes into the fitting: the text including its markup, the font and style, and
+     * the polygon as transformed into item coordinates (which means it covers scale as well).
+     */
+    QByteArray layoutCacheKey() const {
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        for (const QString& paragraph : paragraphs) {
+            hash.addData(paragraph.toUtf8());
+            hash.addData("\0", 1);
+        }
+        hash.addData(font.toString().toUtf8());
+        const qreal dimensions[3]{q->width(), q->height(), qreal(margin)};
+        hash.addData(reinterpret_cast<const char*>(dimensions), sizeof(dimensions));
+        hash.addData(reinterpret_cast<const char*>(shapePolygon.constData()), int(shapePolygon.size() * sizeof(QPointF)));
+        return hash.result();
+    }
+
+    TextLayoutCache::Entry layoutCacheEntry() const {
+        TextLayoutCache::Entry entry;
+        entry.pixelSize = laidOutSize;
+        entry.fitted = laidOutSuccessfully;
+        for (const QTextLayout* layout : layouts) {
+            QVector<TextLayoutCache::Line> lines;
+            for (int i = 0; i < layout->lineCount(); ++i) {
+                const QTextLine line = layout->lineAt(i);
+                TextLayoutCache::Line cachedLine;
+                cachedLine.position = line.position();
+                cachedLine.width = line.width();
+                cachedLine.textLength = line.textLength();
+                lines.append(cachedLine);
+            }
+            entry.paragraphs.append(lines);
+        }
+        return entry;
+    }
+
+    /**
+     * Lay out the text using the lines stored in a cache entry, without going looking for
+     * the best size. If the lines turn out not to hold the same text they did when the
+     * entry was created (say, the font changed on the system), this returns false and the
+     * layout needs doing properly.
+     */
+    bool replayLayout(const TextLayoutCache::Entry& entry) {
+        setFontSize(entry.pixelSize);
+        for (int p = 0; p < layouts.size(); ++p) {
+            QTextLayout* textLayout = layouts[p];
+            if (p >= entry.paragraphs.size()) {
+                textLayout->clearLayout();
+                continue;
+            }
+            textLayout->setFont(font);
+            textLayout->setFormats(formats[p]);
+            textLayout->beginLayout();
+            bool matches{true};
+            for (const TextLayoutCache::Line& cachedLine : entry.paragraphs[p]) {
+                QTextLine line = textLayout->createLine();
+                if (!line.isValid()) {
+                    matches = false;
+                    break;
+                }
+                line.setLineWidth(cachedLine.width);
+                line.setPosition(cachedLine.position);
+                if (line.textLength() != cachedLine.textLength) {
+                    matches = false;
+                    break;
+                }
+            }
+            textLayout->endLayout();
+            if (!matches) {
+                return false;
+            }
+        }
+        laidOutSize = entry.pixelSize;
+        laidOutSuccessfully = entry.fitted;
+        return true;
+    }
+
     void performLayout() {
         bool debugLayout{false};
         int pixelSize{2};
         margin = shapeMultiplier;
         if (paragraphs.count() > 0 && q->height() > (margin * 2) + pixelSize) {
+            const QByteArray cacheKey = layoutCacheKey();
+            TextLayoutCache::Entry cachedLayout;
+            if (!debugLayout && TextLayoutCache::instance()->find(cacheKey, cachedLayout)) {
+                if (replayLayout(cachedLayout)) {
+                    updateAnchorRects();
+                    return;
+                }
+                TextLayoutCache::instance()->remove(cacheKey);
+            }
             // Now attempt to do the text layouting, squeezing it upwards until it no longer fits
             // Cap it at the size of the polygon, divided by the number of paragraphs, minus our margin
             int maximumSize{(qFloor(shapePolygon.boundingRect().height()) / paragraphs.count()) - margin * 2};
+            // The text cannot possibly fit if it needs more room than the shape has, so use the
+            // area of the shape to pull the top of the search range down. The estimate is based on
+            // the average character width, so leave plenty of slack for narrow text.
+            int characterCount{0};
+            for (const QString& paragraph : qAsConst(internalParagraphs)) {
+                characterCount += paragraph.length();
+            }
+            if (characterCount > 0 && shapeArea > 0) {
+                static const qreal referenceSize{100};
+                QFont referenceFont(font);
+                referenceFont.setPixelSize(referenceSize);
+                QFontMetricsF referenceMetrics(referenceFont);
+                const qreal referenceArea = characterCount * referenceMetrics.averageCharWidth() * referenceMetrics.height();
+                if (referenceArea > 0) {
+                    const int areaLimit = qCeil(2 * referenceSize * qSqrt(shapeArea / referenceArea));
+                    maximumSize = qMin(maximumSize, qMax(pixelSize, areaLimit));
+                }
+            }
             int bestSize = findMaxSize(pixelSize, maximumSize);
-            setFontSize(bestSize);
-            bool layoutSuccessful = attemptLayout(debugLayout);
+            bool layoutSuccessful{laidOutSuccessfully};
+            if (bestSize != laidOutSize || debugLayout) {
+                // The last probe was for some other size, so lay out for the one we actually want
+                setFontSize(bestSize);
+                laidOutSize = bestSize;
+                layoutSuccessful = attemptLayout(debugLayout);
+                laidOutSuccessfully = layoutSuccessful;
+            }
+            if (!zoomedSinceContentChange) {
+                TextLayoutCache::instance()->insert(cacheKey, layoutCacheEntry());
+            }
             if (debugLayout) {
                 qDebug() << "Layout was successful?" << layoutSuccessful << "for the paragraphs" << internalParagraphs;
                 for (QTextLayout* layout : layouts) {
@@ -486,6 +656,7 @@ public:
                 }
             }
         } else {
+            qDeleteAll(layouts);
             layouts.clear();
         }
         updateAnchorRects();
@@ -505,6 +676,52 @@ public:
         transform.rotate(360 - q->rotation());
         shapePolygon = transform.map(shapePolygon);
         q->transform();
+        buildSpanTable();
+    }
+
+    /**
+     * Decompose the polygon into one horizontal span per pixel row of the item. Where a row
+     * crosses the polygon more than once (for example through the tail of a speech balloon),
+     * the widest of the spans is the one we keep, as that is where the text will go.
+     */
+    void buildSpanTable() {
+        spanLeft.clear();
+        spanRight.clear();
+        shapeArea = 0;
+        const int pointCount = shapePolygon.count();
+        const int rows = qCeil(shapePolygon.boundingRect().bottom());
+        if (pointCount < 3 || rows <= 0) {
+            return;
+        }
+        spanLeft.resize(rows);
+        spanRight.resize(rows);
+        const qreal width = q->width();
+        QVector<qreal> crossings;
+        for (int row = 0; row < rows; ++row) {
+            const qreal y = row + 0.5;
+            crossings.clear();
+            for (int i = 0, j = pointCount - 1; i < pointCount; j = i++) {
+                const QPointF& a = shapePolygon.at(i);
+                const QPointF& b = shapePolygon.at(j);
+                if ((a.y() > y) != (b.y() > y)) {
+                    crossings << a.x() + (y - a.y()) * (b.x() - a.x()) / (b.y() - a.y());
+                }
+            }
+            std::sort(crossings.begin(), crossings.end());
+            qreal left{0};
+            qreal right{0};
+            for (int i = 0; i + 1 < crossings.count(); i += 2) {
+                const qreal spanStart = qMax<qreal>(0, crossings.at(i));
+                const qreal spanEnd = qMin(width, crossings.at(i + 1));
+                if (spanEnd - spanStart > right - left) {
+                    left = spanStart;
+                    right = spanEnd;
+                }
+            }
+            spanLeft[row] = left;
+            spanRight[row] = right;
+            shapeArea += right - left;
+        }
     }
 };
 
@@ -518,20 +735,25 @@ TextViewerItem::TextViewerItem(QQuickItem* parent)
     // Because that's what ACBF wants from us, so default that one
     setTransformOrigin(QQuickItem::TopLeft);
 
-    connect(this, &TextViewerItem::shapeChanged, d->throttle, QOverload<>::of(&QTimer::start));
-    connect(this, &TextViewerItem::shapeOffsetChanged, d->throttle, QOverload<>::of(&QTimer::start));
-    connect(this, &TextViewerItem::shapeMultiplierChanged, d->throttle, QOverload<>::of(&QTimer::start));
-    connect(this, &TextViewerItem::paragraphsChanged, d->throttle, QOverload<>::of(&QTimer::start));
-    connect(this, &TextViewerItem::styleChanged, d->throttle, QOverload<>::of(&QTimer::start));
-    connect(this, &TextViewerItem::fontFamilyChanged, d->throttle, QOverload<>::of(&QTimer::start));
-
-    connect(this, &QQuickItem::heightChanged, d->throttle, QOverload<>::of(&QTimer::start));
-    connect(this, &QQuickItem::widthChanged, d->throttle, QOverload<>::of(&QTimer::start));
-    connect(this, &QQuickItem::xChanged, d->throttle, QOverload<>::of(&QTimer::start));
-    connect(this, &QQuickItem::yChanged, d->throttle, QOverload<>::of(&QTimer::start));
-    connect(this, &QQuickItem::rotationChanged, d->throttle, QOverload<>::of(&QTimer::start));
-    connect(this, &QQuickItem::enabledChanged, d->throttle, QOverload<>::of(&QTimer::start));
-    connect(this, &QQuickItem::enabledChanged, d->throttle, QOverload<>::of(&QTimer::start));
+    // Changes to what is being shown need a new layout straight away
+    connect(this, &TextViewerItem::shapeChanged, this, [this](){ d->scheduleLayout(); });
+    connect(this, &TextViewerItem::paragraphsChanged, this, [this](){ d->scheduleLayout(); });
+    connect(this, &TextViewerItem::styleChanged, this, [this](){ d->scheduleLayout(); });
+    connect(this, &TextViewerItem::fontFamilyChanged, this, [this](){ d->scheduleLayout(); });
+    // The shape is counter-rotated to fit the text into it (see buildPolygon()), so the rotation is
+    // part of the shape as far as layout goes. It only changes with the text area's text rotation.
+    connect(this, &QQuickItem::rotationChanged, this, [this](){ d->scheduleLayout(); });
+    // Zooming changes the multiplier, offset and size all at once, and continuously while it
+    // animates, so scale and move the existing text until things settle down (see geometryChanged()
+    // for the size). Position changes are handled by the item's transform, and need nothing.
+    connect(this, &TextViewerItem::shapeOffsetChanged, this, [this](){ d->scheduleScaledLayout(); });
+    connect(this, &TextViewerItem::shapeMultiplierChanged, this, [this](){ d->scheduleScaledLayout(); });
+    // We don't lay out while disabled, so catch up on anything we missed in the meantime
+    connect(this, &QQuickItem::enabledChanged, this, [this](){
+        if (isEnabled() && d->layoutDirty) {
+            d->throttle->start(1);
+        }
+    });
 }
 
 TextViewerItem::~TextViewerItem()
@@ -643,10 +865,16 @@ QString TextViewerItem::hoveredLink() const
 
 void TextViewerItem::updatePolish()
 {
-    if (isEnabled()) {
+    if (isEnabled() && d->layoutDirty) {
+        PerformanceTimer timer("TextViewerItem::performLayout");
         d->buildPolygon();
         d->adjustFormats();
         d->performLayout();
+        d->laidOutSinceContentChange = true;
+        d->layoutDirty = false;
+        d->nodesDirty = true;
+        d->laidOutMultiplier = d->shapeMultiplier;
+        d->laidOutOffset = d->shapeOffset;
         update();
     }
 }
@@ -654,21 +882,49 @@ void TextViewerItem::updatePolish()
 QSGNode * TextViewerItem::updatePaintNode(QSGNode* node, QQuickItem::UpdatePaintNodeData* data)
 {
     Q_UNUSED(data)
-    QQuickTextNode *n = static_cast<QQuickTextNode *>(node);
-    if (!n)
+    // The text node lives inside a transform node, which we use to scale and move the text we already
+    // have while the zoom level is changing, without having to lay anything out again
+    QSGTransformNode *transformNode = static_cast<QSGTransformNode *>(node);
+    if (!transformNode) {
+        transformNode = new QSGTransformNode();
+    }
+    QQuickTextNode *n = static_cast<QQuickTextNode *>(transformNode->firstChild());
+    if (!n) {
         n = new QQuickTextNode(this);
-    n->removeAllChildNodes();
-    for (QTextLayout* layout : d->layouts) {
-        n->addTextLayout(QPoint(0, 0), layout);
+        transformNode->appendChildNode(n);
+        d->nodesDirty = true;
+    }
+    if (d->nodesDirty) {
+        n->removeAllChildNodes();
+        for (QTextLayout* layout : d->layouts) {
+            n->addTextLayout(QPoint(0, 0), layout);
+        }
+        d->nodesDirty = false;
     }
-    return n;
+    // A point laid out at p ends up at (p + laidOutOffset) * scale - shapeOffset once zoomed, with
+    // both offsets counter-rotated the same way as the shape is in buildPolygon()
+    QMatrix4x4 matrix;
+    if (d->laidOutMultiplier > 0) {
+        const qreal scale = d->shapeMultiplier / d->laidOutMultiplier;
+        QTransform rotation;
+        rotation.rotate(360 - this->rotation());
+        const QPointF translation = rotation.map(QPointF(d->laidOutOffset) * scale - QPointF(d->shapeOffset));
+        matrix.translate(translation.x(), translation.y());
+        matrix.scale(scale, scale);
+    }
+    if (transformNode->matrix() != matrix) {
+        transformNode->setMatrix(matrix);
+    }
+    return transformNode;
 }
 
 void TextViewerItem::geometryChanged(const QRectF& newGeometry, const QRectF& oldGeometry)
 {
-    Q_UNUSED(newGeometry)
-    Q_UNUSED(oldGeometry)
-    d->throttle->start();
+    QQuickItem::geometryChanged(newGeometry, oldGeometry);
+    // Only the size has any effect on the layout, moving the item is just a transform
+    if (newGeometry.size() != oldGeometry.size()) {
+        d->scheduleScaledLayout();
+    }
 }
 
 void TextViewerItem::hoverMoveEvent(QHoverEvent* event)
@@ -0,0 +1,228 @@
+/*
+ * Copyright (C) 2026 Dan Leinir Turthra Jensen <admin@leinir.dk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "ThumbnailStore.h"
+
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThreadPool>
+#include <QUrl>
+
+#include <qtquick_debug.h>
+
+namespace {
+    // The sizes from the thumbnail specification, smallest first
+    struct Bucket {
+        int size;
+        const char* directory;
+    };
+    const Bucket buckets[] = {
+        {128, "normal"},
+        {256, "large"},
+        {512, "x-large"},
+        {1024, "xx-large"}
+    };
+    const int bucketCount{4};
+    // Marks the thumbnails we wrote, so we only ever clean up after ourselves
+    const QString softwareName{QStringLiteral("Peruse")};
+    // How long to wait between checking the thumbnails for removed files, in seconds
+    const qint64 garbageCollectionInterval{24 * 60 * 60};
+
+    QString thumbnailRoot()
+    {
+        return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation) + QStringLiteral("/thumbnails");
+    }
+
+    QString thumbnailFileName(const QString& absoluteFilePath)
+    {
+        const QByteArray uri = QUrl::fromLocalFile(absoluteFilePath).toEncoded();
+        return QString::fromLatin1(QCryptographicHash::hash(uri, QCryptographicHash::Md5).toHex()).append(QStringLiteral(".png"));
+    }
+
+    // Whether the thumbnail the reader is pointed at was made from the file as it is now.
+    // This only reads the text chunks at the start of the png, not the image itself.
+    bool isCurrent(QImageReader& reader, const QFileInfo& info)
+    {
+        if (reader.text(QStringLiteral("Thumb::MTime")) != QString::number(info.lastModified().toSecsSinceEpoch())) {
+            return false;
+        }
+        const QString size = reader.text(QStringLiteral("Thumb::Size"));
+        return size.isEmpty() || size == QString::number(info.size());
+    }
+
+    // Removes the thumbnails we wrote for files which are no longer there (or have changed since,
+    // and not been looked at again). This can take a while in a large library, so it runs on the
+    // global pool, and gives up as soon as the application starts shutting down.
+    class ThumbnailGarbageCollector : public QRunnable
+    {
+    public:
+        void run() override {
+            int removed{0};
+            for (int bucket = 0; bucket < bucketCount; ++bucket) {
+                QDirIterator it(QString("%1/%2").arg(thumbnailRoot()).arg(buckets[bucket].directory), QStringList{QStringLiteral("*.png")}, QDir::Files);
+                while (it.hasNext()) {
+                    if (QCoreApplication::closingDown()) {
+                        return;
+                    }
+                    const QString thumbnail = it.next();
+                    QImageReader reader(thumbnail, "png");
+                    if (reader.text(QStringLiteral("Software")) != softwareName) {
+                        continue;
+                    }
+                    const QUrl url(reader.text(QStringLiteral("Thumb::URI")));
+                    if (!url.isLocalFile()) {
+                        continue;
+                    }
+                    const QFileInfo info(url.toLocalFile());
+                    if (!info.exists() || !isCurrent(reader, info)) {
+                        QFile::remove(thumbnail);
+                        ++removed;
+                    }
+                }
+            }
+            qCDebug(QTQUICK_LOG) << "Removed" << removed << "outdated thumbnails";
+        }
+    };
+}
+
+class ThumbnailStore::Private {
+public:
+    Private() {}
+
+    static int bucketIndex(const QSize& requestedSize) {
+        const int edge = qMax(requestedSize.width(), requestedSize.height());
+        for (int bucket = 0; bucket < bucketCount; ++bucket) {
+            if (edge <= buckets[bucket].size) {
+                return bucket;
+            }
+        }
+        return bucketCount - 1;
+    }
+
+    // Start the garbage collection, unless it has already been done recently
+    void collectGarbageIfDue() {
+        const QString cacheDir = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+        QDir().mkpath(cacheDir);
+        QFile stamp(QString("%1/thumbnails-checked").arg(cacheDir));
+        const QFileInfo stampInfo(stamp);
+        if (stampInfo.exists() && stampInfo.lastModified().secsTo(QDateTime::currentDateTime()) < garbageCollectionInterval) {
+            return;
+        }
+        // Touching the stamp first means a crash in the middle does not cause it to start over every time
+        if (stamp.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            stamp.close();
+        }
+        QThreadPool::globalInstance()->start(new ThumbnailGarbageCollector());
+    }
+};
+
+ThumbnailStore* ThumbnailStore::instance()
+{
+    // Requests come in on the image loading threads, so this needs to be safe to create from any of them
+    static ThumbnailStore store;
+    return &store;
+}
+
+ThumbnailStore::ThumbnailStore()
+    : d(new Private)
+{
+    d->collectGarbageIfDue();
+}
+
+ThumbnailStore::~ThumbnailStore()
+{
+    delete d;
+}
+
+int ThumbnailStore::bucketSize(const QSize& requestedSize)
+{
+    return buckets[Private::bucketIndex(requestedSize)].size;
+}
+
+QImage ThumbnailStore::find(const QString& fileName, const QSize& requestedSize) const
+{
+    const QFileInfo info(fileName);
+    if (!info.exists()) {
+        return QImage();
+    }
+    const QString name = thumbnailFileName(info.absoluteFilePath());
+    // Prefer the bucket the size belongs in, but a larger thumbnail is better than making a new one
+    for (int bucket = Private::bucketIndex(requestedSize); bucket < bucketCount; ++bucket) {
+        const QString thumbnail = QString("%1/%2/%3").arg(thumbnailRoot()).arg(buckets[bucket].directory).arg(name);
+        if (!QFile::exists(thumbnail)) {
+            continue;
+        }
+        QImageReader reader(thumbnail, "png");
+        if (!isCurrent(reader, info)) {
+            continue;
+        }
+        const QImage image = reader.read();
+        if (!image.isNull()) {
+            return image;
+        }
+    }
+    return QImage();
+}
+
+QImage ThumbnailStore::insert(const QString& fileName, const QSize& requestedSize, const QImage& image)
+{
+    const int size = bucketSize(requestedSize);
+    QImage thumbnail = image;
+    if (thumbnail.width() > size || thumbnail.height() > size) {
+        thumbnail = thumbnail.scaled(size, size, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    }
+    const QFileInfo info(fileName);
+    if (thumbnail.isNull() || !info.exists()) {
+        return thumbnail;
+    }
+
+    const QString directory = QString("%1/%2").arg(thumbnailRoot()).arg(buckets[Private::bucketIndex(requestedSize)].directory);
+    if (!QFileInfo::exists(directory)) {
+        QDir().mkpath(directory);
+        QFile::setPermissions(directory, QFileDevice::ReadOwner | QFileDevice::WriteOwner | QFileDevice::ExeOwner);
+    }
+
+    QImage stored = thumbnail;
+    stored.setText(QStringLiteral("Thumb::URI"), QUrl::fromLocalFile(info.absoluteFilePath()).toString(QUrl::FullyEncoded));
+    stored.setText(QStringLiteral("Thumb::MTime"), QString::number(info.lastModified().toSecsSinceEpoch()));
+    stored.setText(QStringLiteral("Thumb::Size"), QString::number(info.size()));
+    stored.setText(QStringLiteral("Software"), softwareName);
+
+    // Write to a temporary file and move that into place, so nobody ever reads a half written thumbnail
+    const QString path = QString("%1/%2").arg(directory).arg(thumbnailFileName(info.absoluteFilePath()));
+    QSaveFile file(path);
+    if (file.open(QIODevice::WriteOnly) && stored.save(&file, "png") && file.commit()) {
+        QFile::setPermissions(path, QFileDevice::ReadOwner | QFileDevice::WriteOwner);
+    } else {
+        qCDebug(QTQUICK_LOG) << "Failed to store the thumbnail for" << fileName << "in" << path;
+    }
+    return thumbnail;
+}
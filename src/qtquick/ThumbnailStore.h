@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2026 Dan Leinir Turthra Jensen <admin@leinir.dk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef THUMBNAILSTORE_H
+#define THUMBNAILSTORE_H
+
+#include <QImage>
+#include <QSize>
+#include <QString>
+
+/**
+ * \brief The on-disk store for the covers and previews shown in the library
+ *
+ * Each of the cover providers used to cache its thumbnails in its own way (keyed by the
+ * file name only, or not invalidated at all), so a book which was replaced by a new file
+ * of the same name kept showing the old cover.
+ *
+ * The store uses the layout described by the freedesktop.org thumbnail specification,
+ * in the shared thumbnail directory, so thumbnails made by Peruse are shared with (and
+ * can be taken from) the file manager and anything else using KIO's previews. Every
+ * thumbnail records the modification time and size of the file it was made from, and
+ * a thumbnail which does not match the file as it is now is never returned.
+ *
+ * Thumbnails are stored in four size buckets (128, 256, 512 and 1024 pixels), and a
+ * request is served from the smallest bucket which is at least as large as the size
+ * requested, falling back to the larger ones.
+ *
+ * Once a day, the thumbnails written by Peruse are checked in the background, and those
+ * of files which no longer exist are removed.
+ *
+ * All functions are safe to call from any thread.
+ */
+class ThumbnailStore
+{
+public:
+    /**
+     * @return The store shared by everything in this process.
+     */
+    static ThumbnailStore* instance();
+    ~ThumbnailStore();
+
+    /**
+     * @param requestedSize The size the thumbnail is wanted in
+     * @return The edge length of the bucket thumbnails of that size are stored in. This
+     * is the size a thumbnail should be made in before passing it to insert().
+     */
+    static int bucketSize(const QSize& requestedSize);
+
+    /**
+     * \brief Get the thumbnail for a file, if there is a valid one.
+     * @param fileName The local file to get the thumbnail of
+     * @param requestedSize The size the thumbnail is wanted in
+     * @return The stored thumbnail (in the size it was stored in), or a null image if there
+     * is no thumbnail for the file as it is now
+     */
+    QImage find(const QString& fileName, const QSize& requestedSize) const;
+    /**
+     * \brief Store the thumbnail for a file.
+     * Images larger than the bucket for the requested size are scaled down to fit it.
+     * @param fileName The local file the thumbnail was made from
+     * @param requestedSize The size the thumbnail was requested in
+     * @param image The thumbnail
+     * @return The image as it was stored (that is, possibly scaled down)
+     */
+    QImage insert(const QString& fileName, const QSize& requestedSize, const QImage& image);
+private:
+    ThumbnailStore();
+    class Private;
+    Private* d;
+};
+
+#endif//THUMBNAILSTORE_H
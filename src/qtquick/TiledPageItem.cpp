@@ -0,0 +1,687 @@
+/*
+ * Copyright (C) 2026 Dan Leinir Turthra Jensen <admin@leinir.dk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "TiledPageItem.h"
+#include "ArchiveBookModel.h"
+#include "DecodeScheduler.h"
+#include "ImageTextureFactory.h"
+
+#include <AcbfBinary.h>
+#include <AcbfDocument.h>
+
+#include <karchivefile.h>
+
+#include <QBuffer>
+#include <QCache>
+#include <QFile>
+#include <QImageReader>
+#include <QMutex>
+#include <QPointer>
+#include <QQuickWindow>
+#include <QRunnable>
+#include <QSGSimpleTextureNode>
+#include <QTimer>
+#include <QUrl>
+
+#include <qtquick_debug.h>
+
+namespace {
+    // The width and height of a tile, in the pixels of the level it belongs to
+    const int tileSize{512};
+    // How much decoded tile data all the items together hold on to, in KiB
+    const int tileCacheSize{96 * 1024};
+    // How much all the items together hold on to of decoded levels, in KiB
+    const int levelCacheSize{128 * 1024};
+    const int maximumLevel{8};
+
+    quint64 tileKey(int level, int column, int row) {
+        return (quint64(level) << 48) | (quint64(row) << 24) | quint64(column);
+    }
+    int tileLevel(quint64 key) {
+        return int(key >> 48);
+    }
+    int tileRow(quint64 key) {
+        return int((key >> 24) & 0xffffff);
+    }
+    int tileColumn(quint64 key) {
+        return int(key & 0xffffff);
+    }
+
+    // The size of the page image on the given level of the pyramid
+    QSize levelSize(const QSize& sourceSize, int level) {
+        const int divisor = 1 << level;
+        return QSize((sourceSize.width() + divisor - 1) / divisor, (sourceSize.height() + divisor - 1) / divisor);
+    }
+    // The area covered by the tile, in the pixels of its level
+    QRect tileRect(const QSize& sourceSize, quint64 key) {
+        return QRect(tileColumn(key) * tileSize, tileRow(key) * tileSize, tileSize, tileSize)
+            .intersected(QRect(QPoint(0, 0), levelSize(sourceSize, tileLevel(key))));
+    }
+
+    // The decoded tiles of every item, by item and tile key, which may or may not have been uploaded.
+    // Sharing the one budget means the memory used does not grow with the number of pages a view
+    // keeps around. This is only used on the gui thread, and on the render thread while the gui
+    // thread is blocked, so it needs no locking.
+    typedef QPair<quintptr, quint64> CachedTileKey;
+    QCache<CachedTileKey, QImage>& tileCache() {
+        static QCache<CachedTileKey, QImage> cache(tileCacheSize);
+        return cache;
+    }
+
+    // For images in formats which cannot decode just a part of the image, the last level of the
+    // pyramid decoded for each item, so tiles coming into view while panning around can be cut from
+    // it, rather than decoding the whole level again. Used in the same way as the tile cache.
+    struct DecodedLevel {
+        int level;
+        QImage image;
+    };
+    QCache<quintptr, DecodedLevel>& levelCache() {
+        static QCache<quintptr, DecodedLevel> cache(levelCacheSize);
+        return cache;
+    }
+}
+
+/**
+ * Reads the page image (or just enough of it to know its size) from wherever it lives
+ */
+class TiledPageSourceRunnable : public QObject, public QRunnable
+{
+    Q_OBJECT
+public:
+    TiledPageSourceRunnable(const QString& source, ArchiveBookModel* bookModel, bool loadData)
+        : source(source)
+        , bookModel(bookModel)
+        , loadData(loadData)
+    {
+        setAutoDelete(false);
+    }
+
+    void abort() {
+        QMutexLocker locker(&abortMutex);
+        aborted = true;
+    }
+    bool isAborted() {
+        QMutexLocker locker(&abortMutex);
+        return aborted;
+    }
+
+    void run() override {
+        QByteArray data;
+        QSize size;
+        bool canClip{false};
+        auto probe = [&size, &canClip](QIODevice* device) {
+            QImageReader reader(device);
+            size = reader.size();
+            canClip = reader.supportsOption(QImageIOHandler::ScaledClipRect);
+        };
+        if (source.startsWith(QStringLiteral("image://"))) {
+            // That is, image://prefix/the/entry/in/the/archive
+            const QString id = source.section(QLatin1Char('/'), 3);
+            if (bookModel && id.startsWith(QLatin1Char('#'))) {
+                auto document = qobject_cast<AdvancedComicBookFormat::Document*>(bookModel->acbfData());
+                auto binary = document ? qobject_cast<AdvancedComicBookFormat::Binary*>(document->objectByID(id.mid(1))) : nullptr;
+                if (binary) {
+                    data = binary->data();
+                }
+            } else if (bookModel) {
+                QMutexLocker locker(&bookModel->archiveMutex);
+                const KArchiveFile* entry = bookModel->archiveFile(id);
+                if (entry && !isAborted()) {
+                    QIODevice* device = loadData ? nullptr : entry->createDevice();
+                    if (device) {
+                        // Only the header is needed for the size, so don't inflate the whole entry
+                        probe(device);
+                        delete device;
+                    } else {
+                        data = entry->data();
+                    }
+                }
+            }
+        } else {
+            QFile file(QUrl(source).toLocalFile());
+            if (!loadData) {
+                if (file.open(QIODevice::ReadOnly)) {
+                    probe(&file);
+                }
+            } else if (file.open(QIODevice::ReadOnly)) {
+                data = file.readAll();
+            }
+        }
+        if (!data.isEmpty() && !isAborted()) {
+            QBuffer buffer(&data);
+            buffer.open(QIODevice::ReadOnly);
+            probe(&buffer);
+        }
+        if (!loadData) {
+            data.clear();
+        }
+        if (!isAborted()) {
+            Q_EMIT done(data, size, canClip);
+        }
+        Q_EMIT finished();
+    }
+
+    Q_SIGNAL void done(const QByteArray& data, const QSize& size, bool canClip);
+    Q_SIGNAL void finished();
+
+    const QString source;
+    ArchiveBookModel* bookModel{nullptr};
+    const bool loadData{false};
+private:
+    QMutex abortMutex;
+    bool aborted{false};
+};
+
+/**
+ * Decodes a set of tiles from one level of the pyramid
+ */
+class TiledPageTileRunnable : public QObject, public QRunnable
+{
+    Q_OBJECT
+public:
+    TiledPageTileRunnable(const QByteArray& data, int level, const QSize& levelSize, const QHash<quint64, QRect>& tiles)
+        : data(data)
+        , level(level)
+        , levelSize(levelSize)
+        , tiles(tiles)
+    {
+        setAutoDelete(false);
+    }
+
+    void abort() {
+        QMutexLocker locker(&abortMutex);
+        aborted = true;
+    }
+    bool isAborted() {
+        QMutexLocker locker(&abortMutex);
+        return aborted;
+    }
+
+    void run() override {
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::ReadOnly);
+        QImageReader reader(&buffer);
+        reader.setScaledSize(levelSize);
+        if (tiles.count() == 1) {
+            // The image format can decode just the part we want, at the scale we want
+            reader.setScaledClipRect(tiles.constBegin().value());
+            const QImage image = reader.read();
+            if (!isAborted()) {
+                Q_EMIT done(tiles.constBegin().key(), ImageTextureFactory::prepareImage(image, true));
+            }
+        } else if (!isAborted()) {
+            // The image format has to be decoded in full anyway, so cut all the tiles out of it in one go,
+            // and pass the level on so any further tiles can be cut from it as well
+            const QImage image = reader.read();
+            if (!image.isNull() && !isAborted()) {
+                Q_EMIT levelDone(level, image);
+            }
+            for (auto it = tiles.constBegin(); it != tiles.constEnd() && !isAborted(); ++it) {
+                Q_EMIT done(it.key(), ImageTextureFactory::prepareImage(image.copy(it.value()), true));
+            }
+        }
+        if (reader.error() != QImageReader::UnknownError) {
+            qCDebug(QTQUICK_LOG) << "Failed to decode a page tile:" << reader.errorString();
+        }
+        Q_EMIT finished();
+    }
+
+    QList<quint64> keys() const {
+        return tiles.keys();
+    }
+
+    Q_SIGNAL void done(quint64 key, const QImage& image);
+    Q_SIGNAL void levelDone(int level, const QImage& image);
+    Q_SIGNAL void finished();
+private:
+    QByteArray data;
+    const int level;
+    const QSize levelSize;
+    const QHash<quint64, QRect> tiles;
+    QMutex abortMutex;
+    bool aborted{false};
+};
+
+/**
+ * The tiles currently in the scene graph
+ */
+class TiledPageNode : public QSGNode
+{
+public:
+    QHash<quint64, QSGSimpleTextureNode*> tiles;
+    // The generation of the item the tiles were uploaded for
+    int generation{0};
+};
+
+class TiledPageItem::Private {
+public:
+    Private(TiledPageItem* qq)
+        : q(qq)
+    {
+        // Not restarted by further changes, so tiles keep coming in while panning and zooming
+        updateTimer = new QTimer(qq);
+        updateTimer->setInterval(100);
+        updateTimer->setSingleShot(true);
+        QObject::connect(updateTimer, &QTimer::timeout, qq, [this](){ updateTiles(); });
+    }
+    TiledPageItem* q;
+    QTimer* updateTimer{nullptr};
+
+    QString source;
+    QPointer<QObject> bookModel;
+    QSize sourceSize;
+    QRectF viewport;
+    bool active{false};
+
+    // The encoded page image, which is only held on to while the item is active
+    QByteArray data;
+    // Whether the image format supports decoding just a part of the image
+    bool canClip{false};
+    // Set when the image could not be read, so we don't keep trying
+    bool sourceFailed{false};
+    TiledPageSourceRunnable* sourceJob{nullptr};
+    QList<TiledPageTileRunnable*> tileJobs;
+    // The keys of the tiles we have put into the tile cache (some of which may have been evicted since)
+    QSet<quint64> cachedTiles;
+    // The tiles which should be drawn, and the ones which are in the scene graph already
+    QSet<quint64> visibleTiles;
+    QSet<quint64> uploadedTiles;
+    // The level of the pyramid the tiles are currently wanted from
+    int currentLevel{-1};
+    // Increased whenever everything loaded for the current source is let go of, which tells
+    // updatePaintNode() to throw away all the tiles in the scene graph
+    int generation{0};
+
+    const QImage* cachedTile(quint64 key) const {
+        return tileCache().object(CachedTileKey(quintptr(this), key));
+    }
+    void cacheTile(quint64 key, const QImage& image) {
+        tileCache().insert(CachedTileKey(quintptr(this), key), new QImage(image), qMax(1, int(image.sizeInBytes() / 1024)));
+        cachedTiles.insert(key);
+    }
+    void clearCachedTiles() {
+        for (quint64 key : qAsConst(cachedTiles)) {
+            tileCache().remove(CachedTileKey(quintptr(this), key));
+        }
+        cachedTiles.clear();
+        levelCache().remove(quintptr(this));
+    }
+    const QImage* decodedLevel(int level) const {
+        const DecodedLevel* decoded = levelCache().object(quintptr(this));
+        return (decoded && decoded->level == level) ? &decoded->image : nullptr;
+    }
+
+    void scheduleUpdate() {
+        if (!updateTimer->isActive()) {
+            updateTimer->start();
+        }
+    }
+
+    void startSourceJob(bool loadData) {
+        if (sourceJob && (sourceJob->loadData || !loadData)) {
+            return;
+        }
+        cancelSourceJob();
+        sourceJob = new TiledPageSourceRunnable(source, qobject_cast<ArchiveBookModel*>(bookModel), loadData);
+        TiledPageSourceRunnable* job = sourceJob;
+        QObject::connect(job, &TiledPageSourceRunnable::done, q, [this, job](const QByteArray& newData, const QSize& newSize, bool newCanClip){
+            if (sourceJob != job) {
+                return;
+            }
+            sourceJob = nullptr;
+            if (newSize != sourceSize) {
+                sourceSize = newSize;
+                Q_EMIT q->sourceSizeChanged();
+            }
+            if (job->loadData) {
+                if (newData.isEmpty() || !newSize.isValid()) {
+                    qCDebug(QTQUICK_LOG) << "Could not read the page image for tiling" << source;
+                    sourceFailed = true;
+                }
+                data = newData;
+                canClip = newCanClip;
+                updateTiles();
+            }
+        });
+        QObject::connect(job, &TiledPageSourceRunnable::finished, job, &QObject::deleteLater, Qt::QueuedConnection);
+        DecodeScheduler::instance()->schedule(job, loadData ? DecodeScheduler::VisiblePage : DecodeScheduler::NearbyPage);
+    }
+
+    void cancelSourceJob() {
+        if (sourceJob) {
+            QObject::disconnect(sourceJob, nullptr, q, nullptr);
+            if (DecodeScheduler::instance()->cancel(sourceJob)) {
+                // Never started, so it won't be finishing either
+                sourceJob->deleteLater();
+            } else {
+                sourceJob->abort();
+            }
+            sourceJob = nullptr;
+        }
+    }
+
+    void startTileJob(int level, const QSize& size, const QHash<quint64, QRect>& jobTiles) {
+        TiledPageTileRunnable* job = new TiledPageTileRunnable(data, level, size, jobTiles);
+        QObject::connect(job, &TiledPageTileRunnable::done, q, [this](quint64 key, const QImage& image){
+            if (!image.isNull()) {
+                cacheTile(key, image);
+                if (visibleTiles.contains(key)) {
+                    q->update();
+                }
+            }
+        });
+        QObject::connect(job, &TiledPageTileRunnable::levelDone, q, [this](int level, const QImage& image){
+            if (level == currentLevel) {
+                levelCache().insert(quintptr(this), new DecodedLevel{level, image}, qMax(1, int(image.sizeInBytes() / 1024)));
+                // Anything which came into view while this was being decoded can now be cut from it
+                scheduleUpdate();
+            }
+        });
+        QObject::connect(job, &TiledPageTileRunnable::finished, q, [this, job](){ tileJobs.removeAll(job); });
+        QObject::connect(job, &TiledPageTileRunnable::finished, job, &QObject::deleteLater, Qt::QueuedConnection);
+        tileJobs.append(job);
+        DecodeScheduler::instance()->schedule(job, DecodeScheduler::VisiblePage);
+    }
+
+    void cancelTileJob(TiledPageTileRunnable* job) {
+        QObject::disconnect(job, nullptr, q, nullptr);
+        if (DecodeScheduler::instance()->cancel(job)) {
+            job->deleteLater();
+        } else {
+            job->abort();
+        }
+    }
+
+    void cancelJobs() {
+        cancelSourceJob();
+        for (TiledPageTileRunnable* job : qAsConst(tileJobs)) {
+            cancelTileJob(job);
+        }
+        tileJobs.clear();
+    }
+
+    // Let go of everything loaded for the current source
+    void reset() {
+        cancelJobs();
+        sourceFailed = false;
+        data.clear();
+        clearCachedTiles();
+        currentLevel = -1;
+        visibleTiles.clear();
+        uploadedTiles.clear();
+        ++generation;
+        q->update();
+    }
+
+    // Work out which tiles are needed for the current viewport and scale, and start decoding any we don't have
+    void updateTiles() {
+        updateTimer->stop();
+        if (!active) {
+            reset();
+            // The size is still useful for laying things out on top of the page
+            if (sourceSize.isEmpty() && !source.isEmpty()) {
+                startSourceJob(false);
+            }
+            return;
+        }
+        QSet<quint64> wanted;
+        int level{0};
+        if (!sourceSize.isEmpty() && q->width() > 0 && q->height() > 0) {
+            if (data.isEmpty()) {
+                if (!sourceFailed) {
+                    startSourceJob(true);
+                }
+            } else {
+                // Pick the smallest level which still has at least as many pixels as the screen shows
+                const qreal devicePixelRatio = q->window() ? q->window()->effectiveDevicePixelRatio() : 1.0;
+                const qreal displayScale = q->width() * devicePixelRatio / sourceSize.width();
+                while (level < maximumLevel && displayScale * (1 << (level + 1)) <= 1.0) {
+                    ++level;
+                }
+                if (level != currentLevel) {
+                    currentLevel = level;
+                    levelCache().remove(quintptr(this));
+                }
+                const QSize size = levelSize(sourceSize, level);
+                const QRectF visible = viewport.intersected(q->boundingRect());
+                if (!visible.isEmpty()) {
+                    const qreal horizontalScale = size.width() / q->width();
+                    const qreal verticalScale = size.height() / q->height();
+                    const int firstColumn = qMax(0, int(visible.left() * horizontalScale) / tileSize);
+                    const int lastColumn = qMin((size.width() - 1) / tileSize, int(visible.right() * horizontalScale) / tileSize);
+                    const int firstRow = qMax(0, int(visible.top() * verticalScale) / tileSize);
+                    const int lastRow = qMin((size.height() - 1) / tileSize, int(visible.bottom() * verticalScale) / tileSize);
+                    for (int row = firstRow; row <= lastRow; ++row) {
+                        for (int column = firstColumn; column <= lastColumn; ++column) {
+                            wanted.insert(tileKey(level, column, row));
+                        }
+                    }
+                }
+            }
+        } else if (sourceSize.isEmpty() && !source.isEmpty() && !sourceFailed) {
+            // Still only looking for the size, so read the whole image while we're at it
+            startSourceJob(true);
+        }
+
+        // Stop decoding anything which has gone out of view (or is from the wrong level)
+        QSet<quint64> pending;
+        for (auto it = tileJobs.begin(); it != tileJobs.end();) {
+            const QList<quint64> jobKeys = (*it)->keys();
+            bool needed{false};
+            for (quint64 key : jobKeys) {
+                if (wanted.contains(key)) {
+                    needed = true;
+                    break;
+                }
+            }
+            if (needed) {
+                for (quint64 key : jobKeys) {
+                    pending.insert(key);
+                }
+                ++it;
+            } else {
+                cancelTileJob(*it);
+                it = tileJobs.erase(it);
+            }
+        }
+
+        QHash<quint64, QRect> missing;
+        for (quint64 key : qAsConst(wanted)) {
+            if (!cachedTile(key) && !uploadedTiles.contains(key) && !pending.contains(key)) {
+                missing.insert(key, tileRect(sourceSize, key));
+            }
+        }
+        if (!missing.isEmpty()) {
+            const QSize size = levelSize(sourceSize, level);
+            if (canClip) {
+                // One job per tile, so they can be decoded in parallel
+                for (auto it = missing.constBegin(); it != missing.constEnd(); ++it) {
+                    startTileJob(level, size, QHash<quint64, QRect>{{it.key(), it.value()}});
+                }
+            } else if (const QImage* decoded = decodedLevel(level)) {
+                for (auto it = missing.constBegin(); it != missing.constEnd(); ++it) {
+                    cacheTile(it.key(), ImageTextureFactory::prepareImage(decoded->copy(it.value()), true));
+                }
+            } else if (tileJobs.isEmpty()) {
+                // Whatever is still missing once the level is decoded is cut from it then
+                startTileJob(level, size, missing);
+            }
+        }
+        visibleTiles = wanted;
+        q->update();
+    }
+};
+
+TiledPageItem::TiledPageItem(QQuickItem* parent)
+    : QQuickItem(parent)
+    , d(new Private(this))
+{
+    setFlag(ItemHasContents, true);
+}
+
+TiledPageItem::~TiledPageItem()
+{
+    d->cancelJobs();
+    d->clearCachedTiles();
+    delete d;
+}
+
+QString TiledPageItem::source() const
+{
+    return d->source;
+}
+
+void TiledPageItem::setSource(const QString& newSource)
+{
+    if (d->source != newSource) {
+        d->source = newSource;
+        d->reset();
+        if (d->sourceSize.isValid()) {
+            d->sourceSize = QSize();
+            Q_EMIT sourceSizeChanged();
+        }
+        if (!d->source.isEmpty()) {
+            d->startSourceJob(d->active);
+        }
+        Q_EMIT sourceChanged();
+    }
+}
+
+QObject* TiledPageItem::bookModel() const
+{
+    return d->bookModel;
+}
+
+void TiledPageItem::setBookModel(QObject* newBookModel)
+{
+    if (d->bookModel != newBookModel) {
+        d->bookModel = newBookModel;
+        // The source may well have been set before the model, in which case it could not be read
+        d->reset();
+        if (!d->source.isEmpty()) {
+            d->startSourceJob(d->active);
+        }
+        Q_EMIT bookModelChanged();
+    }
+}
+
+QSize TiledPageItem::sourceSize() const
+{
+    return d->sourceSize;
+}
+
+QRectF TiledPageItem::viewport() const
+{
+    return d->viewport;
+}
+
+void TiledPageItem::setViewport(const QRectF& newViewport)
+{
+    if (d->viewport != newViewport) {
+        d->viewport = newViewport;
+        if (d->active) {
+            d->scheduleUpdate();
+        }
+        Q_EMIT viewportChanged();
+    }
+}
+
+bool TiledPageItem::active() const
+{
+    return d->active;
+}
+
+void TiledPageItem::setActive(bool newActive)
+{
+    if (d->active != newActive) {
+        d->active = newActive;
+        d->updateTiles();
+        Q_EMIT activeChanged();
+    }
+}
+
+QSGNode * TiledPageItem::updatePaintNode(QSGNode* node, QQuickItem::UpdatePaintNodeData* data)
+{
+    Q_UNUSED(data)
+    TiledPageNode* pageNode = static_cast<TiledPageNode*>(node);
+    if (!pageNode) {
+        // Either the first time round, or the scene graph threw away our old nodes
+        pageNode = new TiledPageNode();
+        pageNode->generation = d->generation;
+        d->uploadedTiles.clear();
+    } else if (pageNode->generation != d->generation) {
+        // Whatever is in the scene graph belongs to what we showed before, even if the keys match
+        pageNode->removeAllChildNodes();
+        qDeleteAll(pageNode->tiles);
+        pageNode->tiles.clear();
+        pageNode->generation = d->generation;
+        d->uploadedTiles.clear();
+    }
+    // Tiles which are no longer visible give up their textures straight away
+    for (auto it = pageNode->tiles.begin(); it != pageNode->tiles.end();) {
+        if (d->visibleTiles.contains(it.key())) {
+            ++it;
+        } else {
+            pageNode->removeChildNode(it.value());
+            delete it.value();
+            d->uploadedTiles.remove(it.key());
+            it = pageNode->tiles.erase(it);
+        }
+    }
+    for (quint64 key : qAsConst(d->visibleTiles)) {
+        QSGSimpleTextureNode* tileNode = pageNode->tiles.value(key);
+        if (!tileNode) {
+            const QImage* image = d->cachedTile(key);
+            if (!image || !window()) {
+                continue;
+            }
+            tileNode = new QSGSimpleTextureNode();
+            tileNode->setTexture(ImageTextureFactory(*image).createTexture(window()));
+            tileNode->setOwnsTexture(true);
+            tileNode->setFiltering(QSGTexture::Linear);
+            pageNode->appendChildNode(tileNode);
+            pageNode->tiles.insert(key, tileNode);
+            d->uploadedTiles.insert(key);
+        }
+        // The item's size changes while zooming, so place the tiles every time
+        const QSize size = levelSize(d->sourceSize, tileLevel(key));
+        const QRect rect = tileRect(d->sourceSize, key);
+        const qreal horizontalScale = width() / size.width();
+        const qreal verticalScale = height() / size.height();
+        const QRectF tileArea(rect.x() * horizontalScale, rect.y() * verticalScale, rect.width() * horizontalScale, rect.height() * verticalScale);
+        if (tileNode->rect() != tileArea) {
+            tileNode->setRect(tileArea);
+        }
+    }
+    return pageNode;
+}
+
+void TiledPageItem::geometryChanged(const QRectF& newGeometry, const QRectF& oldGeometry)
+{
+    QQuickItem::geometryChanged(newGeometry, oldGeometry);
+    if (newGeometry.size() != oldGeometry.size() && d->active) {
+        d->scheduleUpdate();
+        update();
+    }
+}
+
+// This needs to be included since we define QObject subclasses here in the C++ file.
+#include "TiledPageItem.moc"
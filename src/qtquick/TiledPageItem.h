@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2026 Dan Leinir Turthra Jensen <admin@leinir.dk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TILEDPAGEITEM_H
+#define TILEDPAGEITEM_H
+
+#include <QQuickItem>
+
+/**
+ * A QQuickItem which draws the visible part of a page image at the resolution it is shown at
+ *
+ * A single image can only be shown at the resolution it was decoded at, and no larger than the
+ * maximum texture size of the graphics hardware, so a high resolution scan is either shown
+ * blurry when zoomed into, or uses up a lot of memory (both normal and graphics) all the time.
+ *
+ * This item instead splits the page into tiles, in a pyramid of levels which each halve the
+ * resolution of the one before it. Only the tiles visible in the viewport, from the level which
+ * matches the current zoom, are decoded (using the DecodeScheduler) and uploaded. Tiles which
+ * are not yet available are simply not drawn, so the item is intended to be put on top of an
+ * Image showing the whole page at a lower resolution.
+ *
+ * Formats which can decode just a part of an image (such as jpeg) get one decode per tile. For
+ * the others (such as png), the whole level is decoded once, and held on to (within a budget
+ * shared by all the items) for cutting out the tiles which come into view later.
+ */
+class TiledPageItem : public QQuickItem
+{
+    Q_OBJECT
+    /**
+     * The url of the page image, as found in a BookModel (that is, either a page in an
+     * ArchiveBookModel's image provider, or a local file url)
+     */
+    Q_PROPERTY(QString source READ source WRITE setSource NOTIFY sourceChanged)
+    /**
+     * The book the page belongs to. This is needed for pages inside archives.
+     */
+    Q_PROPERTY(QObject* bookModel READ bookModel WRITE setBookModel NOTIFY bookModelChanged)
+    /**
+     * The size of the page image at full resolution (invalid until this has been read from
+     * the image)
+     */
+    Q_PROPERTY(QSize sourceSize READ sourceSize NOTIFY sourceSizeChanged)
+    /**
+     * The part of the item which is visible, in the item's own coordinates. Only tiles
+     * inside this rectangle are decoded and shown.
+     */
+    Q_PROPERTY(QRectF viewport READ viewport WRITE setViewport NOTIFY viewportChanged)
+    /**
+     * Whether the item should show anything. When it is not active, no tiles are decoded,
+     * and any tiles decoded earlier are thrown away.
+     */
+    Q_PROPERTY(bool active READ active WRITE setActive NOTIFY activeChanged)
+public:
+    explicit TiledPageItem(QQuickItem *parent = nullptr);
+    ~TiledPageItem() override;
+
+    QString source() const;
+    void setSource(const QString& newSource);
+    Q_SIGNAL void sourceChanged();
+
+    QObject* bookModel() const;
+    void setBookModel(QObject* newBookModel);
+    Q_SIGNAL void bookModelChanged();
+
+    QSize sourceSize() const;
+    Q_SIGNAL void sourceSizeChanged();
+
+    QRectF viewport() const;
+    void setViewport(const QRectF& newViewport);
+    Q_SIGNAL void viewportChanged();
+
+    bool active() const;
+    void setActive(bool newActive);
+    Q_SIGNAL void activeChanged();
+protected:
+    QSGNode *updatePaintNode(QSGNode *, UpdatePaintNodeData *) override;
+    void geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry) override;
+
+private:
+    class Private;
+    Private* d;
+};
+
+#endif//TILEDPAGEITEM_H
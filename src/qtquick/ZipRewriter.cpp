@@ -0,0 +1,672 @@
+/*
+ * Copyright (C) 2026 Dan Leinir Turthra Jensen <admin@leinir.dk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ZipRewriter.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QLockFile>
+#include <QSaveFile>
+#include <QVector>
+#include <QtEndian>
+
+#include <array>
+
+#ifdef Q_OS_WIN
+#include <io.h>
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include <qtquick_debug.h>
+
+namespace {
+    const quint32 localHeaderSignature{0x04034b50};
+    const quint32 centralHeaderSignature{0x02014b50};
+    const quint32 endOfCentralDirectorySignature{0x06054b50};
+    const quint32 dataDescriptorSignature{0x08074b50};
+    const int localHeaderSize{30};
+    const int centralHeaderSize{46};
+    const int endOfCentralDirectorySize{22};
+    const quint16 flagDataDescriptor{0x0008};
+    const quint16 flagUtf8Name{0x0800};
+    const quint16 methodStored{0};
+    const quint16 methodDeflated{8};
+    // The amount of data copied from the source archive in one go
+    const qint64 copyChunkSize{1024 * 1024};
+
+    quint16 read16(const char* data) {
+        return qFromLittleEndian<quint16>(data);
+    }
+    quint32 read32(const char* data) {
+        return qFromLittleEndian<quint32>(data);
+    }
+    void append16(QByteArray& data, quint16 value) {
+        char bytes[2];
+        qToLittleEndian(value, bytes);
+        data.append(bytes, 2);
+    }
+    void append32(QByteArray& data, quint32 value) {
+        char bytes[4];
+        qToLittleEndian(value, bytes);
+        data.append(bytes, 4);
+    }
+
+    quint32 checksum(const QByteArray& data) {
+#ifdef HAVE_ZLIB
+        return quint32(::crc32(0, reinterpret_cast<const Bytef*>(data.constData()), uInt(data.size())));
+#else
+        // Saves run on the thread pool, so leave the table's initialisation to the
+        // compiler, which guarantees that it happens exactly once
+        static const std::array<quint32, 256> table = []() {
+            std::array<quint32, 256> entries{};
+            for (quint32 i = 0; i < 256; ++i) {
+                quint32 value = i;
+                for (int bit = 0; bit < 8; ++bit) {
+                    value = (value & 1) ? (0xedb88320 ^ (value >> 1)) : (value >> 1);
+                }
+                entries[i] = value;
+            }
+            return entries;
+        }();
+        quint32 crc{0xffffffff};
+        for (const char byte : data) {
+            crc = table[(crc ^ quint8(byte)) & 0xff] ^ (crc >> 8);
+        }
+        return crc ^ 0xffffffff;
+#endif
+    }
+
+    // Compress the data as a raw deflate stream, or return it as it was (and set the method
+    // to stored) if we either can't compress, or compressing wouldn't gain us anything
+    QByteArray compress(const QByteArray& data, quint16& method) {
+        method = methodStored;
+#ifdef HAVE_ZLIB
+        z_stream stream;
+        stream.zalloc = Z_NULL;
+        stream.zfree = Z_NULL;
+        stream.opaque = Z_NULL;
+        if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK) {
+            QByteArray compressed;
+            compressed.resize(int(deflateBound(&stream, uLong(data.size()))));
+            stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data.constData()));
+            stream.avail_in = uInt(data.size());
+            stream.next_out = reinterpret_cast<Bytef*>(compressed.data());
+            stream.avail_out = uInt(compressed.size());
+            const int result = deflate(&stream, Z_FINISH);
+            compressed.resize(int(stream.total_out));
+            deflateEnd(&stream);
+            if (result == Z_STREAM_END && compressed.size() < data.size()) {
+                method = methodDeflated;
+                return compressed;
+            }
+        }
+#endif
+        return data;
+    }
+
+    // Formats which are already compressed, and so gain nothing from being deflated again
+    bool isCompressedFormat(const QString& fileName) {
+        static const QStringList suffixes{
+            QStringLiteral("jpg"), QStringLiteral("jpeg"), QStringLiteral("png"), QStringLiteral("gif"),
+            QStringLiteral("webp"), QStringLiteral("jxl"), QStringLiteral("avif"), QStringLiteral("heic"),
+            QStringLiteral("zip"), QStringLiteral("woff"), QStringLiteral("woff2")
+        };
+        return suffixes.contains(QFileInfo(fileName).suffix().toLower());
+    }
+
+    // Make sure everything written to the file has actually reached the disk
+    bool syncFile(QFile& file) {
+        if (!file.flush()) {
+            return false;
+        }
+#ifdef Q_OS_WIN
+        return FlushFileBuffers(HANDLE(_get_osfhandle(file.handle())));
+#else
+        return ::fsync(file.handle()) == 0;
+#endif
+    }
+
+    // The journal holds the end of the archive (from the start of the central directory) as it
+    // was before an in place update, for as long as the update is being written
+    const QByteArray journalMagic{"PeruseZipJournal1"};
+    QString journalFileName(const QString& fileName) {
+        const QFileInfo info(fileName);
+        return QStringLiteral("%1/.%2.journal").arg(info.absolutePath(), info.fileName());
+    }
+    // Held while writing or rolling back an update, so only one of those happens at a time
+    QString lockFileName(const QString& fileName) {
+        return journalFileName(fileName) + QStringLiteral(".lock");
+    }
+
+    void dosDateTime(const QDateTime& dateTime, quint16& time, quint16& date) {
+        const QDate day = dateTime.date();
+        const QTime clock = dateTime.time();
+        time = quint16((clock.hour() << 11) | (clock.minute() << 5) | (clock.second() / 2));
+        date = quint16((qMax(0, day.year() - 1980) << 9) | (day.month() << 5) | day.day());
+    }
+}
+
+class ZipRewriter::Private
+{
+public:
+    Private(const QString& fileName)
+        : source(fileName)
+    {}
+    struct Entry {
+        QString name;
+        // The entry's record in the central directory, exactly as it was in the source archive
+        QByteArray centralRecord;
+        qint64 localOffset{0};
+        // The size of the local header, the compressed data and the data descriptor (if any)
+        qint64 localSize{0};
+        bool removed{false};
+    };
+    QFile source;
+    QString errorString;
+    QVector<Entry> entries;
+    QHash<QString, int> entryIndex;
+    QStringList addedNames;
+    QHash<QString, QByteArray> addedData;
+    // Entries whose data should be read from a file on disk, by entry name
+    QHash<QString, QString> addedFiles;
+    std::function<bool(qint64, qint64)> progressFunction;
+    qint64 bytesWritten{0};
+    qint64 bytesTotal{0};
+    QByteArray archiveComment;
+    qint64 directoryOffset{0};
+    // Everything from the start of the central directory to the end of the source archive,
+    // exactly as it was, which is what needs putting back if an in place update fails
+    QByteArray originalEnd;
+
+    bool fail(const QString& error) {
+        errorString = error;
+        qCDebug(QTQUICK_LOG) << "Unable to rewrite" << source.fileName() << "directly:" << error;
+        return false;
+    }
+
+    static QString entryName(const QByteArray& rawName, quint16 flags) {
+        // Use the same decoding as KZip, so the names match those in the model
+        QString name = (flags & flagUtf8Name) ? QString::fromUtf8(rawName) : QFile::decodeName(rawName);
+        while (name.endsWith(QLatin1Char('/'))) {
+            name.chop(1);
+        }
+        return name;
+    }
+
+    // Let whoever is interested know how far along we are, and check whether they want us to stop
+    bool reportProgress(qint64 bytes) {
+        bytesWritten += bytes;
+        if (progressFunction && !progressFunction(bytesWritten, bytesTotal)) {
+            return fail(QStringLiteral("Writing the archive was cancelled"));
+        }
+        return true;
+    }
+
+    qint64 addedSize() const {
+        qint64 size{0};
+        for (const QString& name : addedNames) {
+            const auto file = addedFiles.constFind(name);
+            size += (file == addedFiles.constEnd()) ? addedData.value(name).size() : QFileInfo(file.value()).size();
+        }
+        return size;
+    }
+
+    // Copy a range of bytes from the source archive to the target
+    bool copyRange(QIODevice* target, qint64 offset, qint64 size) {
+        if (!source.seek(offset)) {
+            return fail(source.errorString());
+        }
+        while (size > 0) {
+            const QByteArray chunk = source.read(qMin(size, copyChunkSize));
+            if (chunk.isEmpty()) {
+                return fail(QStringLiteral("Unexpected end of the source archive"));
+            }
+            if (target->write(chunk) != chunk.size()) {
+                return fail(target->errorString());
+            }
+            size -= chunk.size();
+            if (!reportProgress(chunk.size())) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Write out all the added entries, starting at the given offset, and add them to the directory
+    bool writeAddedEntries(QIODevice* target, qint64& offset, QByteArray& directory, quint32& entryCount) {
+        quint16 time{0};
+        quint16 date{0};
+        dosDateTime(QDateTime::currentDateTime(), time, date);
+        for (const QString& name : qAsConst(addedNames)) {
+            QByteArray data;
+            bool storeOnly{false};
+            const auto addedFile = addedFiles.constFind(name);
+            if (addedFile == addedFiles.constEnd()) {
+                data = addedData.value(name);
+            } else {
+                storeOnly = isCompressedFormat(addedFile.value());
+                QFile file(addedFile.value());
+                if (!file.open(QIODevice::ReadOnly)) {
+                    return fail(QStringLiteral("Failed to read %1: %2").arg(file.fileName(), file.errorString()));
+                }
+                data = file.readAll();
+            }
+            const QByteArray rawName = name.toUtf8();
+            quint16 method{methodStored};
+            const QByteArray compressed = storeOnly ? data : compress(data, method);
+            const quint32 crc = checksum(data);
+
+            QByteArray localHeader;
+            append32(localHeader, localHeaderSignature);
+            append16(localHeader, 20); // version needed to extract
+            append16(localHeader, flagUtf8Name);
+            append16(localHeader, method);
+            append16(localHeader, time);
+            append16(localHeader, date);
+            append32(localHeader, crc);
+            append32(localHeader, quint32(compressed.size()));
+            append32(localHeader, quint32(data.size()));
+            append16(localHeader, quint16(rawName.size()));
+            append16(localHeader, 0); // extra field length
+            localHeader.append(rawName);
+            if (target->write(localHeader) != localHeader.size() || target->write(compressed) != compressed.size()) {
+                return fail(target->errorString());
+            }
+
+            append32(directory, centralHeaderSignature);
+            append16(directory, (3 << 8) | 20); // made by unix, version 2.0
+            append16(directory, 20);
+            append16(directory, flagUtf8Name);
+            append16(directory, method);
+            append16(directory, time);
+            append16(directory, date);
+            append32(directory, crc);
+            append32(directory, quint32(compressed.size()));
+            append32(directory, quint32(data.size()));
+            append16(directory, quint16(rawName.size()));
+            append16(directory, 0); // extra field length
+            append16(directory, 0); // comment length
+            append16(directory, 0); // disk number
+            append16(directory, 0); // internal attributes
+            append32(directory, quint32(0100644) << 16); // external attributes (a regular file, rw-r--r--)
+            append32(directory, quint32(offset));
+            directory.append(rawName);
+            offset += localHeader.size() + compressed.size();
+            ++entryCount;
+            if (!reportProgress(data.size())) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool writeJournal(qint64 originalSize) {
+        QSaveFile journal(journalFileName(source.fileName()));
+        if (!journal.open(QIODevice::WriteOnly)) {
+            return fail(journal.errorString());
+        }
+        QDataStream stream(&journal);
+        stream << journalMagic << originalSize << directoryOffset << originalEnd << checksum(originalEnd);
+        if (stream.status() != QDataStream::Ok || !journal.commit()) {
+            return fail(QStringLiteral("Failed to write the journal: %1").arg(journal.errorString()));
+        }
+        return true;
+    }
+
+    // Put the end of the archive back the way it was before an update started
+    static bool restoreEnd(QFile& target, qint64 offset, const QByteArray& end) {
+        return target.seek(offset)
+            && target.write(end) == end.size()
+            && target.resize(offset + end.size())
+            && syncFile(target);
+    }
+
+    // Write the central directory, which starts at the given offset, and the end record
+    bool writeDirectory(QIODevice* target, qint64 offset, const QByteArray& directory, quint32 entryCount) {
+        if (entryCount >= 0xffff || offset + directory.size() >= 0xffffffff) {
+            return fail(QStringLiteral("The new archive would need zip64 extensions"));
+        }
+        QByteArray endRecord;
+        append32(endRecord, endOfCentralDirectorySignature);
+        append16(endRecord, 0); // this disk
+        append16(endRecord, 0); // disk with the central directory
+        append16(endRecord, quint16(entryCount));
+        append16(endRecord, quint16(entryCount));
+        append32(endRecord, quint32(directory.size()));
+        append32(endRecord, quint32(offset));
+        append16(endRecord, quint16(archiveComment.size()));
+        endRecord.append(archiveComment);
+        if (target->write(directory) != directory.size() || target->write(endRecord) != endRecord.size()) {
+            return fail(target->errorString());
+        }
+        return true;
+    }
+};
+
+ZipRewriter::ZipRewriter(const QString& fileName)
+    : d(new Private(fileName))
+{
+}
+
+ZipRewriter::~ZipRewriter()
+{
+    delete d;
+}
+
+bool ZipRewriter::open()
+{
+    if (!recover(d->source.fileName())) {
+        return d->fail(QStringLiteral("The archive was left in an unfinished state by an earlier update"));
+    }
+    d->entries.clear();
+    d->entryIndex.clear();
+    if (!d->source.isOpen() && !d->source.open(QIODevice::ReadOnly)) {
+        return d->fail(d->source.errorString());
+    }
+    const qint64 fileSize = d->source.size();
+    if (fileSize < endOfCentralDirectorySize) {
+        return d->fail(QStringLiteral("The file is too small to be a zip archive"));
+    }
+
+    // The end of central directory record is at the very end of the file, followed only by
+    // the (at most 64KiB long) archive comment
+    const qint64 tailSize = qMin(fileSize, qint64(endOfCentralDirectorySize + 0xffff));
+    d->source.seek(fileSize - tailSize);
+    const QByteArray tail = d->source.read(tailSize);
+    int endRecord{-1};
+    for (int i = tail.size() - endOfCentralDirectorySize; i > -1; --i) {
+        const char* record = tail.constData() + i;
+        if (read32(record) == endOfCentralDirectorySignature
+            && i + endOfCentralDirectorySize + read16(record + 20) == tail.size()) {
+            endRecord = i;
+            break;
+        }
+    }
+    if (endRecord < 0) {
+        return d->fail(QStringLiteral("Could not find the end of the central directory"));
+    }
+    const char* record = tail.constData() + endRecord;
+    const quint16 entryCount = read16(record + 10);
+    const quint32 directorySize = read32(record + 12);
+    const quint32 directoryOffset = read32(record + 16);
+    if (read16(record + 4) != 0 || read16(record + 6) != 0 || read16(record + 8) != entryCount) {
+        return d->fail(QStringLiteral("Archives spanning multiple disks are not supported"));
+    }
+    if (entryCount == 0xffff || directorySize == 0xffffffff || directoryOffset == 0xffffffff) {
+        return d->fail(QStringLiteral("Zip64 archives are not supported"));
+    }
+    if (qint64(directoryOffset) + directorySize > fileSize - tailSize + endRecord) {
+        return d->fail(QStringLiteral("The central directory is outside the archive"));
+    }
+    d->archiveComment = tail.mid(endRecord + endOfCentralDirectorySize);
+    d->directoryOffset = directoryOffset;
+
+    d->source.seek(directoryOffset);
+    const QByteArray directory = d->source.read(directorySize);
+    if (directory.size() != int(directorySize)) {
+        return d->fail(QStringLiteral("Failed to read the central directory"));
+    }
+    d->originalEnd = directory + d->source.read(fileSize - directoryOffset - directorySize);
+    if (d->originalEnd.size() != fileSize - directoryOffset) {
+        return d->fail(QStringLiteral("Failed to read the end of the archive"));
+    }
+    d->entries.reserve(entryCount);
+    int position{0};
+    for (int i = 0; i < entryCount; ++i) {
+        if (position + centralHeaderSize > directory.size() || read32(directory.constData() + position) != centralHeaderSignature) {
+            return d->fail(QStringLiteral("The central directory is corrupt"));
+        }
+        const char* header = directory.constData() + position;
+        const quint16 flags = read16(header + 8);
+        const quint32 compressedSize = read32(header + 20);
+        const quint32 uncompressedSize = read32(header + 24);
+        const quint16 nameLength = read16(header + 28);
+        const int recordSize = centralHeaderSize + nameLength + read16(header + 30) + read16(header + 32);
+        if (position + recordSize > directory.size()) {
+            return d->fail(QStringLiteral("The central directory is corrupt"));
+        }
+        Private::Entry entry;
+        entry.localOffset = read32(header + 42);
+        if (compressedSize == 0xffffffff || uncompressedSize == 0xffffffff || entry.localOffset == 0xffffffff) {
+            return d->fail(QStringLiteral("Zip64 archives are not supported"));
+        }
+        entry.name = Private::entryName(directory.mid(position + centralHeaderSize, nameLength), flags);
+        entry.centralRecord = directory.mid(position, recordSize);
+
+        // The local header can have a different extra field than the central one, so we
+        // need to look at it to know how much to copy
+        d->source.seek(entry.localOffset);
+        const QByteArray localHeader = d->source.read(localHeaderSize);
+        if (localHeader.size() != localHeaderSize || read32(localHeader.constData()) != localHeaderSignature) {
+            return d->fail(QStringLiteral("The local header for %1 is corrupt").arg(entry.name));
+        }
+        entry.localSize = localHeaderSize + read16(localHeader.constData() + 26) + read16(localHeader.constData() + 28) + compressedSize;
+        if (flags & flagDataDescriptor) {
+            // The signature on the data descriptor is optional, so check whether it is there
+            d->source.seek(entry.localOffset + entry.localSize);
+            const QByteArray signature = d->source.read(4);
+            entry.localSize += (signature.size() == 4 && read32(signature.constData()) == dataDescriptorSignature) ? 16 : 12;
+        }
+        if (entry.localOffset + entry.localSize > directoryOffset) {
+            return d->fail(QStringLiteral("The data for %1 is outside the archive").arg(entry.name));
+        }
+        d->entryIndex.insert(entry.name, d->entries.count());
+        d->entries << entry;
+        position += recordSize;
+    }
+    return true;
+}
+
+QString ZipRewriter::errorString() const
+{
+    return d->errorString;
+}
+
+QStringList ZipRewriter::entryNames() const
+{
+    QStringList names;
+    names.reserve(d->entries.count());
+    for (const Private::Entry& entry : qAsConst(d->entries)) {
+        names << entry.name;
+    }
+    return names;
+}
+
+void ZipRewriter::removeEntry(const QString& name)
+{
+    const auto index = d->entryIndex.constFind(name);
+    if (index != d->entryIndex.constEnd()) {
+        d->entries[index.value()].removed = true;
+    }
+    if (d->addedNames.removeAll(name) > 0) {
+        d->addedData.remove(name);
+        d->addedFiles.remove(name);
+    }
+}
+
+void ZipRewriter::setEntryData(const QString& name, const QByteArray& data)
+{
+    removeEntry(name);
+    d->addedNames << name;
+    d->addedData.insert(name, data);
+}
+
+void ZipRewriter::setEntryFile(const QString& name, const QString& fileName)
+{
+    removeEntry(name);
+    d->addedNames << name;
+    d->addedFiles.insert(name, fileName);
+}
+
+void ZipRewriter::setProgressFunction(std::function<bool(qint64, qint64)> progressFunction)
+{
+    d->progressFunction = progressFunction;
+}
+
+bool ZipRewriter::writeTo(QIODevice* target)
+{
+    QByteArray directory;
+    quint32 entryCount{0};
+    qint64 offset{0};
+    d->bytesWritten = 0;
+    d->bytesTotal = d->addedSize();
+    for (const Private::Entry& entry : qAsConst(d->entries)) {
+        if (!entry.removed) {
+            d->bytesTotal += entry.localSize;
+        }
+    }
+
+    for (const Private::Entry& entry : qAsConst(d->entries)) {
+        if (entry.removed) {
+            continue;
+        }
+        if (!d->copyRange(target, entry.localOffset, entry.localSize)) {
+            return false;
+        }
+        // Everything in the central record stays the same, except where the entry is now
+        QByteArray centralRecord = entry.centralRecord;
+        qToLittleEndian(quint32(offset), centralRecord.data() + 42);
+        directory.append(centralRecord);
+        offset += entry.localSize;
+        ++entryCount;
+    }
+
+    return d->writeAddedEntries(target, offset, directory, entryCount)
+        && d->writeDirectory(target, offset, directory, entryCount);
+}
+
+qint64 ZipRewriter::unusedSize() const
+{
+    qint64 usedSize{0};
+    for (const Private::Entry& entry : qAsConst(d->entries)) {
+        if (!entry.removed) {
+            usedSize += entry.localSize;
+        }
+    }
+    return d->directoryOffset - usedSize;
+}
+
+bool ZipRewriter::updateInPlace()
+{
+    const QString fileName = d->source.fileName();
+    QLockFile lock(lockFileName(fileName));
+    // Updates can take a while, so only consider the lock stale if whoever held it is gone
+    lock.setStaleLockTime(0);
+    if (!lock.tryLock(0)) {
+        return d->fail(QStringLiteral("The archive is being updated by someone else"));
+    }
+    QFile target(fileName);
+    if (!target.open(QIODevice::ReadWrite)) {
+        return d->fail(target.errorString());
+    }
+    const qint64 originalSize = target.size();
+    if (originalSize != d->directoryOffset + d->originalEnd.size()) {
+        return d->fail(QStringLiteral("The archive changed after it was read"));
+    }
+
+    // Only once the old end of the archive is safely on disk do we start overwriting it
+    if (!d->writeJournal(originalSize)) {
+        return false;
+    }
+
+    // The entries we keep stay exactly where they are, so their central records can be used as is
+    QByteArray directory;
+    quint32 entryCount{0};
+    for (const Private::Entry& entry : qAsConst(d->entries)) {
+        if (!entry.removed) {
+            directory.append(entry.centralRecord);
+            ++entryCount;
+        }
+    }
+
+    // Anything new goes where the central directory used to be, followed by the new directory
+    d->bytesWritten = 0;
+    d->bytesTotal = d->addedSize();
+    qint64 offset{d->directoryOffset};
+    bool success = target.seek(offset)
+        && d->writeAddedEntries(&target, offset, directory, entryCount)
+        && d->writeDirectory(&target, offset, directory, entryCount);
+    if (success) {
+        success = target.resize(target.pos()) && syncFile(target);
+        if (!success) {
+            d->fail(target.errorString());
+        }
+    }
+    if (!success && !Private::restoreEnd(target, d->directoryOffset, d->originalEnd)) {
+        // Leave the journal for recover() to try again with
+        qCWarning(QTQUICK_LOG) << "Failed to restore the central directory of" << fileName << target.errorString();
+        return false;
+    }
+    QFile::remove(journalFileName(fileName));
+    return success;
+}
+
+bool ZipRewriter::recover(const QString& fileName)
+{
+    const QString journalName = journalFileName(fileName);
+    if (!QFile::exists(journalName)) {
+        return true;
+    }
+    QLockFile lock(lockFileName(fileName));
+    lock.setStaleLockTime(0);
+    if (!lock.tryLock(0)) {
+        // Still being written, so this is not an interrupted update
+        return true;
+    }
+    QFile journal(journalName);
+    if (!journal.open(QIODevice::ReadOnly)) {
+        // The update finished while we were getting the lock
+        return true;
+    }
+    QByteArray magic;
+    qint64 originalSize{0};
+    qint64 directoryOffset{0};
+    QByteArray originalEnd;
+    quint32 endChecksum{0};
+    QDataStream stream(&journal);
+    stream >> magic >> originalSize >> directoryOffset >> originalEnd >> endChecksum;
+    journal.close();
+    if (stream.status() != QDataStream::Ok || magic != journalMagic
+        || checksum(originalEnd) != endChecksum || directoryOffset + originalEnd.size() != originalSize) {
+        // The journal is only ever written in one go, so this is not one of ours
+        qCWarning(QTQUICK_LOG) << "Ignoring the unreadable update journal" << journalName;
+        return true;
+    }
+
+    QFile target(fileName);
+    if (!target.open(QIODevice::ReadWrite) || target.size() < directoryOffset
+        || !Private::restoreEnd(target, directoryOffset, originalEnd)) {
+        qCWarning(QTQUICK_LOG) << "Failed to roll back the interrupted update of" << fileName << target.errorString();
+        return false;
+    }
+    qCDebug(QTQUICK_LOG) << "Rolled back an interrupted update of" << fileName;
+    QFile::remove(journalName);
+    return true;
+}
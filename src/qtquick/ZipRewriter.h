@@ -0,0 +1,143 @@
+/*
+ * Copyright (C) 2026 Dan Leinir Turthra Jensen <admin@leinir.dk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ZIPREWRITER_H
+#define ZIPREWRITER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+#include <functional>
+
+class QIODevice;
+/**
+ * \brief Writes a modified copy of a zip archive without recompressing the unchanged entries
+ *
+ * KZip only lets us get at the uncompressed data of the entries in an archive, so
+ * creating a modified copy of an archive with it means inflating and then deflating
+ * every single entry again, even when all that changed was a few lines of metadata.
+ *
+ * This class instead reads the central directory of the source archive itself, and
+ * copies the local headers and compressed data of every entry which is kept across
+ * verbatim. Only entries which are added (or replaced) are compressed.
+ *
+ * Small changes (such as a new version of the metadata) can also be made to the source
+ * archive in place, see updateInPlace(). Anything new is written where the central
+ * directory used to be, followed by a new central directory, which is the same layout KZip
+ * produces when adding files to an archive. Appending after the old end record instead does
+ * not work, as KZip stops reading at the first end of directory record it finds. Before the
+ * old directory is overwritten, it is put in a journal next to the archive, so an update
+ * interrupted by a crash or a power cut can be rolled back by recover(). Replaced and
+ * removed entries are left behind as unused space, which is only reclaimed by writing a
+ * new copy of the archive with writeTo().
+ *
+ * The set of archives supported is intentionally limited to what comic book archives
+ * actually look like: single-disk archives without zip64 extensions. If open() fails,
+ * the caller is expected to fall back to rewriting the archive using KZip.
+ */
+class ZipRewriter
+{
+public:
+    explicit ZipRewriter(const QString& fileName);
+    ~ZipRewriter();
+
+    /**
+     * \brief Read the central directory of the source archive.
+     * @return True if the archive could be read and is supported
+     * @see errorString()
+     */
+    bool open();
+    /**
+     * @return A human readable description of the most recent error
+     */
+    QString errorString() const;
+
+    /**
+     * @return The names of the entries in the source archive, as KArchive would name
+     * them (that is, without a trailing slash for directories)
+     */
+    QStringList entryNames() const;
+    /**
+     * \brief Leave the named entry out of the written archive.
+     * @param name The name of the entry, as returned by entryNames()
+     */
+    void removeEntry(const QString& name);
+    /**
+     * \brief Add an entry with the given content, replacing any existing entry by that name.
+     * The new entries are written after all the entries which are copied across.
+     * @param name The name of the entry inside the archive
+     * @param data The uncompressed content of the entry
+     */
+    void setEntryData(const QString& name, const QByteArray& data);
+    /**
+     * \brief Add an entry with the content of a local file, replacing any existing entry by that name.
+     * The file is only read when the archive is written. Files in formats which are already
+     * compressed (such as jpeg or png images) are stored as they are, rather than deflated.
+     * @param name The name of the entry inside the archive
+     * @param fileName The local file to read the content from
+     */
+    void setEntryFile(const QString& name, const QString& fileName);
+    /**
+     * \brief Set a function to be called as the archive is being written.
+     * The function is passed the number of bytes written so far, and the total number
+     * of bytes which will be written. If it returns false, writing is stopped, and
+     * writeTo() will return false.
+     * @param progressFunction The function to call (on the thread doing the writing)
+     */
+    void setProgressFunction(std::function<bool(qint64, qint64)> progressFunction);
+
+    /**
+     * \brief Write the modified archive to the target device.
+     * @param target A device opened for writing, positioned at the start of the archive
+     * @return True if the entire archive was written successfully
+     */
+    bool writeTo(QIODevice* target);
+
+    /**
+     * @return The number of bytes in the source archive taken up by entries which are
+     * not referenced by the central directory, or will not be once the modified archive
+     * has been written (that is, removed and replaced entries)
+     */
+    qint64 unusedSize() const;
+    /**
+     * \brief Make the changes to the source archive itself, rather than writing a new copy.
+     * The entries which are kept are not touched, and only the new entries and the central
+     * directory are written. If the update fails, the archive is put back the way it was.
+     * @return True if the archive was updated successfully
+     */
+    bool updateInPlace();
+    /**
+     * \brief Roll back an in place update which was interrupted part way through.
+     * This should be called before reading an archive which may have been updated in place.
+     * It does nothing if there is no interrupted update, or if the archive is being updated
+     * right now (by this or any other process).
+     * @param fileName The archive to check
+     * @return False if the archive was left with an interrupted update which could not be
+     * rolled back, true otherwise
+     */
+    static bool recover(const QString& fileName);
+private:
+    class Private;
+    Private* d;
+};
+
+#endif//ZIPREWRITER_H
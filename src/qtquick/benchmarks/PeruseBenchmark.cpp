@@ -0,0 +1,497 @@
+/*
+ * Copyright (C) 2026 Dan Leinir Turthra Jensen <admin@leinir.dk>
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) version 3, or any
+ * later version accepted by the membership of KDE e.V. (or its
+ * successor approved by the membership of KDE e.V.), which shall
+ * act as a proxy defined in Section 6 of version 3 of the license.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "ArchiveBookModel.h"
+#include "ArchiveImageProvider.h"
+#include "BookDatabase.h"
+#include "BookListModel.h"
+#include "CategoryEntriesModel.h"
+#include "ComicCoverImageProvider.h"
+#include "FilterProxy.h"
+#include "TextViewerItem.h"
+
+#include <AcbfBody.h>
+#include <AcbfBookinfo.h>
+#include <AcbfDocument.h>
+#include <AcbfMetadata.h>
+#include <AcbfPage.h>
+#include <AcbfTextarea.h>
+#include <AcbfTextlayer.h>
+
+#include <QAbstractListModel>
+#include <QBuffer>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QImage>
+#include <QLinearGradient>
+#include <QPainter>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+#include <QTest>
+#include <QUrl>
+
+#include <kzip.h>
+
+/**
+ * \brief Benchmarks for the hot paths of the library and the reader
+ *
+ * The fixtures (comic book archives, with and without an ACBF document) are generated in
+ * a temporary directory when starting. The rar archives can only be made when the rar tool
+ * is installed, and the benchmarks using them are skipped when it is not. Everything which
+ * would otherwise write into the user's data (the book database and the thumbnails) is kept
+ * in Qt's test locations.
+ *
+ * To get the results as JSON, run with "-o results.json,json".
+ */
+class PeruseBenchmark : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void setFilename_data();
+    void setFilename();
+    void archiveImageRunnable_data();
+    void archiveImageRunnable();
+    void comicCoverRunnable_data();
+    void comicCoverRunnable();
+    void documentToXml();
+    void documentFromXml();
+    void bookDatabaseAddEntry();
+    void bookDatabaseLoadEntries();
+    void bookListModelIngest();
+    void categoryEntriesModelAppend();
+    void filterProxy_data();
+    void filterProxy();
+    void textViewerItemLayout();
+
+private:
+    QTemporaryDir fixtures;
+    QString acbfBook;
+    QString plainBook;
+    // Only there if the rar tool is installed, as nothing else can make rar archives
+    QString rarAcbfBook;
+    QString rarPlainBook;
+    QStringList library;
+    QString acbfDocument;
+    QList<BookEntry*> entries;
+};
+
+namespace {
+    constexpr int pageCount{24};
+    constexpr int libraryCount{20};
+    constexpr int entryCount{2000};
+
+    const QStringList balloonText{
+        QStringLiteral("Well, that could have gone better. Nobody said anything about the bridge being made of cheese."),
+        QStringLiteral("It isn't cheese! It's a <em>very</em> yellow stone, and it has been here for four hundred years."),
+        QStringLiteral("Four hundred years of people walking over it, and not one of them thought to check?")
+    };
+
+    // Something with enough in it that compressing and decoding it isn't trivial
+    QByteArray pageImage(int number)
+    {
+        QImage image(1200, 1800, QImage::Format_RGB32);
+        image.fill(Qt::white);
+        QPainter painter(&image);
+        painter.setRenderHint(QPainter::Antialiasing);
+        for (int panel = 0; panel < 6; ++panel) {
+            const QRect panelRect(40 + (panel % 2) * 570, 40 + (panel / 2) * 580, 550, 560);
+            QLinearGradient gradient(panelRect.topLeft(), panelRect.bottomRight());
+            gradient.setColorAt(0, QColor::fromHsv((number * 37 + panel * 53) % 360, 80, 230));
+            gradient.setColorAt(1, QColor::fromHsv((number * 37 + panel * 53 + 120) % 360, 160, 120));
+            painter.fillRect(panelRect, gradient);
+            painter.setPen(QPen(Qt::black, 6));
+            painter.drawRect(panelRect);
+            painter.drawEllipse(panelRect.adjusted(60, 80, -200, -240));
+        }
+        painter.end();
+        QByteArray data;
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        image.save(&buffer, "PNG");
+        return data;
+    }
+
+    QString pageName(int number)
+    {
+        return QString("page%1.png").arg(number, 3, 10, QLatin1Char('0'));
+    }
+
+    AdvancedComicBookFormat::Document* makeDocument(QObject* parent, int pages)
+    {
+        AdvancedComicBookFormat::Document* document = new AdvancedComicBookFormat::Document(parent);
+        AdvancedComicBookFormat::BookInfo* bookInfo = document->metaData()->bookInfo();
+        bookInfo->setTitle(QStringLiteral("The Yellow Bridge"));
+        bookInfo->addAuthor(QStringLiteral("Writer"), QString(), QStringLiteral("Jane"), QString(), QStringLiteral("Doe"), QString(), QStringList(), QStringList());
+        bookInfo->addAuthor(QStringLiteral("Artist"), QString(), QStringLiteral("John"), QString(), QStringLiteral("Roe"), QString(), QStringList(), QStringList());
+        bookInfo->coverpage()->setImageHref(pageName(0));
+        for (int number = 1; number < pages; ++number) {
+            AdvancedComicBookFormat::Page* page = new AdvancedComicBookFormat::Page(document);
+            page->setImageHref(pageName(number));
+            page->setTitle(QString("Page %1").arg(number));
+            page->addTextLayer();
+            AdvancedComicBookFormat::Textlayer* layer = page->textLayer();
+            for (int balloon = 0; balloon < balloonText.count(); ++balloon) {
+                AdvancedComicBookFormat::Textarea* textarea = new AdvancedComicBookFormat::Textarea(layer);
+                textarea->setPointsFromRect(QPoint(100 + balloon * 300, 120), QPoint(380 + balloon * 300, 360));
+                textarea->setParagraphs(QStringList(balloonText.at(balloon)));
+                layer->addTextarea(textarea);
+            }
+            document->body()->addPage(page);
+        }
+        return document;
+    }
+
+    bool writeBook(const QString& fileName, const QString& acbf)
+    {
+        KZip zip(fileName);
+        if (!zip.open(QIODevice::WriteOnly)) {
+            return false;
+        }
+        for (int number = 0; number < pageCount; ++number) {
+            zip.writeFile(pageName(number), pageImage(number));
+        }
+        if (!acbf.isEmpty()) {
+            zip.writeFile(QStringLiteral("metadata.acbf"), acbf.toUtf8());
+        }
+        return zip.close();
+    }
+
+    // KRar (through unarr) reads rar archives up to version 4, so that is what we make
+    bool writeRarBook(const QString& fileName, const QString& acbf, const QString& folder)
+    {
+        const QString rar = QStandardPaths::findExecutable(QStringLiteral("rar"));
+        if (rar.isEmpty() || !QDir().mkpath(folder)) {
+            return false;
+        }
+        QStringList files;
+        for (int number = 0; number < pageCount; ++number) {
+            QFile page(QDir(folder).filePath(pageName(number)));
+            if (!page.open(QIODevice::WriteOnly) || page.write(pageImage(number)) < 0) {
+                return false;
+            }
+            files << page.fileName();
+        }
+        if (!acbf.isEmpty()) {
+            QFile metadata(QDir(folder).filePath(QStringLiteral("metadata.acbf")));
+            if (!metadata.open(QIODevice::WriteOnly) || metadata.write(acbf.toUtf8()) < 0) {
+                return false;
+            }
+            files << metadata.fileName();
+        }
+        QProcess process;
+        process.start(rar, QStringList{QStringLiteral("a"), QStringLiteral("-ma4"), QStringLiteral("-ep"), QStringLiteral("-idq"), fileName} + files);
+        return process.waitForFinished(-1) && process.exitStatus() == QProcess::NormalExit && process.exitCode() == 0;
+    }
+
+    // The minimum needed for BookListModel to take files from it, as ContentList provides
+    class FileListModel : public QAbstractListModel
+    {
+    public:
+        explicit FileListModel(QObject* parent = nullptr)
+            : QAbstractListModel(parent)
+        {}
+        QHash<int, QByteArray> roleNames() const override
+        {
+            return {{Qt::UserRole + 1, "filePath"}};
+        }
+        int rowCount(const QModelIndex& parent = QModelIndex()) const override
+        {
+            return parent.isValid() ? 0 : files.count();
+        }
+        QVariant data(const QModelIndex& index, int role) const override
+        {
+            if (index.isValid() && role == Qt::UserRole + 1) {
+                return QUrl::fromLocalFile(files.at(index.row()));
+            }
+            return QVariant();
+        }
+        void addFiles(const QStringList& newFiles)
+        {
+            for (const QString& file : newFiles) {
+                beginInsertRows(QModelIndex(), files.count(), files.count());
+                files.append(file);
+                endInsertRows();
+            }
+        }
+    private:
+        QStringList files;
+    };
+
+    // Makes layout available without a window to drive the polishing
+    class LayoutTextViewerItem : public TextViewerItem
+    {
+    public:
+        using TextViewerItem::updatePolish;
+    };
+}
+
+void PeruseBenchmark::initTestCase()
+{
+    QStandardPaths::setTestModeEnabled(true);
+    QFile::remove(QDir(QStandardPaths::writableLocation(QStandardPaths::AppDataLocation)).absoluteFilePath("library.sqlite"));
+    QDir(QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)).removeRecursively();
+
+    QVERIFY(fixtures.isValid());
+    QObject parent;
+    acbfDocument = makeDocument(&parent, pageCount)->toXml();
+    acbfBook = fixtures.filePath(QStringLiteral("acbf.cbz"));
+    QVERIFY(writeBook(acbfBook, acbfDocument));
+    plainBook = fixtures.filePath(QStringLiteral("plain.cbz"));
+    QVERIFY(writeBook(plainBook, QString()));
+    if (writeRarBook(fixtures.filePath(QStringLiteral("acbf.cbr")), acbfDocument, fixtures.filePath(QStringLiteral("rar-acbf")))) {
+        rarAcbfBook = fixtures.filePath(QStringLiteral("acbf.cbr"));
+    }
+    if (writeRarBook(fixtures.filePath(QStringLiteral("plain.cbr")), QString(), fixtures.filePath(QStringLiteral("rar-plain")))) {
+        rarPlainBook = fixtures.filePath(QStringLiteral("plain.cbr"));
+    }
+
+    // Each in its own folder, which BookListModel takes to be the series
+    for (int number = 0; number < libraryCount; ++number) {
+        const QString folder = QString("Series %1").arg(number % 4);
+        QDir(fixtures.path()).mkpath(folder);
+        const QString fileName = fixtures.filePath(QString("%1/Book %2.cbz").arg(folder).arg(number));
+        QVERIFY(QFile::copy(number % 2 ? plainBook : acbfBook, fileName));
+        library << fileName;
+    }
+
+    const QStringList genres{QStringLiteral("Adventure"), QStringLiteral("Comedy"), QStringLiteral("Science Fiction")};
+    for (int number = 0; number < entryCount; ++number) {
+        BookEntry* entry = new BookEntry();
+        entry->filename = fixtures.filePath(QString("Entries/Book %1.cbz").arg(number));
+        entry->filetitle = QString("Book %1.cbz").arg(number);
+        entry->title = QString("%1 and the Mystery of Book %2").arg(QStringList{"Alice", "Bob", "Carol", "Dave"}.at(number % 4)).arg(number);
+        entry->author = QStringList(QString("Author %1").arg(number % 50));
+        entry->series = QStringList(QString("Series %1").arg(number % 100));
+        entry->seriesNumbers = QStringList(QString::number(number / 100));
+        entry->seriesVolumes = QStringList("0");
+        entry->publisher = QString("Publisher %1").arg(number % 10);
+        entry->genres = QStringList(genres.at(number % genres.count()));
+        entry->keywords = QStringList{QStringLiteral("bridge"), QString("keyword%1").arg(number % 20)};
+        entry->description = QStringList(balloonText.at(number % balloonText.count()));
+        entry->created = QDateTime::currentDateTime().addSecs(-number * 3600);
+        entry->totalPages = pageCount;
+        entries << entry;
+    }
+}
+
+void PeruseBenchmark::cleanupTestCase()
+{
+    qDeleteAll(entries);
+    entries.clear();
+}
+
+void PeruseBenchmark::setFilename_data()
+{
+    QTest::addColumn<QString>("book");
+    QTest::newRow("cbz acbf") << acbfBook;
+    QTest::newRow("cbz plain") << plainBook;
+    QTest::newRow("cbr acbf") << rarAcbfBook;
+    QTest::newRow("cbr plain") << rarPlainBook;
+}
+
+void PeruseBenchmark::setFilename()
+{
+    QFETCH(QString, book);
+    if (book.isEmpty()) {
+        QSKIP("Making rar archives needs the rar tool");
+    }
+    ArchiveBookModel model;
+    QBENCHMARK {
+        model.setFilename(book);
+    }
+    QCOMPARE(model.pageCount(), pageCount);
+}
+
+void PeruseBenchmark::archiveImageRunnable_data()
+{
+    QTest::addColumn<QSize>("requestedSize");
+    QTest::newRow("full") << QSize();
+    QTest::newRow("scaled") << QSize(400, 600);
+}
+
+void PeruseBenchmark::archiveImageRunnable()
+{
+    QFETCH(QSize, requestedSize);
+    ArchiveBookModel model;
+    model.setFilename(acbfBook);
+    int page{0};
+    QBENCHMARK {
+        ArchiveImageRunnable runnable(pageName(page), requestedSize, &model, QString());
+        runnable.run();
+        page = (page + 1) % pageCount;
+    }
+}
+
+void PeruseBenchmark::comicCoverRunnable_data()
+{
+    QTest::addColumn<QString>("book");
+    QTest::addColumn<bool>("cached");
+    QTest::newRow("cbz cached") << acbfBook << true;
+    QTest::newRow("cbz uncached") << acbfBook << false;
+    QTest::newRow("cbr cached") << rarAcbfBook << true;
+    QTest::newRow("cbr uncached") << rarAcbfBook << false;
+}
+
+void PeruseBenchmark::comicCoverRunnable()
+{
+    QFETCH(QString, book);
+    QFETCH(bool, cached);
+    if (book.isEmpty()) {
+        QSKIP("Making rar archives needs the rar tool");
+    }
+    const QString fileName = fixtures.filePath(QStringLiteral("cover.%1").arg(QFileInfo(book).suffix()));
+    QFile::remove(fileName);
+    QVERIFY(QFile::copy(book, fileName));
+    QFile file(fileName);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    QDateTime modified = file.fileTime(QFileDevice::FileModificationTime);
+    QBENCHMARK {
+        if (!cached) {
+            // Thumbnails are only valid for the file as it was when they were made
+            modified = modified.addSecs(1);
+            file.setFileTime(modified, QFileDevice::FileModificationTime);
+        }
+        ComicCoverRunnable runnable(fileName, QSize(256, 256));
+        runnable.run();
+    }
+}
+
+void PeruseBenchmark::documentToXml()
+{
+    QObject parent;
+    AdvancedComicBookFormat::Document* document = makeDocument(&parent, 200);
+    QString xml;
+    QBENCHMARK {
+        xml = document->toXml();
+    }
+    QVERIFY(!xml.isEmpty());
+}
+
+void PeruseBenchmark::documentFromXml()
+{
+    QObject parent;
+    const QString xml = makeDocument(&parent, 200)->toXml();
+    QBENCHMARK {
+        AdvancedComicBookFormat::Document document;
+        QVERIFY(document.fromXml(xml));
+    }
+}
+
+void PeruseBenchmark::bookDatabaseAddEntry()
+{
+    BookDatabase database;
+    int round{0};
+    QBENCHMARK {
+        // The file name is the key, so every round adds new books rather than failing on the old ones
+        BookEntry entry = *entries.first();
+        for (int number = 0; number < 100; ++number) {
+            entry.filename = fixtures.filePath(QString("Added/%1/Book %2.cbz").arg(round).arg(number));
+            database.addEntry(&entry);
+        }
+        ++round;
+    }
+}
+
+void PeruseBenchmark::bookDatabaseLoadEntries()
+{
+    BookDatabase database;
+    for (int number = 0; number < 500; ++number) {
+        database.addEntry(entries.at(number));
+    }
+    QList<BookEntry*> loaded;
+    QBENCHMARK {
+        loaded = database.loadEntries();
+        qDeleteAll(loaded);
+    }
+    QVERIFY(!loaded.isEmpty());
+}
+
+void PeruseBenchmark::bookListModelIngest()
+{
+    QBENCHMARK {
+        FileListModel files;
+        BookListModel model;
+        model.setContentModel(&files);
+        files.addFiles(library);
+    }
+}
+
+void PeruseBenchmark::categoryEntriesModelAppend()
+{
+    QBENCHMARK {
+        CategoryEntriesModel model;
+        for (BookEntry* entry : qAsConst(entries)) {
+            model.append(entry);
+        }
+    }
+}
+
+void PeruseBenchmark::filterProxy_data()
+{
+    QTest::addColumn<bool>("fullTextSearch");
+    QTest::newRow("plain") << false;
+    QTest::newRow("fulltext") << true;
+}
+
+void PeruseBenchmark::filterProxy()
+{
+    QFETCH(bool, fullTextSearch);
+    CategoryEntriesModel model;
+    for (BookEntry* entry : qAsConst(entries)) {
+        model.append(entry);
+    }
+    FilterProxy proxy;
+    proxy.setSourceModel(&model);
+    proxy.setFilterRole(CategoryEntriesModel::TitleRole);
+    proxy.setFullTextSearch(fullTextSearch);
+    const QStringList filters{QStringLiteral("alice"), QStringLiteral("mystery of book 1"), QString()};
+    int filter{0};
+    QBENCHMARK {
+        proxy.setFilterString(filters.at(filter));
+        filter = (filter + 1) % filters.count();
+    }
+}
+
+void PeruseBenchmark::textViewerItemLayout()
+{
+    LayoutTextViewerItem item;
+    item.setSize(QSizeF(280, 240));
+    item.setShape({QPoint(0, 60), QPoint(60, 0), QPoint(220, 0), QPoint(280, 60), QPoint(280, 180), QPoint(220, 240), QPoint(60, 240), QPoint(0, 180)});
+    item.setShapeMultiplier(1.0);
+    int round{0};
+    QBENCHMARK {
+        // Different text every round, so the layout is done rather than taken from the cache
+        QStringList paragraphs = balloonText;
+        paragraphs.last().append(QString(" (%1)").arg(round++));
+        item.setParagraphs(paragraphs);
+        item.updatePolish();
+    }
+}
+
+QTEST_MAIN(PeruseBenchmark)
+
+#include "PeruseBenchmark.moc"
@@ -35,6 +35,7 @@
 #include "PropertyContainer.h"
 #include "TextDocumentEditor.h"
 #include "TextViewerItem.h"
+#include "TiledPageItem.h"
 
 #include "AcbfBinary.h"
 #include "AcbfReference.h"
@@ -66,6 +67,7 @@ void QmlPlugins::registerTypes(const char *uri)
 
     qmlRegisterType<TextDocumentEditor>(uri, 0, 1, "TextDocumentEditor");
     qmlRegisterType<TextViewerItem>(uri, 0, 1, "TextViewerItem");
+    qmlRegisterType<TiledPageItem>(uri, 0, 1, "TiledPageItem");
 
     qmlRegisterUncreatableType<AdvancedComicBookFormat::Reference>(uri, 0, 1, "Reference", "Don't attempt to create ACBF types directly, use the convenience functions on their container types for creating them");
     qmlRegisterUncreatableType<AdvancedComicBookFormat::Binary>(uri, 0, 1, "Binary", "Don't attempt to create ACBF types directly, use the convenience functions on their container types for creating them");